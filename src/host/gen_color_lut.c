@@ -0,0 +1,282 @@
+/**
+ * @file gen_color_lut.c
+ * @brief Build-time generator for the speed to LED colour table.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Reads a palette description (speed_palette.txt) and writes
+ * src/includes/color_lut.h: one gamma-corrected 10-bit PWM duty triple per
+ * 2^shift deg/s, so the firmware maps a speed to a colour with a shift,
+ * a clamp and three table reads.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DUTY_MAX     1023   // 10-bit PWM full scale (lights_set_color10)
+#define MAX_STOPS    16
+#define MAX_SIZE     256
+#define LINE_MAX_LEN 256
+
+typedef struct
+{
+	long speed;       // deg/s
+	double rgb[3];    // Perceptual 0-255
+} stop_t;
+
+typedef struct
+{
+	double gamma;
+	int shift;
+	int size;
+	stop_t stops[MAX_STOPS];
+	int stop_count;
+} palette_t;
+
+static int fail(const char* path, int line, const char* message)
+{
+	fprintf(stderr, "%s:%d: %s\n", path, line, message);
+	return -1;
+}
+
+/**
+ * @brief Parse and check the palette file.
+ */
+static int load_palette(const char* path, palette_t* palette)
+{
+	char text[LINE_MAX_LEN];
+	char key[16];
+	FILE* file;
+	stop_t* stop;
+	int line = 0;
+	int i;
+
+	file = fopen(path, "r");
+	if (file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+
+	palette->gamma = 2.2;
+	palette->shift = 4;
+	palette->size = 64;
+	palette->stop_count = 0;
+
+	while (fgets(text, sizeof(text), file) != NULL)
+	{
+		line++;
+		text[strcspn(text, "#\r\n")] = '\0';
+		if (sscanf(text, "%15s", key) != 1)
+		{
+			continue;
+		}
+
+		if (strcmp(key, "gamma") == 0)
+		{
+			if (sscanf(text, "%*s %lf", &palette->gamma) != 1 || palette->gamma <= 0.0)
+			{
+				fclose(file);
+				return fail(path, line, "gamma must be positive");
+			}
+		}
+		else if (strcmp(key, "shift") == 0)
+		{
+			if (sscanf(text, "%*s %d", &palette->shift) != 1 ||
+				palette->shift < 0 || palette->shift > 8)
+			{
+				fclose(file);
+				return fail(path, line, "shift must be 0..8");
+			}
+		}
+		else if (strcmp(key, "size") == 0)
+		{
+			if (sscanf(text, "%*s %d", &palette->size) != 1 ||
+				palette->size < 1 || palette->size > MAX_SIZE)
+			{
+				fclose(file);
+				return fail(path, line, "size must be 1..256");
+			}
+		}
+		else if (strcmp(key, "stop") == 0)
+		{
+			if (palette->stop_count >= MAX_STOPS)
+			{
+				fclose(file);
+				return fail(path, line, "too many stops");
+			}
+			stop = &palette->stops[palette->stop_count];
+			if (sscanf(text, "%*s %ld %lf %lf %lf", &stop->speed,
+					   &stop->rgb[0], &stop->rgb[1], &stop->rgb[2]) != 4)
+			{
+				fclose(file);
+				return fail(path, line, "expected: stop <speed> <r> <g> <b>");
+			}
+			for (i = 0; i < 3; i++)
+			{
+				if (stop->rgb[i] < 0.0 || stop->rgb[i] > 255.0)
+				{
+					fclose(file);
+					return fail(path, line, "colour components must be 0..255");
+				}
+			}
+			if (stop->speed < 0 ||
+				(palette->stop_count > 0 && stop->speed <= stop[-1].speed))
+			{
+				fclose(file);
+				return fail(path, line, "stop speeds must be ascending and non-negative");
+			}
+			palette->stop_count++;
+		}
+		else
+		{
+			fclose(file);
+			return fail(path, line, "unknown keyword");
+		}
+	}
+	fclose(file);
+
+	if (palette->stop_count == 0)
+	{
+		return fail(path, line, "no stops");
+	}
+	if (((long)palette->size << palette->shift) > 65536L)
+	{
+		return fail(path, line, "size << shift exceeds the 16-bit speed range");
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Perceptual colour at a speed, blended between the enclosing stops.
+ */
+static void palette_color(const palette_t* palette, double speed, double* rgb)
+{
+	const stop_t* lo = &palette->stops[0];
+	const stop_t* hi = &palette->stops[palette->stop_count - 1];
+	double t;
+	int i;
+
+	if (speed <= lo->speed)
+	{
+		hi = lo;
+	}
+	else if (speed < hi->speed)
+	{
+		i = 1;
+		while (palette->stops[i].speed < speed)
+		{
+			i++;
+		}
+		lo = &palette->stops[i - 1];
+		hi = &palette->stops[i];
+	}
+	else
+	{
+		lo = hi;
+	}
+
+	t = (hi == lo) ? 0.0 : (speed - lo->speed) / (double)(hi->speed - lo->speed);
+	for (i = 0; i < 3; i++)
+	{
+		rgb[i] = lo->rgb[i] + t * (hi->rgb[i] - lo->rgb[i]);
+	}
+}
+
+static void write_header(FILE* out, const char* path, const palette_t* palette)
+{
+	const char* name = strrchr(path, '/');
+	double rgb[3];
+	double speed;
+	long step = 1L << palette->shift;
+	int i;
+	int c;
+
+	name = (name != NULL) ? name + 1 : path;
+
+	fprintf(out,
+			"/**\n"
+			" * @file color_lut.h\n"
+			" * @brief Speed to RGB LED duty table for accelerometer_speed_to_color().\n"
+			" * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia\n"
+			" * @date 2025-11\n"
+			" *\n"
+			" * Generated by src/host/gen_color_lut from %s; edit the palette\n"
+			" * and rebuild instead of changing this file.\n"
+			" * Gamma %.2f, stops at",
+			name, palette->gamma);
+	for (i = 0; i < palette->stop_count; i++)
+	{
+		fprintf(out, " %ld", palette->stops[i].speed);
+	}
+	fprintf(out,
+			" °/s.\n"
+			" */\n"
+			"#ifndef COLOR_LUT_H\n"
+			"#define COLOR_LUT_H\n"
+			"\n"
+			"#include <stdint.h>\n"
+			"\n"
+			"#define COLOR_LUT_SHIFT %d    // One entry per %ld °/s\n"
+			"#define COLOR_LUT_SIZE  %d   // Faster speeds use the last entry\n"
+			"#define COLOR_LUT_MAX   %d // Full-scale duty\n"
+			"\n"
+			"// PWM duty (r, g, b) for the middle of each step; const keeps it in\n"
+			"// program memory on XC8\n"
+			"static const uint16_t color_lut[COLOR_LUT_SIZE][3] = {\n",
+			palette->shift, step, palette->size, DUTY_MAX);
+
+	for (i = 0; i < palette->size; i++)
+	{
+		speed = (double)((long)i << palette->shift) + step / 2.0;
+		palette_color(palette, speed, rgb);
+		fprintf(out, "    {");
+		for (c = 0; c < 3; c++)
+		{
+			// Linear PWM duty for the perceptual level
+			long duty = lround(DUTY_MAX * pow(rgb[c] / 255.0, palette->gamma));
+			fprintf(out, "%s%4ld", c ? ", " : " ", duty);
+		}
+		fprintf(out, " }%s  // %5ld °/s\n", (i + 1 < palette->size) ? "," : " ",
+				(long)i << palette->shift);
+	}
+
+	fprintf(out,
+			"};\n"
+			"\n"
+			"#endif  // COLOR_LUT_H\n");
+}
+
+int main(int argc, char** argv)
+{
+	palette_t palette;
+	FILE* out = stdout;
+
+	if (argc != 2 && argc != 3)
+	{
+		fprintf(stderr, "usage: %s palette.txt [color_lut.h]\n", argv[0]);
+		return 1;
+	}
+
+	if (load_palette(argv[1], &palette) != 0)
+	{
+		return 1;
+	}
+
+	if (argc == 3)
+	{
+		out = fopen(argv[2], "w");
+		if (out == NULL)
+		{
+			perror(argv[2]);
+			return 1;
+		}
+	}
+
+	write_header(out, argv[1], &palette);
+
+	return (out != stdout && fclose(out) != 0) ? 1 : 0;
+}
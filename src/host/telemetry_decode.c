@@ -0,0 +1,415 @@
+/**
+ * @file telemetry_decode.c
+ * @brief Host decoder for the Micro-Fencing telemetry stream.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Reads the EUSART byte stream from a serial port, a simulator pty or a
+ * capture file, splits it on 0x00, COBS-decodes and CRC-checks each frame
+ * and prints one line per sample or event, tagged with the sensor index.
+ * DELTA entries are rebuilt on top of the same sensor's last keyframe;
+ * after a seq gap they are discarded until that sensor's next SAMPLE
+ * frame. Also writes host-to-device command frames.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "../includes/telemetry_frames.h"
+#include "../includes/crc.h"
+
+#define RX_FRAME_MAX 256   // Longer runs without a delimiter are discarded
+
+typedef struct
+{
+	unsigned long frames;
+	unsigned long bad_frames;    // COBS or CRC failure
+	unsigned long seq_gaps;      // Frames missing by seq
+	unsigned long samples;       // Keyframes
+	unsigned long deltas;        // Reconstructed delta samples
+	unsigned long deltas_lost;   // Deltas with no valid keyframe to apply to
+	unsigned long events;
+} decode_stats_t;
+
+static decode_stats_t stats;
+
+static int16_t prev[TLM_MAX_SENSORS][8];
+static int have_prev[TLM_MAX_SENSORS];
+static int have_seq = 0;
+static uint8_t last_seq = 0;
+
+static const char* event_names[] = { "NONE", "START", "PEAK", "END" };
+
+static uint16_t get_u16(const uint8_t* p)
+{
+	return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+/**
+ * @brief COBS-decode in place; returns the decoded length, 0 if malformed.
+ */
+static size_t cobs_decode(uint8_t* buf, size_t len)
+{
+	size_t read = 0;
+	size_t write = 0;
+	uint8_t code;
+	uint8_t i;
+
+	while (read < len)
+	{
+		code = buf[read++];
+		if (code == 0)
+		{
+			return 0;
+		}
+		for (i = 1; i < code; i++)
+		{
+			if (read >= len)
+			{
+				return 0;
+			}
+			buf[write++] = buf[read++];
+		}
+		if (code != 0xFF && read < len)
+		{
+			buf[write++] = 0;
+		}
+	}
+
+	return write;
+}
+
+/**
+ * @brief COBS-encode len bytes from src into dst; returns the encoded length.
+ */
+static size_t cobs_encode(const uint8_t* src, size_t len, uint8_t* dst)
+{
+	size_t read = 0;
+	size_t write = 1;
+	size_t code_index = 0;
+	uint8_t code = 1;
+
+	while (read < len)
+	{
+		if (src[read] == 0)
+		{
+			dst[code_index] = code;
+			code = 1;
+			code_index = write++;
+		}
+		else
+		{
+			dst[write++] = src[read];
+			if (++code == 0xFF)
+			{
+				dst[code_index] = code;
+				code = 1;
+				code_index = write++;
+			}
+		}
+		read++;
+	}
+	dst[code_index] = code;
+
+	return write;
+}
+
+static void forget_keyframes(void)
+{
+	memset(have_prev, 0, sizeof(have_prev));
+}
+
+static void print_values(char tag, unsigned sensor, uint8_t seq, long t_ms, const int16_t* v)
+{
+	if (t_ms >= 0)
+	{
+		printf("%c%u %3u t=%5ld", tag, sensor, seq, t_ms);
+	}
+	else
+	{
+		printf("%c%u %3u        ", tag, sensor, seq);
+	}
+	printf("  a=%6d %6d %6d  g=%6d %6d %6d  mag=%5u avg=%5u\n",
+		   v[0], v[1], v[2], v[3], v[4], v[5], (uint16_t)v[6], (uint16_t)v[7]);
+}
+
+/**
+ * @brief Handle one decoded, CRC-checked frame.
+ */
+static void handle_frame(const uint8_t* frame, size_t length)
+{
+	const uint8_t* body = frame + TLM_HEADER_LEN;
+	size_t body_len = length - TLM_HEADER_LEN - TLM_CRC_LEN;
+	uint8_t seq = frame[1];
+	unsigned sensor = frame[0] >> TLM_FRAME_SENSOR_SHIFT;
+	unsigned n;
+	unsigned i;
+	unsigned k;
+
+	if (have_seq && seq != (uint8_t)(last_seq + 1))
+	{
+		stats.seq_gaps += (uint8_t)(seq - last_seq - 1);
+		forget_keyframes();
+	}
+	have_seq = 1;
+	last_seq = seq;
+
+	if (sensor >= TLM_MAX_SENSORS)
+	{
+		stats.bad_frames++;
+		return;
+	}
+
+	switch (frame[0] & TLM_FRAME_TYPE_MASK)
+	{
+		case TLM_FRAME_SAMPLE:
+			if (body_len != TLM_SAMPLE_BODY_LEN)
+			{
+				stats.bad_frames++;
+				return;
+			}
+			for (i = 0; i < 8; i++)
+			{
+				prev[sensor][i] = (int16_t)get_u16(&body[2 + 2 * i]);
+			}
+			have_prev[sensor] = 1;
+			stats.samples++;
+			print_values('S', sensor, seq, get_u16(body), prev[sensor]);
+			break;
+
+		case TLM_FRAME_DELTA:
+			n = body_len ? body[0] : 0;
+			if (body_len != 1 + n * TLM_DELTA_ENTRY_LEN || n > TLM_DELTA_BATCH)
+			{
+				stats.bad_frames++;
+				return;
+			}
+			if (!have_prev[sensor])
+			{
+				stats.deltas_lost += n;
+				return;
+			}
+			for (k = 0; k < n; k++)
+			{
+				for (i = 0; i < 8; i++)
+				{
+					// Same 16-bit wrap as the firmware's subtraction
+					prev[sensor][i] = (int16_t)(prev[sensor][i] +
+												(int8_t)body[1 + k * TLM_DELTA_ENTRY_LEN + i]);
+				}
+				stats.deltas++;
+				print_values('D', sensor, seq, -1, prev[sensor]);
+			}
+			break;
+
+		case TLM_FRAME_EVENT:
+			if (body_len != TLM_EVENT_BODY_LEN)
+			{
+				stats.bad_frames++;
+				return;
+			}
+			stats.events++;
+			printf("E%u %3u t=%5u  %-5s value=%u duration=%u ms\n", sensor, seq, get_u16(&body[1]),
+				   body[0] < 4 ? event_names[body[0]] : "?", get_u16(&body[3]), get_u16(&body[5]));
+			break;
+
+		default:
+			stats.bad_frames++;
+			break;
+	}
+}
+
+/**
+ * @brief Check and dispatch one delimited frame.
+ */
+static void handle_wire(uint8_t* wire, size_t length)
+{
+	if (length == 0)
+	{
+		return;
+	}
+
+	stats.frames++;
+	length = cobs_decode(wire, length);
+	if (length < TLM_HEADER_LEN + TLM_CRC_LEN ||
+		crc16(wire, (uint8_t)(length - TLM_CRC_LEN)) != get_u16(&wire[length - TLM_CRC_LEN]))
+	{
+		stats.bad_frames++;
+		forget_keyframes();
+		return;
+	}
+
+	handle_frame(wire, length);
+}
+
+/**
+ * @brief Put a serial port into raw 8N1 at 115200 baud; other files are left alone.
+ */
+static void setup_tty(int fd)
+{
+	struct termios tio;
+
+	if (!isatty(fd) || tcgetattr(fd, &tio) != 0)
+	{
+		return;
+	}
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, B115200);
+	cfsetospeed(&tio, B115200);
+	tcsetattr(fd, TCSANOW, &tio);
+}
+
+/**
+ * @brief Build a command frame from "mode=N", "profile=N", "save" or "recal".
+ */
+static int write_command(int fd, const char* command)
+{
+	uint8_t frame[TLM_HEADER_LEN + 1 + TLM_CRC_LEN];
+	uint8_t wire[sizeof(frame) + 2];
+	size_t length = TLM_HEADER_LEN;
+	uint16_t crc;
+
+	frame[1] = 0;
+	if (strncmp(command, "mode=", 5) == 0)
+	{
+		frame[0] = TLM_CMD_SET_MODE;
+		frame[length++] = (uint8_t)atoi(command + 5);
+	}
+	else if (strncmp(command, "profile=", 8) == 0)
+	{
+		frame[0] = TLM_CMD_SET_PROFILE;
+		frame[length++] = (uint8_t)atoi(command + 8);
+	}
+	else if (strcmp(command, "save") == 0)
+	{
+		frame[0] = TLM_CMD_SAVE_CONFIG;
+	}
+	else if (strcmp(command, "recal") == 0)
+	{
+		frame[0] = TLM_CMD_RECALIBRATE;
+	}
+	else
+	{
+		return -1;
+	}
+
+	crc = crc16(frame, (uint8_t)length);
+	frame[length++] = (uint8_t)(crc & 0xFF);
+	frame[length++] = (uint8_t)(crc >> 8);
+
+	length = cobs_encode(frame, length, wire);
+	wire[length++] = 0x00;
+
+	return write(fd, wire, length) == (ssize_t)length ? 0 : -1;
+}
+
+static void usage(const char* argv0)
+{
+	fprintf(stderr,
+			"usage: %s [path]            decode a capture, serial port or simulator pty\n"
+			"       %s -c command [path] send mode=0|1|2, profile=0|1|2,\n"
+			"                            save or recal\n"
+			"  Reads stdin / writes stdout when no path is given.\n",
+			argv0, argv0);
+}
+
+int main(int argc, char** argv)
+{
+	static uint8_t wire[RX_FRAME_MAX];
+	const char* command = NULL;
+	const char* path = NULL;
+	uint8_t buf[256];
+	size_t wire_len = 0;
+	int overlong = 0;
+	ssize_t n;
+	ssize_t i;
+	int fd;
+	int argi;
+
+	for (argi = 1; argi < argc; argi++)
+	{
+		if (strcmp(argv[argi], "-c") == 0 && argi + 1 < argc)
+		{
+			command = argv[++argi];
+		}
+		else if (argv[argi][0] != '-' && path == NULL)
+		{
+			path = argv[argi];
+		}
+		else
+		{
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (command != NULL)
+	{
+		fd = (path != NULL) ? open(path, O_WRONLY | O_CREAT | O_NOCTTY, 0644) : STDOUT_FILENO;
+		if (fd < 0)
+		{
+			perror(path);
+			return 1;
+		}
+		setup_tty(fd);
+		if (write_command(fd, command) != 0)
+		{
+			usage(argv[0]);
+			return 1;
+		}
+		return 0;
+	}
+
+	fd = (path != NULL) ? open(path, O_RDONLY | O_NOCTTY) : STDIN_FILENO;
+	if (fd < 0)
+	{
+		perror(path);
+		return 1;
+	}
+	setup_tty(fd);
+
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+	{
+		for (i = 0; i < n; i++)
+		{
+			if (buf[i] == 0x00)
+			{
+				if (overlong)
+				{
+					stats.frames++;
+					stats.bad_frames++;
+				}
+				else
+				{
+					handle_wire(wire, wire_len);
+				}
+				wire_len = 0;
+				overlong = 0;
+			}
+			else if (wire_len < sizeof(wire))
+			{
+				wire[wire_len++] = buf[i];
+			}
+			else
+			{
+				overlong = 1;
+			}
+		}
+		fflush(stdout);
+	}
+
+	fprintf(stderr,
+			"\n--- telemetry ---\n"
+			"frames      %8lu (%lu bad, %lu missing by seq)\n"
+			"samples     %8lu keyframes + %lu deltas (%lu deltas lost)\n"
+			"events      %8lu\n",
+			stats.frames, stats.bad_frames, stats.seq_gaps,
+			stats.samples, stats.deltas, stats.deltas_lost, stats.events);
+
+	return 0;
+}
@@ -8,19 +8,132 @@
 #ifndef ACCELEROMETER_H
 #define ACCELEROMETER_H
 
-#include <xc.h>
+#include "./hal.h"
 #include <stddef.h>
 #include <stdint.h>
 #include "./i2c.h"
 
+#define MPU6050_SMPLRT_DIV      0x19  // Sample rate divider
 #define MPU6050_PWR_MGMT_1      0x6B  // Power management register
 #define MPU6050_REG_CONFIG      0x1A  // Register config for low pass filter
 #define MPU6050_GYRO_CONFIG     0x1B  // Gyroscope configuration register
+#define MPU6050_FIFO_EN         0x23  // FIFO sensor enable register
+#define MPU6050_INT_PIN_CFG     0x37  // INT pin configuration
+#define MPU6050_INT_ENABLE      0x38  // Interrupt enable register
+#define MPU6050_INT_STATUS      0x3A  // Interrupt status (clears on read)
 #define MPU6050_ACCEL_XOUT_H    0x3B  // Accelerometer X-axis high byte
+#define MPU6050_TEMP_OUT_H      0x41  // Temperature high byte
 #define MPU6050_GYRO_XOUT_H     0x43  // Gyroscope X-axis high byte
+#define MPU6050_USER_CTRL       0x6A  // User control (FIFO enable/reset)
+#define MPU6050_FIFO_COUNTH     0x72  // FIFO byte count high byte
+#define MPU6050_FIFO_R_W        0x74  // FIFO data register
 #define MPU6050_WHO_AM_I        0x75  // Device ID register
 
-#define GYR0_SENSITIVITY 131
+// FIFO_EN / USER_CTRL / INT_STATUS bits
+#define MPU6050_FIFO_EN_GYRO    0x70  // XG_FIFO_EN | YG_FIFO_EN | ZG_FIFO_EN
+#define MPU6050_FIFO_EN_ACCEL   0x08  // ACCEL_FIFO_EN
+#define MPU6050_USER_FIFO_EN    0x40  // USER_CTRL: enable FIFO
+#define MPU6050_USER_FIFO_RESET 0x04  // USER_CTRL: reset FIFO (self-clearing)
+#define MPU6050_INT_FIFO_OFLOW  0x10  // INT_STATUS: FIFO overflow
+#define MPU6050_INT_DATA_RDY    0x01  // INT_ENABLE/INT_STATUS: data ready
+
+#define MPU6050_FIFO_SIZE       1024  // FIFO capacity in bytes
+
+#define GYRO_SENSITIVITY 131      // LSB per °/s at FS_SEL = 0 (±250°/s); halves per FS_SEL step
+#define ACCEL_SENSITIVITY 16384  // LSB per g at AFS_SEL = 0 (±2 g)
+
+// ACCEL_XOUT_H..GYRO_ZOUT_L: accel X/Y/Z, temperature, gyro X/Y/Z
+#define MPU6050_MOTION_BLOCK_LEN 14
+
+// Magnitude kernel: the raw-count magnitude is scaled to deg/s once with
+// a Q16 multiply by 1/GYRO_SENSITIVITY instead of dividing each axis; a
+// wider range shifts the scale left by FS_SEL
+#define ACC_MAG_SCALE_Q16 ((65536UL + (GYRO_SENSITIVITY / 2)) / GYRO_SENSITIVITY)
+
+#define ACC_MAG_EXACT     0  // sqrt(gx^2 + gy^2 + gz^2) with a bitwise isqrt
+#define ACC_MAG_ALPHA_MAX 1  // max + 11/32 mid + 1/4 min (shifts only, ~±9%)
+#ifndef ACC_MAG_MODE
+#define ACC_MAG_MODE      ACC_MAG_EXACT
+#endif
+
+// Sample rate = gyro output rate / (1 + SMPLRT_DIV); output rate is 1 kHz
+// while the DLPF is enabled (CONFIG = 0x03)
+#define ACC_GYRO_OUTPUT_RATE_HZ    1000
+#define ACC_MIN_SAMPLE_RATE_HZ     4     // SMPLRT_DIV = 249
+#define ACC_DEFAULT_SAMPLE_RATE_HZ 200
+
+// CONFIG.DLPF_CFG; 1..6 keep the 1 kHz gyro output rate
+#define ACC_DLPF_MIN               1     // 188 Hz bandwidth, 1.9 ms delay
+#define ACC_DLPF_MAX               6     // 5 Hz bandwidth, 18.6 ms delay
+#define ACC_DEFAULT_DLPF           3     // 42 Hz bandwidth, 4.8 ms delay
+
+// GYRO_CONFIG.FS_SEL (bits 4:3); each step doubles the range
+#define ACC_GYRO_FS_250            0     // ±250°/s, 131 LSB per °/s
+#define ACC_GYRO_FS_500            1     // ±500°/s, 65.5 LSB per °/s
+#define ACC_GYRO_FS_1000           2     // ±1000°/s, 32.8 LSB per °/s
+#define ACC_GYRO_FS_2000           3     // ±2000°/s, 16.4 LSB per °/s
+#define ACC_GYRO_FS_SHIFT          3     // FS_SEL position in GYRO_CONFIG
+#define ACC_DEFAULT_GYRO_FS        ACC_GYRO_FS_250
+
+// Gyro auto-ranging on the raw register value (before bias removal)
+#define ACC_AUTORANGE_MAX_FS       ACC_GYRO_FS_2000  // Widest range, and the sample unit
+#define ACC_AUTORANGE_HIGH         30000  // |raw| from here steps one range up (~92%)
+#define ACC_AUTORANGE_CLIP         32767  // Clipped: straight to ACC_AUTORANGE_MAX_FS
+#define ACC_AUTORANGE_LOW          12000  // Every axis below this (~73% of the next range down)...
+#define ACC_AUTORANGE_HOLD         100    // ...for this many samples steps one range down
+#define ACC_AUTORANGE_SETTLE       1      // Samples that repeat the last gyro reading after a switch
+#define ACC_DEFAULT_AUTORANGE      1      // Stored default (config_t.gyro_autorange)
+
+// Gyro bias calibration and drift tracking (counts at ±250°/s: 131 per °/s;
+// shifted right by FS_SEL when compared with samples at a wider range)
+#define ACC_CAL_SHIFT          7     // 2^7 = 128 samples at boot (640 ms at 200 Hz)
+#define ACC_CAL_MAX_SPREAD     393   // Max min-to-max per axis while calibrating (3°/s)
+#define ACC_CAL_POLL_LIMIT     5000  // INT_STATUS polls per sample before giving up
+#define ACC_STILL_GYRO         262   // |rate| below 2°/s on every axis counts as still
+#define ACC_STILL_SAMPLES      100   // Still samples required before tracking (0.5 s)
+#define ACC_BIAS_TRACK_SHIFT   8     // Tracking EMA weight 1/256 per sample
+
+// I2C addresses (8-bit form) selected by the AD0 pin
+#define MPU6050_ADDR_AD0_LOW    0xD0
+#define MPU6050_ADDR_AD0_HIGH   0xD2
+#define MPU6050_WHO_AM_I_VALUE  0x68  // Reads 0x68 whatever the AD0 level
+
+/**
+ * MPU-6050 INT pins:
+ * - One external interrupt per sensor: INT1 on RB1 or INT2 on RB2 (SSP2
+ *   sits on RD0/RD1 on the PIC18F45K22, so both are free)
+ * - Push-pull, active high, 50 us pulse on each data-ready event; INTx
+ *   is set for the rising edge
+ */
+#define ACC_INT_RB1             0x02  // INT1
+#define ACC_INT_RB2             0x04  // INT2
+#define ACC_MAX_SENSORS         2     // Sensors sampling on data-ready at once
+#define ACC_RING_SIZE           8     // Data-ready samples buffered per sensor (power of two, <= 128)
+
+/**
+ * Bus budget (400 kHz): a 14-byte motion read is START, 3 address/register
+ * bytes, RESTART, 14 data bytes and STOP, ~157 SCL periods or ~0.4 ms.
+ * Two sensors at 200 Hz keep the bus ~16% busy. The bus alone allows
+ * ~2.5 kHz of reads in total; the SSP2 interrupt per phase adds gaps, so
+ * keep the combined rate well below that. Both reads fit in the async
+ * queue together (2 x 7 of 15 descriptors), so edges that arrive together
+ * are read back to back.
+ */
+
+/**
+ * Latency profiles: DLPF, sample rate and gyro range chosen together.
+ * Delay is the MPU-6050 DLPF group delay; the sample period and any
+ * smoothing in the pipeline come on top.
+ */
+typedef enum
+{
+    ACC_PROFILE_LOW_LATENCY = 0x00,  // DLPF 1 (188 Hz, 1.9 ms), 500 Hz, ±1000°/s
+    ACC_PROFILE_BALANCED    = 0x01,  // DLPF 3 (42 Hz, 4.8 ms), 200 Hz, ±250°/s
+    ACC_PROFILE_SMOOTH      = 0x02,  // DLPF 5 (10 Hz, 13.8 ms), 100 Hz, ±250°/s
+    ACC_PROFILE_COUNT       = 0x03
+} acc_profile_t;
+
+#define ACC_DEFAULT_PROFILE  ACC_PROFILE_BALANCED  // Matches the accelerometer_init() settings
 
 typedef enum
 {
@@ -28,7 +141,10 @@ typedef enum
     ACC_I2C_ERROR        = 0x01,  // I2C communication error
     ACC_INIT_ERROR       = 0x02,  // Initialization error
     ACC_NOT_INITIALIZED  = 0x03,  // Accelerometer not initialized
-    ACC_INVALID_PARAM    = 0x04   // Invalid parameter
+    ACC_INVALID_PARAM    = 0x04,  // Invalid parameter
+    ACC_BUSY             = 0x05,  // Asynchronous read still in progress
+    ACC_FIFO_OVERFLOW    = 0x06,  // FIFO overflowed; it was reset and samples lost
+    ACC_NOT_STILL        = 0x07   // Device moved during gyro calibration
 } acc_error_t;
 
 typedef struct
@@ -38,52 +154,536 @@ typedef struct
     int16_t gz;    // Gyroscope Z-axis raw value
 } gyro_data_t;
 
-#define MOVING_AVG_BUFFER_SIZE 8  // Size of moving average buffer
+typedef struct
+{
+    int16_t ax;          // Accelerometer X-axis raw value
+    int16_t ay;          // Accelerometer Y-axis raw value
+    int16_t az;          // Accelerometer Z-axis raw value
+    int16_t temp;        // Die temperature raw value (°C = temp / 340 + 36.53)
+    gyro_data_t gyro;    // Debiased gyro from the same sample, in the sample unit
+    int8_t gyro_rem[3];  // What rounding gyro to the sample unit dropped (±250°/s counts)
+    unsigned int t_ms;   // scheduler_millis() at the data-ready edge (at the read when polled)
+} motion_sample_t;
+
+/**
+ * Single-producer/single-consumer queue of data-ready samples. The I2C
+ * completion callback fills slots and advances head; the main loop copies
+ * them out and advances tail. head and tail count freely and are masked
+ * on use, so each side only ever writes its own single-byte index and
+ * neither needs interrupts disabled.
+ */
+typedef struct
+{
+    volatile motion_sample_t slots[ACC_RING_SIZE];
+    volatile unsigned char head;        // Samples written (ISR only)
+    volatile unsigned char tail;        // Samples taken (main loop only)
+} acc_ring_t;
+
+/**
+ * Gyro calibration in progress: accelerometer_calibrate_start() clears it
+ * and accelerometer_calibrate_add() folds in one sample per call, so the
+ * samples can be collected across scheduler ticks.
+ */
+typedef struct
+{
+    unsigned char active;
+    unsigned int count;                 // Samples added so far
+    int32_t sum[3];                     // Residual per axis (±250°/s counts)
+    int16_t min[3];                     // Spread per axis (sample unit)
+    int16_t max[3];
+    int32_t temp_sum;
+} acc_calibration_t;
+
+/**
+ * Per-sensor driver state; one instance for each MPU-6050 on the bus.
+ * Set up by accelerometer_init() and updated from the interrupt service
+ * routine, so treat the fields as private.
+ */
+typedef struct
+{
+    unsigned char address;              // I2C address (8-bit form)
+    unsigned char int_mask;             // PORTB bit of the INT pin (ACC_INT_RB1 or ACC_INT_RB2)
+    unsigned char initialized;
+    unsigned char data_ready_enabled;
+    unsigned char fifo_frame_size;      // FIFO frame in bytes (0 = FIFO disabled)
+    volatile unsigned char async_state; // Asynchronous read state
+    unsigned char async_buffer[MPU6050_MOTION_BLOCK_LEN];
+    unsigned int async_ms;              // Data-ready tick of the motion read in flight
+    gyro_data_t async_gyro;             // Result of accelerometer_start_read_gyro()
+    acc_ring_t ring;                    // Data-ready samples waiting to be taken
+    volatile unsigned int dropped_samples;
+    unsigned int sample_rate_hz;
+    unsigned char gyro_fs_sel;          // FS_SEL whose counts the samples are given in
+    volatile unsigned char gyro_hw_fs;  // GYRO_CONFIG.FS_SEL the sensor measures at
+    unsigned char profile;              // acc_profile_t last applied
+    unsigned char autorange;            // 1: gyro_hw_fs follows the signal
+    unsigned char range_min;            // Range set by the profile; auto-ranging floor
+    volatile unsigned char range_pending; // Range of a GYRO_CONFIG write in flight
+    unsigned char range_settle;         // Samples left to hold after a switch
+    unsigned int range_quiet;           // Consecutive samples below ACC_AUTORANGE_LOW
+    gyro_data_t range_hold;             // Last gyro reading, repeated while settling
+    int16_t gyro_bias[3];               // Zero-rate bias in ±250°/s counts; written with interrupts off
+    int32_t gyro_bias_base_q8[3];       // Tracked bias, ±250°/s counts in Q8
+    int16_t gyro_bias_temp_ref;         // Raw TEMP_OUT at calibration
+    unsigned int still_samples;
+    acc_calibration_t cal;
+} accelerometer_t;
+
+#define ACC_FIFO_GYRO_ONLY   0x00  // FIFO frame: gyro X/Y/Z (6 bytes)
+#define ACC_FIFO_WITH_ACCEL  0x01  // FIFO frame: accel X/Y/Z + gyro X/Y/Z (12 bytes)
+#define ACC_FIFO_MAX_BURST   42    // Max gyro-only frames per i2c_bulk_read (252 bytes)
+#define ACC_FIFO_ACCEL_CHUNK 4     // Frames per burst when accel is also queued
+
+#ifndef MOVING_AVG_SHIFT
+#define MOVING_AVG_SHIFT       3  // log2 of the window length (2..6 -> 4..64 samples)
+#endif
+#ifndef MOVING_AVG_WARMUP
+#define MOVING_AVG_WARMUP      1  // 1: partial-window average until full, 0: report 0
+#endif
+
+#if (MOVING_AVG_SHIFT < 2) || (MOVING_AVG_SHIFT > 6)
+#error "MOVING_AVG_SHIFT must be between 2 and 6 (window of 4..64 samples)"
+#endif
+
+#define MOVING_AVG_BUFFER_SIZE (1u << MOVING_AVG_SHIFT)  // Size of moving average buffer
+#define MOVING_AVG_INDEX_MASK  (MOVING_AVG_BUFFER_SIZE - 1u)
 
 typedef struct
 {
     unsigned int buffer[MOVING_AVG_BUFFER_SIZE];
+    unsigned long sum;       // Running sum of the buffer contents
     unsigned char index;
+    unsigned char count;     // Valid entries while warming up
     unsigned char is_full;
 } moving_avg_t;
 
 /**
  * @brief Initialize the MPU-6050 accelerometer/gyroscope.
  * 
- * Configures the MPU-6050 for gyroscope measurement with:
+ * Resets the instance, then configures the MPU-6050 for gyroscope
+ * measurement with the ACC_DEFAULT_PROFILE settings:
  * - ±250°/s sensitivity (GYRO_CONFIG = 0x00)
  * - Internal clock as timing source
+ * - ACC_DEFAULT_DLPF and ACC_DEFAULT_SAMPLE_RATE_HZ (CONFIG, SMPLRT_DIV)
+ * - Data-ready interrupt on the INT pin (INT_ENABLE = 0x01)
  * 
+ * @param acc Sensor instance to set up
+ * @param address MPU6050_ADDR_AD0_LOW or MPU6050_ADDR_AD0_HIGH
+ * @param int_mask PORTB pin wired to the sensor's INT (ACC_INT_RB1 or ACC_INT_RB2)
  * @return acc_error_t Error code (ACC_SUCCESS or error)
  */
-acc_error_t accelerometer_init(void);
+acc_error_t accelerometer_init(accelerometer_t* acc, unsigned char address,
+                               unsigned char int_mask);
 
 /**
  * @brief Read raw gyroscope data from all three axes.
  * 
  * Performs I2C burst read of 6 bytes starting from GYRO_XOUT_H.
- * Combines high and low bytes into 16-bit signed values.
+ * Combines high and low bytes into 16-bit signed values, debiased and
+ * in the sample unit (accelerometer_get_gyro_range()). With auto-ranging
+ * on, a near-saturated reading switches the range before returning.
+ * 
+ * @param acc Sensor instance
+ * @param gyro Pointer to gyro_data_t structure to store results
+ * @return acc_error_t ACC_SUCCESS, or ACC_I2C_ERROR on NACK, timeout or
+ *         bus error (gyro is left unchanged)
+ */
+acc_error_t accelerometer_read_gyro(accelerometer_t* acc, gyro_data_t* gyro);
+
+/**
+ * @brief Read accelerometer, temperature and gyroscope in one burst.
+ * 
+ * Performs a single 14-byte I2C burst read from ACCEL_XOUT_H (0x3B)
+ * through GYRO_ZOUT_L (0x48), so all seven values come from the same
+ * sample instead of three separate transactions.
+ * 
+ * @param acc Sensor instance
+ * @param motion Pointer to motion_sample_t structure to store results
+ * @return acc_error_t ACC_SUCCESS, or ACC_I2C_ERROR on NACK, timeout or
+ *         bus error (motion is left unchanged)
+ */
+acc_error_t accelerometer_read_motion(accelerometer_t* acc, motion_sample_t* motion);
+
+/**
+ * @brief Start a non-blocking gyroscope read.
+ * 
+ * Queues the same 6-byte burst read as accelerometer_read_gyro() on the
+ * interrupt-driven I2C engine and returns immediately. Collect the result
+ * with accelerometer_get_async_gyro().
  * 
+ * @param acc Sensor instance
+ * @return acc_error_t ACC_SUCCESS if queued, ACC_BUSY if a read is already
+ *         in flight, or error
+ */
+acc_error_t accelerometer_start_read_gyro(accelerometer_t* acc);
+
+/**
+ * @brief Collect the result of accelerometer_start_read_gyro().
+ * 
+ * @param acc Sensor instance
  * @param gyro Pointer to gyro_data_t structure to store results
+ * @return acc_error_t ACC_SUCCESS when a new sample was stored, ACC_BUSY
+ *         while the transfer is in progress, ACC_I2C_ERROR on NACK, or error
+ */
+acc_error_t accelerometer_get_async_gyro(accelerometer_t* acc, gyro_data_t* gyro);
+
+/**
+ * @brief Set the sensor sample rate.
+ * 
+ * Programs SMPLRT_DIV = (ACC_GYRO_OUTPUT_RATE_HZ / hz) - 1. The data-ready
+ * interrupt, FIFO and output registers all update at this rate. Rates
+ * that do not divide 1 kHz evenly are rounded to the next lower rate.
+ * 
+ * @param acc Sensor instance
+ * @param hz Sample rate in Hz (ACC_MIN_SAMPLE_RATE_HZ to 1000)
  * @return acc_error_t Error code (ACC_SUCCESS or error)
  */
-acc_error_t accelerometer_read_gyro(gyro_data_t* gyro);
+acc_error_t accelerometer_set_sample_rate(accelerometer_t* acc, unsigned int hz);
+
+/**
+ * @brief Select the MPU-6050 digital low-pass filter.
+ * 
+ * Lower bandwidth means less noise but more group delay.
+ * 
+ * @param acc Sensor instance
+ * @param dlpf_cfg CONFIG.DLPF_CFG value, ACC_DLPF_MIN..ACC_DLPF_MAX
+ * @return acc_error_t Error code (ACC_SUCCESS or error)
+ */
+acc_error_t accelerometer_set_dlpf(accelerometer_t* acc, unsigned char dlpf_cfg);
+
+/**
+ * @brief Select the gyro full-scale range.
+ * 
+ * Samples read afterwards are in counts at the new range
+ * (GYRO_SENSITIVITY >> fs_sel LSB per °/s). The stored bias and the
+ * still/calibration thresholds follow automatically; use
+ * accelerometer_get_speed() for °/s. With auto-ranging on, this is the
+ * narrowest range it may step down to.
+ * 
+ * @param acc Sensor instance
+ * @param fs_sel ACC_GYRO_FS_250..ACC_GYRO_FS_2000
+ * @return acc_error_t ACC_SUCCESS, ACC_INVALID_PARAM, ACC_BUSY while any
+ *         sensor samples on data-ready, or error
+ */
+acc_error_t accelerometer_set_gyro_range(accelerometer_t* acc, unsigned char fs_sel);
+
+/**
+ * @brief Get the range whose counts the samples are given in.
+ * 
+ * The set range, or ACC_AUTORANGE_MAX_FS while auto-ranging; it only
+ * changes through the calls that need sampling stopped.
+ * 
+ * @param acc Sensor instance
+ * @return unsigned char FS_SEL of the sample unit (ACC_GYRO_FS_x)
+ */
+unsigned char accelerometer_get_gyro_range(const accelerometer_t* acc);
+
+/**
+ * @brief Get the range the sensor is measuring at right now.
+ * 
+ * @param acc Sensor instance
+ * @return unsigned char GYRO_CONFIG.FS_SEL (ACC_GYRO_FS_x)
+ */
+unsigned char accelerometer_get_gyro_hw_range(const accelerometer_t* acc);
+
+/**
+ * @brief Turn gyro auto-ranging on or off.
+ * 
+ * While on, a raw reading at or above ACC_AUTORANGE_HIGH on any axis
+ * steps GYRO_CONFIG one range up (a clipped one goes straight to
+ * ACC_AUTORANGE_MAX_FS), and ACC_AUTORANGE_HOLD samples below
+ * ACC_AUTORANGE_LOW step it back down, no lower than the range set by
+ * accelerometer_set_gyro_range() or the profile. Samples are always
+ * given in ACC_AUTORANGE_MAX_FS counts, so consumers never see a switch;
+ * the reading after one repeats the previous gyro values while the DLPF
+ * settles. On the data-ready path the write is queued from the ISR.
+ * Not applied to FIFO reads.
+ * 
+ * Refresh anything that depends on accelerometer_get_gyro_range()
+ * (orientation_set_rate()) afterwards.
+ * 
+ * @param acc Sensor instance
+ * @param enable 1 to follow the signal, 0 to stay at the set range
+ * @return acc_error_t ACC_SUCCESS, ACC_BUSY while any sensor samples on
+ *         data-ready, or error
+ */
+acc_error_t accelerometer_set_autorange(accelerometer_t* acc, unsigned char enable);
+
+/**
+ * @brief Apply a latency profile: DLPF, sample rate and gyro range.
+ * 
+ * Stop data-ready sampling on every sensor first; re-enabling it clears
+ * any samples queued at the old settings. Anything derived from the
+ * sample rate or range (orientation_set_rate(), filter cutoffs) must be
+ * refreshed by the caller.
+ * 
+ * @param acc Sensor instance
+ * @param profile acc_profile_t value
+ * @return acc_error_t ACC_SUCCESS, ACC_INVALID_PARAM, ACC_BUSY while any
+ *         sensor samples on data-ready, or error (settings partly applied)
+ */
+acc_error_t accelerometer_set_profile(accelerometer_t* acc, unsigned char profile);
+
+/**
+ * @brief Get the profile last applied.
+ * 
+ * @param acc Sensor instance
+ * @return unsigned char acc_profile_t value
+ */
+unsigned char accelerometer_get_profile(const accelerometer_t* acc);
+
+/**
+ * @brief Get the sample rate actually programmed into the sensor.
+ * 
+ * @param acc Sensor instance
+ * @return unsigned int Sample rate in Hz
+ */
+unsigned int accelerometer_get_sample_rate(const accelerometer_t* acc);
+
+/**
+ * @brief Measure the gyro zero-rate bias with the device at rest.
+ * 
+ * Averages 2^ACC_CAL_SHIFT samples, paced on DATA_RDY, and records the
+ * die temperature it was measured at. Samples are summed in
+ * ±250°/s counts (gyro plus gyro_rem), so a sample unit wider than the
+ * hardware range adds no rounding to the bias. Every read path then
+ * subtracts the bias. Call after accelerometer_init() while no sensor is
+ * sampling on data-ready: the ISR would queue reads between the polls.
+ * 
+ * @param acc Sensor instance
+ * @return acc_error_t ACC_SUCCESS, ACC_NOT_STILL if any axis spread more
+ *         than ACC_CAL_MAX_SPREAD (previous bias kept), ACC_BUSY while any
+ *         sensor samples on data-ready, or error
+ */
+acc_error_t accelerometer_calibrate_gyro(accelerometer_t* acc);
+
+/**
+ * @brief Start a gyro calibration fed by accelerometer_calibrate_add().
+ * 
+ * Unlike accelerometer_calibrate_gyro() this does not block, so it can
+ * run while the sensor samples on data-ready. A calibration already in
+ * progress starts over.
+ * 
+ * @param acc Sensor instance
+ * @return acc_error_t ACC_SUCCESS, or ACC_NOT_INITIALIZED
+ */
+acc_error_t accelerometer_calibrate_start(accelerometer_t* acc);
+
+/**
+ * @brief Add one sample to the calibration started by
+ *        accelerometer_calibrate_start().
+ * 
+ * After 2^ACC_CAL_SHIFT samples the bias and its calibration temperature
+ * are updated as by accelerometer_calibrate_gyro() and the calibration
+ * ends. Feed it the sensor's samples in place of accelerometer_track_bias()
+ * so the bias does not move underneath it.
+ * 
+ * @param acc Sensor instance the sample came from
+ * @param motion Debiased sample from accelerometer_get_motion_sample()
+ * @return acc_error_t ACC_BUSY while more samples are needed, ACC_SUCCESS
+ *         once done, ACC_NOT_STILL if any axis spread more than
+ *         ACC_CAL_MAX_SPREAD (previous bias kept), ACC_NOT_INITIALIZED if
+ *         no calibration is in progress
+ */
+acc_error_t accelerometer_calibrate_add(accelerometer_t* acc, const motion_sample_t* motion);
+
+/**
+ * @brief Track slow bias drift from the running sample stream.
+ * 
+ * After ACC_STILL_SAMPLES consecutive samples inside ±ACC_STILL_GYRO the
+ * residual rate, in ±250°/s counts like the calibration, is folded into
+ * the bias with weight 1/2^ACC_BIAS_TRACK_SHIFT.
+ * Call from task context once per sample.
+ * 
+ * @param acc Sensor instance the sample came from
+ * @param motion Debiased sample from accelerometer_get_motion_sample()
+ * @return void
+ */
+void accelerometer_track_bias(accelerometer_t* acc, const motion_sample_t* motion);
+
+/**
+ * @brief Get the gyro bias currently subtracted from readings.
+ * 
+ * @param acc Sensor instance
+ * @param bias Pointer to store the bias in ±250°/s counts
+ * @return void
+ */
+void accelerometer_get_gyro_bias(const accelerometer_t* acc, gyro_data_t* bias);
+
+/**
+ * @brief Get the calibrated bias for storage.
+ * 
+ * @param acc Sensor instance
+ * @param bias Pointer to store the tracked bias (±250°/s counts)
+ * @param temp_ref Pointer to store the raw TEMP_OUT at calibration
+ * @return void
+ */
+void accelerometer_get_gyro_calibration(const accelerometer_t* acc, gyro_data_t* bias,
+                                        int16_t* temp_ref);
+
+/**
+ * @brief Restore a stored bias instead of calibrating at boot.
+ * 
+ * @param acc Sensor instance
+ * @param bias Bias in ±250°/s counts (any range in use)
+ * @param temp_ref Raw TEMP_OUT the bias was measured at
+ * @return void
+ */
+void accelerometer_set_gyro_calibration(accelerometer_t* acc, const gyro_data_t* bias,
+                                        int16_t temp_ref);
+
+/**
+ * @brief Start interrupt-driven sampling on the MPU-6050 INT pin.
+ * 
+ * Enables the external interrupt on the sensor's INT pin. Each data-ready
+ * pulse starts an asynchronous 14-byte accel/temp/gyro read from the ISR,
+ * so samples are captured at the sensor's fixed cadence regardless of how
+ * long the main loop takes.
+ * Up to ACC_RING_SIZE samples queue until they are collected with
+ * accelerometer_get_sample(), accelerometer_get_motion_sample() or
+ * accelerometer_get_motion_samples().
+ * 
+ * @param acc Sensor instance
+ * @return acc_error_t ACC_SUCCESS, ACC_BUSY if ACC_MAX_SENSORS are
+ *         already sampling, or error
+ */
+acc_error_t accelerometer_enable_data_ready(accelerometer_t* acc);
+
+/**
+ * @brief Stop interrupt-driven sampling for one sensor.
+ * 
+ * Waits for a read already on the bus to finish. Once every sensor is
+ * stopped, blocking calls such as accelerometer_calibrate_gyro() can be
+ * used. Re-enable with accelerometer_enable_data_ready().
+ * 
+ * @param acc Sensor instance
+ * @return acc_error_t Error code (ACC_SUCCESS or error)
+ */
+acc_error_t accelerometer_disable_data_ready(accelerometer_t* acc);
+
+/**
+ * @brief Take the oldest queued data-ready sample.
+ * 
+ * @param acc Sensor instance
+ * @param gyro Pointer to gyro_data_t structure to store results
+ * @return acc_error_t ACC_SUCCESS when a sample was stored, ACC_BUSY if
+ *         the queue is empty, ACC_I2C_ERROR once after a failed read
+ */
+acc_error_t accelerometer_get_sample(accelerometer_t* acc, gyro_data_t* gyro);
+
+/**
+ * @brief Take the oldest queued data-ready sample with accel and temperature.
+ * 
+ * Same queue and return codes as accelerometer_get_sample(); either one
+ * consumes the sample.
+ * 
+ * @param acc Sensor instance
+ * @param motion Pointer to motion_sample_t structure to store results
+ * @return acc_error_t ACC_SUCCESS when a new sample was stored, ACC_BUSY
+ *         if none has arrived since the last call, ACC_I2C_ERROR on NACK
+ */
+acc_error_t accelerometer_get_motion_sample(accelerometer_t* acc, motion_sample_t* motion);
+
+/**
+ * @brief Take up to max queued data-ready samples, oldest first.
+ * 
+ * Copies without disabling interrupts; samples that arrive meanwhile stay
+ * queued for the next call.
+ * 
+ * @param acc Sensor instance
+ * @param samples Array of at least max samples
+ * @param max Most samples to take
+ * @param count Set to the number of samples stored
+ * @return acc_error_t ACC_SUCCESS with count >= 1, ACC_BUSY if the queue
+ *         is empty, ACC_I2C_ERROR once after a failed read
+ */
+acc_error_t accelerometer_get_motion_samples(accelerometer_t* acc, motion_sample_t* samples,
+                                             unsigned char max, unsigned char* count);
+
+/**
+ * @brief Number of data-ready samples lost because the queue was full or
+ *        the previous read was still on the bus.
+ * 
+ * @param acc Sensor instance
+ * @return unsigned int Dropped sample count (wraps at 65535)
+ */
+unsigned int accelerometer_get_dropped_samples(accelerometer_t* acc);
+
+/**
+ * @brief Data-ready interrupt handler (INT1/INT2).
+ * 
+ * Starts a motion read for every sampling sensor whose INT pin rose.
+ * Must be called from the interrupt service routine. Returns immediately
+ * if neither INT1IF nor INT2IF is set.
+ * 
+ * @return void
+ */
+void accelerometer_isr(void);
+
+/**
+ * @brief Enable the MPU-6050 FIFO for batch sampling.
+ * 
+ * Resets the FIFO, selects the gyroscope (and optionally accelerometer)
+ * outputs in FIFO_EN and sets USER_CTRL.FIFO_EN. Samples are then queued
+ * by the sensor at the configured sample rate until drained with
+ * accelerometer_fifo_read().
+ * 
+ * @param acc Sensor instance
+ * @param mode ACC_FIFO_GYRO_ONLY or ACC_FIFO_WITH_ACCEL
+ * @return acc_error_t Error code (ACC_SUCCESS or error)
+ */
+acc_error_t accelerometer_fifo_enable(accelerometer_t* acc, unsigned char mode);
+
+/**
+ * @brief Disable the FIFO and return to per-sample register reads.
+ * 
+ * @param acc Sensor instance
+ * @return acc_error_t Error code (ACC_SUCCESS or error)
+ */
+acc_error_t accelerometer_fifo_disable(accelerometer_t* acc);
+
+/**
+ * @brief Drain queued samples from the FIFO.
+ * 
+ * Reads FIFO_COUNT and drains up to max_samples whole frames. In gyro-only
+ * mode the frames are read with a single i2c_bulk_read burst straight into
+ * the caller's array (up to ACC_FIFO_MAX_BURST per call). Accelerometer
+ * data, if queued, is discarded.
+ * 
+ * On overflow (INT_STATUS.FIFO_OFLOW, a full FIFO or a count that is not
+ * a whole number of frames) the FIFO is reset, *count is set to 0 and
+ * ACC_FIFO_OVERFLOW is returned; the next call resumes normally.
+ * 
+ * @param acc Sensor instance
+ * @param samples Array receiving the drained samples, oldest first
+ * @param max_samples Capacity of the samples array
+ * @param count Number of samples stored
+ * @return acc_error_t Error code (ACC_SUCCESS, ACC_FIFO_OVERFLOW or error)
+ */
+acc_error_t accelerometer_fifo_read(accelerometer_t* acc,
+                                    gyro_data_t* samples,
+                                    unsigned char max_samples,
+                                    unsigned char* count);
 
 /**
  * @brief Calculate the magnitude of angular velocity from gyroscope data.
  * 
- * Computes: magnitude = sqrt(gx^2 + gy^2 + gz^2)
- * Result is in raw gyroscope units (not °/s).
+ * Computes: magnitude = sqrt(gx^2 + gy^2 + gz^2) on raw counts, then
+ * scales once to °/s. ACC_MAG_MODE = ACC_MAG_ALPHA_MAX replaces the
+ * square root with an alpha-max-plus-beta-min estimate.
+ * Result is in °/s for counts at ±250°/s; accelerometer_get_speed()
+ * takes the sensor's range into account.
  * 
  * @param gyro Pointer to gyro_data_t structure with gyroscope values
  * @return unsigned int Magnitude of angular velocity
  */
-unsigned int accelerometer_calculate_magnitude(gyro_data_t* gyro);
+unsigned int accelerometer_calculate_magnitude(const gyro_data_t* gyro);
 
 /**
  * @brief Update moving average buffer with new speed value.
  * 
- * Adds speed value to circular buffer and updates average.
+ * Replaces the oldest sample in the circular buffer and updates the
+ * running sum, so the cost is constant regardless of window length.
  * Used for smoothing instantaneous speed measurements.
  * 
  * @param avg Pointer to moving_avg_t buffer structure
@@ -95,42 +695,64 @@ void accelerometer_update_moving_avg(moving_avg_t* avg, unsigned int speed);
 /**
  * @brief Get the current moving average speed.
  * 
+ * Once the window is full the average is sum >> MOVING_AVG_SHIFT.
+ * Before that, MOVING_AVG_WARMUP selects between the average of the
+ * samples received so far and 0.
+ * 
  * @param avg Pointer to moving_avg_t buffer structure
- * @return unsigned int Current moving average value (0 if buffer not full)
+ * @return unsigned int Current moving average value
  */
 unsigned int accelerometer_get_moving_avg(moving_avg_t* avg);
 
 /**
  * @brief Map speed value to RGB LED color.
  * 
- * Speed Mapping (in raw gyro units):
- * - 0-100:        Red (255, 0, 0)
- * - 100-300:      Yellow (255, 255, 0)
- * - 300-600:      Green (0, 255, 0)
- * - 600+:         Blue (0, 0, 255)
+ * Continuous gradient from the gamma-corrected table in color_lut.h,
+ * generated from src/host/speed_palette.txt (default: red up to 100°/s,
+ * through amber at 300 and green at 600 to blue at 900°/s and above).
+ * Costs a shift, a clamp and three reads from program memory.
  * 
  * @param speed Moving average speed value
- * @param r Pointer to red component (0-255)
- * @param g Pointer to green component (0-255)
- * @param b Pointer to blue component (0-255)
+ * @param r Pointer to red duty (0-1023, for lights_set_color10())
+ * @param g Pointer to green duty (0-1023)
+ * @param b Pointer to blue duty (0-1023)
  * @return acc_error_t Error code (ACC_SUCCESS or error)
  */
 acc_error_t accelerometer_speed_to_color(unsigned int speed, 
-                                         unsigned char* r,
-                                         unsigned char* g,
-                                         unsigned char* b);
+                                         unsigned int* r,
+                                         unsigned int* g,
+                                         unsigned int* b);
 
 /**
  * @brief Reset the moving average buffer.
  * 
- * Clears the buffer and resets index/full flag.
+ * Clears the buffer, running sum, index and fill state.
  * 
  * @param avg Pointer to moving_avg_t buffer structure
  * @return void
  */
 void accelerometer_reset_moving_avg(moving_avg_t* avg);
 
-// Add JavaDoc
+/**
+ * @brief Angular speed of a sample from this sensor, in °/s.
+ * 
+ * Same kernel as accelerometer_calculate_magnitude(), scaled for the
+ * sensor's current gyro range.
+ * 
+ * @param acc Sensor instance the sample came from
+ * @param gyro Pointer to gyro_data_t structure with gyroscope values
+ * @return unsigned int Magnitude of angular velocity (°/s)
+ */
+unsigned int accelerometer_get_speed(const accelerometer_t* acc, const gyro_data_t* gyro);
+
+/**
+ * @brief Integer square root, rounded down.
+ * 
+ * Bitwise shift/subtract method: 16 iterations, no division.
+ * 
+ * @param n Value to take the root of (full 32-bit range)
+ * @return unsigned int floor(sqrt(n))
+ */
 unsigned int isqrt(unsigned long n);
 
 #endif  // ACCELEROMETER_H
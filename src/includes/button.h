@@ -3,59 +3,55 @@
 
 /**
  * @file button.h
- * @brief Header for button.c — button / PWM melody driver for Micro-Fencing project.
+ * @brief Header for button.c — button driver for Micro-Fencing project.
+ *
+ * The button on RB0 (active low) interrupts on INT0. An edge only starts
+ * a debounce countdown on the 1 ms tick; the settled level is sampled
+ * when it runs out and INT0 is re-armed for the opposite edge. Press and
+ * release times are decoded into short, long and double presses, which
+ * queue for the main loop. Nothing here blocks or depends on how often
+ * the main loop runs.
  */
 
-#include <xc.h>
+#include "./hal.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /* ---------------------------------------------------------------------
  * Configuration Macros
  * ------------------------------------------------------------------ */
 
-// Tempo unit in milliseconds.
-#define UNIT_MS 75
-
-// Note value definitions (PR2 register values for PWM frequency)
-#define b3  0xFC
-#define c4  0xEE
-#define d4  0xD4
-#define e4  0xBD
-#define f4  0xB2
-#define g4  0x9E
-#define a4  0x8D
-#define b4  0x7D
-#define c5  0x76
-#define d5  0x69
-#define e5  0x5E
-#define f5  0x59
-#define g5  0x4F
-#define a5  0x46
-#define b5  0x3E
-#define c6  0x3B
+// Timing in ms (button_tick() is called every 1 ms).
+#define BUTTON_DEBOUNCE_MS  20   // Settle time after an edge
+#define BUTTON_LONG_MS      800  // Held this long = long press
+#define BUTTON_DOUBLE_MS    250  // Second press within this gap = double press
+#define BUTTON_QUEUE_SIZE   8    // Event queue length (power of two, <= 128)
 
-/* ---------------------------------------------------------------------
- * External Melody Data
- * ------------------------------------------------------------------ */
-
-#define MELODY_LENGTH 7
+typedef enum {
+    BUTTON_NONE = 0,
+    BUTTON_SHORT,        // Released, no second press within BUTTON_DOUBLE_MS
+    BUTTON_LONG,         // Still held after BUTTON_LONG_MS (sent before release)
+    BUTTON_DOUBLE        // Second press started within BUTTON_DOUBLE_MS
+} button_event_t;
 
 /* ---------------------------------------------------------------------
  * Public API
  * ------------------------------------------------------------------ */
 
+// Configure INT0 for the next press and empty the queue.
 void button_init(void);
-void pwm_start(void);
-void pwm_stop(void);
-void play_melody_once(void);
-void button_code(void);
 
-/* ---------------------------------------------------------------------
- * Delay Helpers
- * ------------------------------------------------------------------ */
+// INT0 edge from the ISR: masks INT0 and starts the debounce countdown.
+void button_isr(void);
+
+// 1 ms tick from the ISR: debounce, re-arm INT0 and time the gestures.
+void button_tick(void);
+
+// Take the oldest queued gesture; false if there is none. Never blocks.
+bool button_get_event(button_event_t *event);
 
-void delay_ms_runtime(uint16_t ms);
-void delay_units(uint16_t units);
+// Gestures lost because the queue was full.
+uint8_t button_get_dropped(void);
 
 #endif /* BUTTON_H */
@@ -0,0 +1,89 @@
+/**
+ * @file color_lut.h
+ * @brief Speed to RGB LED duty table for accelerometer_speed_to_color().
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Generated by src/host/gen_color_lut from speed_palette.txt; edit the palette
+ * and rebuild instead of changing this file.
+ * Gamma 2.20, stops at 0 100 300 600 900 °/s.
+ */
+#ifndef COLOR_LUT_H
+#define COLOR_LUT_H
+
+#include <stdint.h>
+
+#define COLOR_LUT_SHIFT 4    // One entry per 16 °/s
+#define COLOR_LUT_SIZE  64   // Faster speeds use the last entry
+#define COLOR_LUT_MAX   1023 // Full-scale duty
+
+// PWM duty (r, g, b) for the middle of each step; const keeps it in
+// program memory on XC8
+static const uint16_t color_lut[COLOR_LUT_SIZE][3] = {
+    { 1023,    0,    0 },  //     0 °/s
+    { 1023,    0,    0 },  //    16 °/s
+    { 1023,    0,    0 },  //    32 °/s
+    { 1023,    0,    0 },  //    48 °/s
+    { 1023,    0,    0 },  //    64 °/s
+    { 1023,    0,    0 },  //    80 °/s
+    { 1023,    0,    0 },  //    96 °/s
+    { 1023,    1,    0 },  //   112 °/s
+    { 1023,    5,    0 },  //   128 °/s
+    { 1023,   10,    0 },  //   144 °/s
+    { 1023,   19,    0 },  //   160 °/s
+    { 1023,   30,    0 },  //   176 °/s
+    { 1023,   44,    0 },  //   192 °/s
+    { 1023,   61,    0 },  //   208 °/s
+    { 1023,   81,    0 },  //   224 °/s
+    { 1023,  104,    0 },  //   240 °/s
+    { 1023,  131,    0 },  //   256 °/s
+    { 1023,  160,    0 },  //   272 °/s
+    { 1023,  193,    0 },  //   288 °/s
+    {  935,  222,    0 },  //   304 °/s
+    {  825,  250,    0 },  //   320 °/s
+    {  722,  280,    0 },  //   336 °/s
+    {  626,  312,    0 },  //   352 °/s
+    {  538,  346,    0 },  //   368 °/s
+    {  457,  381,    0 },  //   384 °/s
+    {  383,  419,    0 },  //   400 °/s
+    {  316,  458,    0 },  //   416 °/s
+    {  257,  499,    0 },  //   432 °/s
+    {  204,  543,    0 },  //   448 °/s
+    {  157,  588,    0 },  //   464 °/s
+    {  117,  635,    0 },  //   480 °/s
+    {   83,  685,    0 },  //   496 °/s
+    {   56,  736,    0 },  //   512 °/s
+    {   34,  789,    0 },  //   528 °/s
+    {   18,  845,    0 },  //   544 °/s
+    {    7,  902,    0 },  //   560 °/s
+    {    2,  961,    0 },  //   576 °/s
+    {    0, 1023,    0 },  //   592 °/s
+    {    0,  907,    2 },  //   608 °/s
+    {    0,  798,    7 },  //   624 °/s
+    {    0,  697,   18 },  //   640 °/s
+    {    0,  603,   34 },  //   656 °/s
+    {    0,  517,   56 },  //   672 °/s
+    {    0,  438,   83 },  //   688 °/s
+    {    0,  366,  117 },  //   704 °/s
+    {    0,  301,  157 },  //   720 °/s
+    {    0,  243,  204 },  //   736 °/s
+    {    0,  191,  257 },  //   752 °/s
+    {    0,  146,  316 },  //   768 °/s
+    {    0,  108,  383 },  //   784 °/s
+    {    0,   76,  457 },  //   800 °/s
+    {    0,   50,  538 },  //   816 °/s
+    {    0,   30,  626 },  //   832 °/s
+    {    0,   15,  722 },  //   848 °/s
+    {    0,    6,  825 },  //   864 °/s
+    {    0,    1,  935 },  //   880 °/s
+    {    0,    0, 1023 },  //   896 °/s
+    {    0,    0, 1023 },  //   912 °/s
+    {    0,    0, 1023 },  //   928 °/s
+    {    0,    0, 1023 },  //   944 °/s
+    {    0,    0, 1023 },  //   960 °/s
+    {    0,    0, 1023 },  //   976 °/s
+    {    0,    0, 1023 },  //   992 °/s
+    {    0,    0, 1023 }   //  1008 °/s
+};
+
+#endif  // COLOR_LUT_H
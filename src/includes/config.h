@@ -0,0 +1,112 @@
+/**
+ * @file config.h
+ * @brief Versioned, CRC-checked configuration record in data EEPROM.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "./hal.h"
+#include <stdint.h>
+#include "./eeprom.h"
+#include "./crc.h"
+
+/**
+ * Layout (little-endian, no padding on XC8 or gcc):
+ * magic, version and length identify the record; crc is CRC-16/CCITT
+ * over every byte before it. A record that fails any check is ignored at
+ * load time. Bump CONFIG_VERSION whenever a field is added, removed or
+ * reinterpreted.
+ *
+ * Two slots hold the record. A save goes to the slot not holding the
+ * newest good record, with the next sequence number, and the CRC is the
+ * last byte written; a save torn by a reset fails its CRC and the load
+ * falls back to the other slot. Defaults are used only if neither slot
+ * is valid.
+ *
+ * Saving does not block: config_save() stages a copy and config_poll(),
+ * run from a scheduler task, starts one byte write (~4 ms) per call and
+ * verifies the slot once every byte is written.
+ */
+
+#define CONFIG_EEPROM_ADDR  0x00    // Slot 0; slot 1 follows CONFIG_SLOT_SIZE later
+#define CONFIG_SLOT_SIZE    0x40
+#define CONFIG_MAGIC        0x464D  // "MF"
+#define CONFIG_VERSION      7
+
+typedef enum
+{
+    CONFIG_OK          = 0x00,  // Stored record loaded / saved
+    CONFIG_DEFAULTS    = 0x01,  // No valid record; defaults loaded
+    CONFIG_WRITE_ERROR = 0x02,  // EEPROM did not read back what was written
+    CONFIG_PENDING     = 0x03   // Save staged; config_poll() is writing it
+} config_status_t;
+
+typedef struct
+{
+    uint16_t magic;
+    uint8_t version;
+    uint8_t length;               // sizeof(config_t)
+    uint8_t sequence;             // Save count; the newer valid slot is loaded
+    uint8_t profile;              // acc_profile_t: DLPF, sample rate and gyro range
+    uint8_t button_melody;        // melody_id_t played on a button press
+    uint16_t detect_onset;        // Blade-action detector thresholds (°/s)
+    uint16_t detect_offset;
+    uint16_t detect_refractory_ms;
+    uint8_t bias_valid;           // 1 once a calibration has been stored
+    uint8_t guard_filter;         // filter_preset_t for the guard speed average
+    uint8_t wrist_filter;         // filter_preset_t for the wrist speed average
+    uint8_t gyro_autorange;       // 1: step the gyro range up on saturation
+    int16_t gyro_bias[3];         // Zero-rate bias (±250°/s counts)
+    int16_t gyro_temp_ref;        // Raw TEMP_OUT at calibration
+    uint16_t crc;                 // CRC-16/CCITT of all bytes above
+} config_t;
+
+/**
+ * @brief Fill a record with the compiled-in defaults (no stored bias).
+ *
+ * @param config Pointer to the record
+ * @return void
+ */
+void config_defaults(config_t* config);
+
+/**
+ * @brief Load the newest valid record from data EEPROM.
+ *
+ * @param config Pointer to the record; holds defaults if none is valid
+ * @return config_status_t CONFIG_OK or CONFIG_DEFAULTS
+ */
+config_status_t config_load(config_t* config);
+
+/**
+ * @brief Stage the record for saving to data EEPROM.
+ *
+ * Sets magic/version/length, the sequence number and the CRC, and copies
+ * the record; config_poll() then writes it. A save requested while one is
+ * in progress replaces it.
+ *
+ * @param config Pointer to the record
+ * @return config_status_t CONFIG_PENDING, or CONFIG_WRITE_ERROR for NULL
+ */
+config_status_t config_save(config_t* config);
+
+/**
+ * @brief Advance a staged save by at most one byte write.
+ *
+ * Returns at once while a write cycle runs; unchanged bytes are skipped
+ * without one. Call periodically (CONFIG_TASK_MS) from task context.
+ *
+ * @return void
+ */
+void config_poll(void);
+
+/**
+ * @brief Outcome of the last config_save().
+ *
+ * @return config_status_t CONFIG_PENDING while writing, then CONFIG_OK or
+ *         CONFIG_WRITE_ERROR
+ */
+config_status_t config_save_status(void);
+
+#endif  // CONFIG_H
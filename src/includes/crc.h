@@ -0,0 +1,34 @@
+/**
+ * @file crc.h
+ * @brief CRC-16/CCITT checksum for stored and transmitted records.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF  // CRC-16/CCITT-FALSE: poly 0x1021, init 0xFFFF
+
+/**
+ * @brief Fold one byte into a running CRC-16/CCITT.
+ *
+ * Bitwise form: no table, so no flash cost beyond the loop.
+ *
+ * @param crc Running value (start with CRC16_INIT)
+ * @param data Next byte
+ * @return uint16_t Updated CRC
+ */
+uint16_t crc16_update(uint16_t crc, uint8_t data);
+
+/**
+ * @brief CRC-16/CCITT of a buffer.
+ *
+ * @param data Pointer to the bytes
+ * @param length Number of bytes
+ * @return uint16_t CRC of the buffer
+ */
+uint16_t crc16(const uint8_t* data, uint8_t length);
+
+#endif  // CRC_H
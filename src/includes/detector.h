@@ -0,0 +1,107 @@
+/**
+ * @file detector.h
+ * @brief Blade-action event detector on the raw gyro magnitude stream.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef DETECTOR_H
+#define DETECTOR_H
+
+#include "./hal.h"
+#include <stddef.h>
+
+/**
+ * An action starts when the magnitude reaches the onset threshold and
+ * ends when it falls below the (lower) offset threshold, so noise around
+ * a single threshold cannot chatter. The peak is reported once the signal
+ * has dropped 1/2^DETECT_PEAK_DROP_SHIFT below its running maximum. After
+ * an end, new onsets are ignored for the refractory window.
+ *
+ * Thresholds are in the units of accelerometer_calculate_magnitude()
+ * (°/s); timestamps are scheduler_millis() values and wrap at 65.5 s.
+ */
+
+#define DETECT_DEFAULT_ONSET       300   // °/s to start an action
+#define DETECT_DEFAULT_OFFSET      200   // °/s to end it (hysteresis)
+#define DETECT_DEFAULT_REFRACTORY  150   // ms of dead time after an end
+#define DETECT_PEAK_DROP_SHIFT     2     // Peak confirmed 25% below the max
+#define DETECT_QUEUE_SIZE          4     // Pending events (power of two)
+
+typedef enum
+{
+    DETECT_NONE  = 0x00,
+    DETECT_START = 0x01,  // Onset threshold crossed
+    DETECT_PEAK  = 0x02,  // Maximum of the action confirmed
+    DETECT_END   = 0x03   // Offset threshold crossed
+} detect_event_type_t;
+
+typedef struct
+{
+    detect_event_type_t type;
+    unsigned int timestamp_ms;  // START/END: crossing time, PEAK: time of the max
+    unsigned int value;         // START: magnitude, PEAK/END: peak magnitude
+    unsigned int duration_ms;   // END only: time since START
+} detect_event_t;
+
+typedef struct
+{
+    unsigned int onset;
+    unsigned int offset;
+    unsigned int refractory_ms;
+    unsigned char active;         // Inside an action
+    unsigned char peak_reported;
+    unsigned char in_refractory;
+    unsigned int peak;
+    unsigned int peak_ms;
+    unsigned int start_ms;
+    unsigned int end_ms;
+    detect_event_t queue[DETECT_QUEUE_SIZE];
+    unsigned char head;
+    unsigned char tail;
+    unsigned char dropped;        // Events lost to a full queue
+} detector_t;
+
+/**
+ * @brief Initialize a detector.
+ *
+ * @param det Pointer to detector_t state
+ * @param onset Magnitude that starts an action
+ * @param offset Magnitude that ends it; must be below onset
+ * @param refractory_ms Onsets ignored for this long after an end
+ * @return void
+ */
+void detector_init(detector_t* det, unsigned int onset, unsigned int offset,
+                   unsigned int refractory_ms);
+
+/**
+ * @brief Feed one magnitude sample.
+ *
+ * Call once per sensor sample, before any averaging, so events are
+ * raised on the sample that crosses the threshold.
+ *
+ * @param det Pointer to detector_t state
+ * @param magnitude Instantaneous magnitude
+ * @param now_ms Sample time from scheduler_millis()
+ * @return detect_event_type_t Last event raised by this sample, or DETECT_NONE
+ */
+detect_event_type_t detector_update(detector_t* det, unsigned int magnitude,
+                                    unsigned int now_ms);
+
+/**
+ * @brief Pop the oldest pending event.
+ *
+ * @param det Pointer to detector_t state
+ * @param event Pointer to store the event
+ * @return unsigned char 1 if an event was returned, 0 if none pending
+ */
+unsigned char detector_get_event(detector_t* det, detect_event_t* event);
+
+/**
+ * @brief Whether an action is in progress.
+ *
+ * @param det Pointer to detector_t state
+ * @return unsigned char 1 between START and END
+ */
+unsigned char detector_is_active(const detector_t* det);
+
+#endif  // DETECTOR_H
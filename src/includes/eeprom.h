@@ -0,0 +1,75 @@
+/**
+ * @file eeprom.h
+ * @brief Data EEPROM driver for the Micro-Fencing project (PIC18F45K22).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include "./hal.h"
+#include <stdint.h>
+
+#define EEPROM_SIZE 256  // Bytes of data EEPROM (EEADR only, no EEADRH)
+
+/**
+ * @brief Read one byte of data EEPROM.
+ *
+ * @param addr Byte address
+ * @return unsigned char Stored value (0xFF when erased)
+ */
+unsigned char eeprom_read(unsigned char addr);
+
+/**
+ * @brief Write one byte of data EEPROM.
+ *
+ * Skips the write when the byte already holds the value, to save time
+ * (~4 ms per write) and endurance. Interrupts are only masked for the
+ * unlock sequence; the wait for completion runs with them enabled.
+ *
+ * @param addr Byte address
+ * @param data Value to store
+ * @return unsigned char 1 if a write cycle was performed, 0 if unchanged
+ */
+unsigned char eeprom_write(unsigned char addr, unsigned char data);
+
+/**
+ * @brief Start writing one byte of data EEPROM without waiting for it.
+ *
+ * Skips unchanged bytes like eeprom_write(). Poll eeprom_busy() before
+ * the next read or write.
+ *
+ * @param addr Byte address
+ * @param data Value to store
+ * @return unsigned char 1 if a write cycle was started, 0 if unchanged
+ */
+unsigned char eeprom_write_start(unsigned char addr, unsigned char data);
+
+/**
+ * @brief Check whether a write cycle is still running.
+ *
+ * @return unsigned char 1 while WR is set, 0 once the EEPROM is idle
+ */
+unsigned char eeprom_busy(void);
+
+/**
+ * @brief Read a block of data EEPROM.
+ *
+ * @param addr Start address
+ * @param dst Destination buffer
+ * @param length Number of bytes
+ * @return void
+ */
+void eeprom_read_block(unsigned char addr, void* dst, unsigned char length);
+
+/**
+ * @brief Write a block of data EEPROM, skipping unchanged bytes.
+ *
+ * @param addr Start address
+ * @param src Source buffer
+ * @param length Number of bytes
+ * @return unsigned char 1 if every byte reads back correctly, 0 otherwise
+ */
+unsigned char eeprom_write_block(unsigned char addr, const void* src, unsigned char length);
+
+#endif  // EEPROM_H
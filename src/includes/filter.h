@@ -0,0 +1,168 @@
+/**
+ * @file filter.h
+ * @brief Fixed-point smoothing filters for the speed pipelines (boxcar, EMA, biquad).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "./hal.h"
+#include <stdint.h>
+#include "./accelerometer.h"
+
+/**
+ * Each pipeline owns a filter_t and picks one of the presets below, so
+ * smoothing can be traded against latency without touching the code
+ * that consumes the output.
+ *
+ * - Boxcar: the MOVING_AVG_SHIFT window from accelerometer.h.
+ * - EMA: y += alpha * (x - y), alpha in Q15, state kept in Q15 so the
+ *   output settles exactly on a constant input. One 16x16 multiply.
+ * - Biquad: 2nd-order Butterworth, direct form I, coefficients in Q14
+ *   (a0 = 1, |a1| < 2). The rounding error of each output is fed into
+ *   the next one, so low cutoffs keep their DC accuracy. Five 16x16
+ *   multiplies into a 32-bit sum.
+ *
+ * Inputs must stay within +-FILTER_INPUT_MAX so neither the EMA
+ * difference nor the biquad sum can overflow. EMA and biquad are primed
+ * with the first sample (low-pass at the input, high-pass at 0) instead
+ * of climbing from 0.
+ *
+ * Cutoffs are a fraction of the sample rate; figures below are for the
+ * default 200 Hz, measured on these kernels with their Q14/Q15 rounding.
+ * Delay is where a step response crosses 50%, noise the output RMS for
+ * unit white noise in, stopband the worst gain from 30 to 100 Hz.
+ *
+ *   Preset          -3 dB     Delay           Noise  Stopband
+ *   BOXCAR (8 tap)  11 Hz     3.5 / 17.5 ms   0.34   -13 dB
+ *   NONE            -         0               1.00   0 dB
+ *   EMA_FAST (1/2)  23 Hz     0.5 /  2.5 ms   0.57   -4 dB
+ *   EMA_SLOW (1/4)  9.5 Hz    1.9 /  9.5 ms   0.37   -10 dB
+ *   LOWPASS_FAST    25 Hz     1.8 /  9 ms     0.50   -5 dB
+ *   LOWPASS_SLOW    12.5 Hz   3.7 / 18 ms     0.36   -16 dB
+ *   HIGHPASS        1.0 Hz    a constant input settles to 0 in ~0.5 s
+ *
+ * The MPU-6050 DLPF (ACC_DEFAULT_DLPF, 4.8 ms) comes on top of these.
+ *
+ * Estimated cost per update on the PIC18 (XC8, 8x8 hardware multiply),
+ * 16 MHz / 4 MIPS: boxcar ~60 cycles, EMA ~80 cycles, biquad ~350 cycles
+ * (~90 us, under 2% of the 5 ms frame at 200 Hz).
+ */
+
+#define FILTER_EMA_Q         15     // Fraction bits of the EMA alpha
+#define FILTER_BIQUAD_Q      14     // Fraction bits of the biquad coefficients
+#define FILTER_INPUT_MAX     16383  // Largest input magnitude
+
+#define FILTER_Q15(x)        ((int16_t)((x) * 32768.0 + 0.5))  // Constant fraction to Q15 (x < 1)
+
+typedef enum
+{
+    FILTER_BOXCAR       = 0x00,  // 2^MOVING_AVG_SHIFT-tap moving average
+    FILTER_NONE         = 0x01,  // Raw input
+    FILTER_EMA_FAST     = 0x02,  // EMA, alpha 1/2
+    FILTER_EMA_SLOW     = 0x03,  // EMA, alpha 1/4
+    FILTER_LOWPASS_FAST = 0x04,  // Butterworth low-pass at fs/8
+    FILTER_LOWPASS_SLOW = 0x05,  // Butterworth low-pass at fs/16
+    FILTER_HIGHPASS     = 0x06,  // Butterworth high-pass at fs/200
+    FILTER_PRESET_COUNT = 0x07,
+    FILTER_CUSTOM       = 0xFF   // Set up by filter_init_ema() or filter_init_biquad()
+} filter_preset_t;
+
+#define FILTER_DEFAULT       FILTER_BOXCAR
+
+typedef struct
+{
+    int16_t b0;
+    int16_t b1;
+    int16_t b2;
+    int16_t a1;
+    int16_t a2;
+} filter_biquad_t;  // Q14, y = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2
+
+typedef struct
+{
+    unsigned char preset;                // filter_preset_t
+    unsigned char kind;                  // Kernel, private to filter.c
+    unsigned char primed;                // 0 until the first sample
+    int16_t alpha;                       // EMA alpha, Q15
+    const filter_biquad_t* coeffs;       // Biquad coefficients
+    int16_t output;
+    union
+    {
+        moving_avg_t boxcar;
+        int32_t ema;                     // Output in Q15
+        struct
+        {
+            int16_t x1, x2;              // Previous inputs
+            int16_t y1, y2;              // Previous outputs
+            int16_t error;               // Rounding carried to the next sum
+        } biquad;
+    } state;
+} filter_t;
+
+/**
+ * @brief Initialize a filter from a preset.
+ *
+ * @param filter Pointer to filter_t state
+ * @param preset filter_preset_t value below FILTER_PRESET_COUNT
+ * @return unsigned char 1 if accepted, 0 if out of range (FILTER_DEFAULT used)
+ */
+unsigned char filter_init(filter_t* filter, unsigned char preset);
+
+/**
+ * @brief Initialize a single-pole EMA with a custom weight.
+ *
+ * Delay is about (1 - alpha) / alpha samples.
+ *
+ * @param filter Pointer to filter_t state
+ * @param alpha_q15 Weight of the new sample, 1..32767 (FILTER_Q15(0.25) etc.)
+ * @return void
+ */
+void filter_init_ema(filter_t* filter, int16_t alpha_q15);
+
+/**
+ * @brief Initialize a biquad with custom coefficients.
+ *
+ * The coefficients are not copied and must outlive the filter.
+ *
+ * @param filter Pointer to filter_t state
+ * @param coeffs Q14 coefficients, a0 normalised to 1
+ * @return void
+ */
+void filter_init_biquad(filter_t* filter, const filter_biquad_t* coeffs);
+
+/**
+ * @brief Feed one sample.
+ *
+ * @param filter Pointer to filter_t state
+ * @param input Sample, within +-FILTER_INPUT_MAX
+ * @return int16_t Filtered output
+ */
+int16_t filter_update(filter_t* filter, int16_t input);
+
+/**
+ * @brief Last output of filter_update(), 0 before the first sample.
+ *
+ * @param filter Pointer to filter_t state
+ * @return int16_t Filtered output
+ */
+int16_t filter_get_output(const filter_t* filter);
+
+/**
+ * @brief Preset the filter was set up with.
+ *
+ * @param filter Pointer to filter_t state
+ * @return unsigned char filter_preset_t value, FILTER_CUSTOM for custom setups
+ */
+unsigned char filter_get_preset(const filter_t* filter);
+
+/**
+ * @brief Clear the history; the next sample primes the filter again.
+ *
+ * @param filter Pointer to filter_t state
+ * @return void
+ */
+void filter_reset(filter_t* filter);
+
+#endif  // FILTER_H
@@ -0,0 +1,58 @@
+/**
+ * @file hal.h
+ * @brief Hardware abstraction layer for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef HAL_H
+#define HAL_H
+
+/**
+ * Register access:
+ * - Target (XC8): <xc.h>; drivers touch the PIC18 SFRs directly
+ * - Host (gcc):   ../sim/sim_sfr.h maps the same SFR names (I2C, PWM,
+ *                 timer, GPIO, interrupt) onto the register file of the
+ *                 peripheral simulator, so the drivers compile unchanged
+ *
+ * Busy-wait loops on a status bit must use HAL_SPIN() as their body. It
+ * is empty on target; on the host it lets the simulator apply register
+ * side effects and advance simulated time while the firmware waits.
+ *
+ * Clock:
+ * - configure_osc() writes HAL_OSCCON; _XTAL_FREQ follows from its IRCF
+ *   field, so the two cannot disagree
+ * - Every clock-derived constant (timer periods, baud and I2C dividers,
+ *   the XC8 __delay_*() macros) is computed from _XTAL_FREQ
+ */
+
+#define HAL_OSCCON  0x7A   // IRCF = 111 (16 MHz HFINTOSC), SCS = 1x (internal block)
+
+#if (HAL_OSCCON & 0x02) == 0
+#error "HAL_OSCCON must select the internal oscillator block (SCS = 1x)"
+#endif
+
+#if ((HAL_OSCCON >> 4) & 0x07) == 0x07
+#define _XTAL_FREQ  16000000UL
+#elif ((HAL_OSCCON >> 4) & 0x07) == 0x06
+#define _XTAL_FREQ  8000000UL
+#elif ((HAL_OSCCON >> 4) & 0x07) == 0x05
+#define _XTAL_FREQ  4000000UL
+#else
+#error "HAL_OSCCON: IRCF below 4 MHz is too slow for 400 kHz I2C"
+#endif
+
+#if defined(__XC8) || defined(__XC)
+
+#include <xc.h>
+#define HAL_TARGET 1
+#define HAL_SPIN()
+
+#else
+
+#include "../sim/sim_sfr.h"
+#define HAL_HOST 1
+#define HAL_SPIN() sim_spin()
+
+#endif
+
+#endif // HAL_H
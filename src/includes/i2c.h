@@ -7,34 +7,199 @@
 #ifndef I2C_H
 #define I2C_H
 
-#include <xc.h>
+#include "./hal.h"
+#include <stddef.h>
+
+#define I2C_QUEUE_SIZE 16  // Async descriptor queue length (power of two)
+
+// Slave addresses are passed in 8-bit form (7-bit address << 1, R/W = 0),
+// e.g. 0xD0 for an MPU-6050 with AD0 low and 0xD2 with AD0 high.
+
+/**
+ * Timing bounds (Fosc = 16 MHz, 400 kHz bus):
+ * The longest legal phase is one byte plus ACK, 9 SCL periods = 90 Tcy.
+ * Every blocking wait gives up after I2C_TIMEOUT_POLLS polls of at least
+ * I2C_POLL_TCY cycles each, so a blocking call takes at most
+ * (phases x I2C_TIMEOUT_TCY) plus one bus recovery (~400 Tcy) whatever
+ * the bus does: 6 + 2N phases for an N-byte read, i.e. ~8.5 ms for the
+ * 14-byte motion burst, plus up to I2C_ASYNC_WAIT_POLLS waiting for the
+ * async engine to finish. The async engine itself is abandoned when it
+ * makes no progress for I2C_ASYNC_TIMEOUT_MS scheduler ticks.
+ */
+#define I2C_TIMEOUT_TCY        1000  // Per phase (250 us, ~11x the longest phase)
+#define I2C_POLL_TCY           8     // Minimum cycles per busy-wait pass
+#define I2C_TIMEOUT_POLLS      (I2C_TIMEOUT_TCY / I2C_POLL_TCY)
+#define I2C_ASYNC_WAIT_POLLS   (8 * I2C_TIMEOUT_POLLS)  // Blocking call waiting for the engine
+#define I2C_ASYNC_TIMEOUT_MS   2
+#define I2C_RECOVERY_CLOCKS    9     // SCL pulses to release a stuck slave
+#define I2C_RECOVERY_HALF_POLLS 4    // >= 5 us per SCL half period (<= 100 kHz)
+
+// SSP2 pins on the 40/44-pin PIC18F45K22, driven as GPIO during recovery
+#define I2C_SCL_TRIS   TRISDbits.TRISD0
+#define I2C_SCL_LAT    LATDbits.LATD0
+#define I2C_SDA_TRIS   TRISDbits.TRISD1
+#define I2C_SDA_LAT    LATDbits.LATD1
+#define I2C_SDA_PORT   PORTDbits.RD1
+
+typedef enum
+{
+    I2C_OK            = 0x00,  // Transaction completed
+    I2C_NACK          = 0x01,  // Slave did not acknowledge a byte
+    I2C_QUEUE_FULL    = 0x02,  // Not enough free descriptors to queue transaction
+    I2C_INVALID_PARAM = 0x03,  // Invalid parameter
+    I2C_TIMEOUT       = 0x04,  // A bus phase did not complete in time; bus recovered
+    I2C_BUS_ERROR     = 0x05   // Bus collision or write collision; bus recovered
+} i2c_status_t;
+
+typedef enum
+{
+    I2C_OP_START   = 0x00,  // Start condition
+    I2C_OP_RESTART = 0x01,  // Repeated start condition
+    I2C_OP_WRITE   = 0x02,  // Transmit one byte (address, register or data)
+    I2C_OP_READ    = 0x03,  // Receive N bytes, ACK all but the last
+    I2C_OP_STOP    = 0x04   // Stop condition, completes the transaction
+} i2c_op_type_t;
+
+/**
+ * @brief Completion callback for asynchronous transactions.
+ * @param status I2C_OK, I2C_NACK if any byte was not acknowledged, or
+ *               I2C_TIMEOUT if the engine stalled and was reset.
+ * @param context Pointer given when the transaction was queued.
+ * Note: Called from interrupt context; keep it short.
+ */
+typedef void (*i2c_callback_t)(i2c_status_t status, void* context);
+
+typedef struct
+{
+    unsigned char type;       // i2c_op_type_t
+    unsigned char data;       // Byte to transmit (I2C_OP_WRITE)
+    unsigned char length;     // Number of bytes to receive (I2C_OP_READ)
+    unsigned char* buffer;    // Receive destination (I2C_OP_READ)
+    i2c_callback_t callback;  // Completion callback (I2C_OP_STOP, may be NULL)
+    void* context;            // Passed to the callback (I2C_OP_STOP)
+} i2c_op_t;
 
 /**
  * @brief Write a byte to a specific register of an I2C slave device.
+ * 
+ * A NACK ends the transaction with a STOP; a timeout or collision also
+ * runs i2c_bus_recover().
+ * 
+ * @param address The slave address (8-bit form).
  * @param reg The register address to write to.
  * @param data The byte to write.
- * @return void
- * Note: Slave address is hardcoded as 0xD0 for MPU6050 with AD0 low.
+ * @return i2c_status_t I2C_OK, I2C_NACK, I2C_TIMEOUT or I2C_BUS_ERROR
  */
-void i2c_single_write(unsigned char reg, unsigned char data);
+i2c_status_t i2c_single_write(unsigned char address, unsigned char reg, unsigned char data);
 
 /**
  * @brief Read a byte from a specific register of an I2C slave device.
+ * @param address The slave address (8-bit form).
  * @param reg The register address to read from.
- * @return The byte read from the specified register.
- * Note: Slave address is hardcoded as 0xD0 for MPU6050 with AD0 low.
+ * @param data Pointer to store the byte; unchanged unless I2C_OK.
+ * @return i2c_status_t I2C_OK, I2C_NACK, I2C_TIMEOUT or I2C_BUS_ERROR
  */
-unsigned char i2c_single_read(unsigned char reg);
+i2c_status_t i2c_single_read(unsigned char address, unsigned char reg, unsigned char* data);
 
 
 // See pages 35-36 of MPU6050 Datasheet
 /**
  * @brief Read multiple bytes from consecutive registers of an I2C slave device.
+ * @param address The slave address (8-bit form).
  * @param reg The starting register address to read from.
  * @param buffer Pointer to the buffer to store the read bytes.
- * @param length The number of bytes to read.
+ * @param length The number of bytes to read (1-255).
+ * @return i2c_status_t I2C_OK, I2C_NACK, I2C_TIMEOUT, I2C_BUS_ERROR or
+ *         I2C_INVALID_PARAM; the buffer is only complete on I2C_OK
+ */
+i2c_status_t i2c_bulk_read(unsigned char address, unsigned char reg,
+                           unsigned char* buffer, unsigned char length);
+
+/**
+ * @brief Free a bus held low by a slave and re-initialise SSP2.
+ * 
+ * Disables SSP2, clocks SCL up to nine times until the slave releases
+ * SDA, generates a STOP by hand and re-enables SSP2 as I2C master.
+ * Called automatically after a timeout or bus collision.
+ * 
+ * @return i2c_status_t I2C_OK if SDA is high afterwards, else I2C_BUS_ERROR
+ */
+i2c_status_t i2c_bus_recover(void);
+
+/**
+ * @brief Number of bus recoveries since reset.
+ * @return unsigned int Recovery count (wraps at 65535)
+ */
+unsigned int i2c_get_recoveries(void);
+
+/**
+ * @brief Initialize the interrupt-driven transaction engine.
+ * 
+ * Clears the descriptor queue and enables the SSP2 interrupt. SSP2 must
+ * already be configured as I2C master and peripheral interrupts enabled.
+ * 
+ * @return void
+ */
+void i2c_async_init(void);
+
+/**
+ * @brief Queue a register read without blocking.
+ * 
+ * Queues start, address (W), register, restart, address (R), read-N and
+ * stop descriptors. The bus is driven from i2c_isr() and the callback is
+ * invoked once the stop condition has completed. Transactions for
+ * different slaves queue back to back, so two 14-byte reads fit in the
+ * queue at once.
+ * 
+ * @param address The slave address (8-bit form).
+ * @param reg The starting register address to read from.
+ * @param buffer Destination buffer; must stay valid until completion.
+ * @param length The number of bytes to read (1-255).
+ * @param callback Completion callback (may be NULL).
+ * @param context Passed to the callback.
+ * @return i2c_status_t I2C_OK if queued, I2C_QUEUE_FULL or I2C_INVALID_PARAM
+ */
+i2c_status_t i2c_async_read(unsigned char address, unsigned char reg,
+                            unsigned char* buffer, unsigned char length,
+                            i2c_callback_t callback, void* context);
+
+/**
+ * @brief Queue a single register write without blocking.
+ * @param address The slave address (8-bit form).
+ * @param reg The register address to write to.
+ * @param data The byte to write.
+ * @param callback Completion callback (may be NULL).
+ * @param context Passed to the callback.
+ * @return i2c_status_t I2C_OK if queued, or I2C_QUEUE_FULL
+ */
+i2c_status_t i2c_async_write(unsigned char address, unsigned char reg, unsigned char data,
+                             i2c_callback_t callback, void* context);
+
+/**
+ * @brief Check whether the asynchronous engine is still driving the bus.
+ * @return unsigned char 1 while descriptors are pending, 0 when idle.
+ */
+unsigned char i2c_async_busy(void);
+
+/**
+ * @brief Stall watchdog for the async engine; call once per 1 ms tick.
+ * 
+ * If queued transactions make no progress for I2C_ASYNC_TIMEOUT_MS ticks
+ * (SCL held low, or a collision that never raises SSP2IF) every pending
+ * callback gets I2C_TIMEOUT, the queue is cleared and the bus recovered.
+ * Runs from the interrupt service routine.
+ * 
+ * @return void
+ */
+void i2c_tick(void);
+
+/**
+ * @brief SSP2 interrupt handler; advances the transaction state machine.
+ * 
+ * Must be called from the interrupt service routine. Returns immediately
+ * if SSP2IF is not set.
+ * 
  * @return void
- * Note: Slave address is hardcoded as 0xD0 for MPU6050 with AD0 low.
  */
-void i2c_bulk_read(unsigned char reg, unsigned char* buffer, unsigned char length);
+void i2c_isr(void);
 #endif // I2C_H
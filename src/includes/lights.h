@@ -7,7 +7,8 @@
 #ifndef LIGHTS_H
 #define LIGHTS_H
 
-#include <xc.h>
+#include "./hal.h"
+#include <stddef.h>
 
 /**
  * PWM Channels:
@@ -15,26 +16,74 @@
  * - Green: CCP2 on RB3 (PWM2) - configured via CCP2MX = PORTB3
  * - Blue:  CCP3 on RB5 (PWM3) - configured via CCP3MX = PORTB5
  * 
- * Timer2 is used as the PWM time base for all CCP modules
- * Frequency: 1 kHz (adjustable via PR2 and Timer2 prescaler)
- * Resolution: 8-bit PWM (0-255 duty cycle)
+ * Timer2 is used as the PWM time base for all CCP modules. The prescaler
+ * and PR2 are derived from _XTAL_FREQ and LIGHTS_PWM_HZ at compile
+ * time; the default 15.625 kHz gives PR2 = 255 at 1:1, which is both well
+ * above visible flicker and the full 10-bit duty range (CCPRxL:DCxB).
+ * 
+ * Animation engine: lights_isr() runs on every postscaled Timer2 match
+ * (~1 kHz) and renders a frame every LIGHTS_FRAME_MATCHES matches (about
+ * 244 Hz, 4.1 ms), independent of the main loop. Each frame is
+ * - the base layer: a static colour, or keyframes faded linearly with a
+ *   16-bit fixed-point phase (fades, breathing pulses, looping sequences)
+ * - optionally covered by a flash overlay that holds a colour and then
+ *   dissolves back into the base layer
+ * The ISR writes the previous frame's duties first, and only while TMR2
+ * shows enough of the current PWM period left for all six writes (a late
+ * pass leaves them for the next match), so all three channels (and the
+ * two halves of each 10-bit duty) are latched at the same period
+ * boundary; then it renders the next frame. Timing is converted to frames when an effect is started, so
+ * the ISR only adds and multiplies.
  */
 
+#define LIGHTS_PWM_HZ        15625UL   // PWM frequency
+#define LIGHTS_T2_OUTPS      16        // Timer2 periods per TMR2IF (1-16)
+#define LIGHTS_FRAME_MATCHES 4         // TMR2IF matches per animation frame
+#define LIGHTS_DUTY_MAX      1023      // Full scale of the 10-bit colour API
+#define LIGHTS_MAX_KEYFRAMES 8         // Longest sequence lights_play() accepts
+
+typedef struct
+{
+    unsigned int r;          // Red duty (0-LIGHTS_DUTY_MAX)
+    unsigned int g;          // Green duty
+    unsigned int b;          // Blue duty
+    unsigned int fade_ms;    // Linear fade from the previous colour (0 = jump)
+} lights_keyframe_t;
+
 /**
  * @brief Initialize PWM modules for RGB LED control.
  * 
  * Configures:
- * - Timer2 as PWM time base (1 kHz, 8-bit resolution)
+ * - Timer2 as PWM time base (LIGHTS_PWM_HZ, 10-bit resolution)
  * - CCP1 (Red) on RC2
  * - CCP2 (Green) on RB3
  * - CCP3 (Blue) on RB5
  * 
+ * The LED starts off. Peripheral interrupts must be enabled separately
+ * (configure_interrupts) for colours and animations to be shown.
+ * 
  * @return void
  */
 void lights_init(void);
 
 /**
- * @brief Set the RGB LED color using PWM duty cycles.
+ * @brief Set a static RGB LED color using 10-bit PWM duty cycles.
+ * 
+ * Stops any running fade or sequence; a flash overlay keeps running on
+ * top. Values are scaled to the Timer2 period, so LIGHTS_DUTY_MAX is
+ * always fully on. Shown from the next animation frame.
+ * 
+ * @param r Red component (0-1023, where 0=off, 1023=full brightness)
+ * @param g Green component (0-1023)
+ * @param b Blue component (0-1023)
+ * @return void
+ */
+void lights_set_color10(unsigned int r, unsigned int g, unsigned int b);
+
+/**
+ * @brief Set a static RGB LED color using 8-bit PWM duty cycles.
+ * 
+ * Expands each component to 10 bits and calls lights_set_color10().
  * 
  * @param r Red component (0-255, where 0=off, 255=full brightness)
  * @param g Green component (0-255)
@@ -43,13 +92,81 @@ void lights_init(void);
  */
 void lights_set_color(unsigned char r, unsigned char g, unsigned char b);
 
+/**
+ * @brief Fade the base layer from its current colour to a new one.
+ * 
+ * Replaces any running fade or sequence, starting from wherever it was.
+ * 
+ * @param r Red target (0-1023)
+ * @param g Green target (0-1023)
+ * @param b Blue target (0-1023)
+ * @param fade_ms Fade time; 0 jumps on the next frame
+ * @return void
+ */
+void lights_fade_to(unsigned int r, unsigned int g, unsigned int b,
+                    unsigned int fade_ms);
+
+/**
+ * @brief Run a keyframe sequence on the base layer.
+ * 
+ * The first keyframe fades from the current colour. A looping sequence
+ * fades from the last keyframe back to the first; otherwise the last
+ * colour is held. The keyframes are copied, so the array may be
+ * temporary.
+ * 
+ * @param keys Keyframes
+ * @param count Number of keyframes (1-LIGHTS_MAX_KEYFRAMES)
+ * @param loop Nonzero to repeat until another colour is set
+ * @return unsigned char 1 if started, 0 for a NULL or oversized sequence
+ */
+unsigned char lights_play(const lights_keyframe_t* keys, unsigned char count,
+                          unsigned char loop);
+
+/**
+ * @brief Breathe the base layer between a colour and off.
+ * 
+ * @param r Red peak (0-1023)
+ * @param g Green peak (0-1023)
+ * @param b Blue peak (0-1023)
+ * @param period_ms One full rise and fall
+ * @return void
+ */
+void lights_pulse(unsigned int r, unsigned int g, unsigned int b,
+                  unsigned int period_ms);
+
+/**
+ * @brief Flash a colour over the base layer.
+ * 
+ * Shows the colour for hold_ms, then dissolves into whatever the base
+ * layer is doing over fade_ms. A new flash replaces the current one.
+ * 
+ * @param r Red flash colour (0-1023)
+ * @param g Green flash colour (0-1023)
+ * @param b Blue flash colour (0-1023)
+ * @param hold_ms Time at full flash colour
+ * @param fade_ms Dissolve time back to the base layer
+ * @return void
+ */
+void lights_flash(unsigned int r, unsigned int g, unsigned int b,
+                  unsigned int hold_ms, unsigned int fade_ms);
+
 /**
  * @brief Turn off all RGB LEDs.
  * 
- * Sets all PWM duty cycles to 0.
+ * Stops animations and any flash, and sets all PWM duty cycles to 0.
  * 
  * @return void
  */
 void lights_off(void);
 
+/**
+ * @brief Interrupt handler; writes the last frame and renders the next.
+ * 
+ * Call from the main ISR. Acts on TMR2IF (~1 kHz); rendering runs every
+ * LIGHTS_FRAME_MATCHES matches.
+ * 
+ * @return void
+ */
+void lights_isr(void);
+
 #endif // LIGHTS_H
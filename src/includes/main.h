@@ -7,13 +7,37 @@
 #ifndef MAIN_H
 #define MAIN_H
 
-#include <xc.h>
+#include "./hal.h"
 #include "./accelerometer.h"
 #include "./button.h"
+#include "./melody.h"
 #include "./lights.h"
 #include "./i2c.h"
+#include "./scheduler.h"
+#include "./orientation.h"
+#include "./detector.h"
+#include "./filter.h"
+#include "./config.h"
+#include "./uart.h"
+#include "./telemetry.h"
 
-// Oscillator: HS oscillator at medium power (16 MHz)
+// Task periods / offsets (ms); offsets stagger tasks across ticks
+#define FILTER_TASK_MS     1    // Drain the sample queues: magnitude, smoothing, orientation
+#define SAMPLE_BATCH       4    // Samples copied out of a queue at a time
+#define LED_TASK_MS        20   // LED colour update (50 Hz)
+#define ERROR_BLINK_MS     250  // RA0 blink period when the sensor is missing
+#define COMMAND_TASK_MS    20   // Host command polling
+#define BUTTON_TASK_MS     10   // Button gesture handling
+#define CONFIG_TASK_MS     5    // Deferred EEPROM save: one byte write (~4 ms) per release
+
+#define I2C_CLOCK_HZ       400000UL  // SSP2 SCL rate (MPU-6050 fast mode)
+
+// LED effects (ms)
+#define HIT_FLASH_HOLD_MS  100  // White flash at the start of an action
+#define HIT_FLASH_FADE_MS  250  // Dissolve back to the speed colour
+
+#ifdef HAL_TARGET
+// Oscillator: internal block, RA6/RA7 as I/O; frequency set by HAL_OSCCON
 #pragma config     FOSC = INTIO67
 #pragma config   PLLCFG = OFF
 #pragma config PRICLKEN = ON
@@ -37,28 +61,35 @@
 // Optional but recommended: Stack protection, Watchdog OFF
 #pragma config STVREN = ON      // Stack overflow reset
 #pragma config  WDTEN = OFF      // Watchdog timer disabled
+#endif // HAL_TARGET
 
 // Add JavaDoc
 void configure_osc(void);
 
 /**
- * @brief Configure PORTA and PORTB for I/O operations.
+ * @brief Configure PORTA to PORTD for I/O operations (PIC18F45K22, 40/44-pin).
  * 
  * PORTA Configuration:
  * - RA0: Output for error indicator LED
- * - RA1-RA7: Inputs (unused)
+ * - RA4: Output for the speaker
+ * - Other PORTA pins: Inputs (unused)
  * 
  * PORTB Configuration:
- * - RB2, RB3: SSP2 I2C (SCL2, SDA2)
- * - RB3: Also used as CCP2 PWM output (Green LED) when not I2C
+ * - RB0: Button input (INT0, internal pull-up)
+ * - RB1: Guard MPU-6050 INT input (INT1, data ready)
+ * - RB2: Wrist MPU-6050 INT input (INT2, data ready; optional)
+ * - RB3: PWM Green output (CCP2)
  * - RB5: PWM Blue output (CCP3)
  * - Other PORTB pins: Inputs (unused)
  * 
  * PORTC Configuration:
  * - RC2: PWM Red output (CCP1 - hardwired, no config option)
+ * - RC6, RC7: EUSART1 TX1/RX1 (telemetry; set up by uart_init())
  * 
- * Note: This is a hardware constraint - RB3 serves dual purpose but SSP2
- * takes priority for I2C communication. For PWM-only operation, use RC2/RB5.
+ * PORTD Configuration:
+ * - RD0, RD1: SSP2 I2C (SCL2, SDA2); digital inputs, the MSSP drives
+ *   them (external pull-ups)
+ * - Other PORTD pins: Inputs (unused)
  * 
  * @return void
  */
@@ -68,13 +99,23 @@ void configure_ports(void);
  * @brief Configure SSP2 module for I2C Master mode.
  * 
  * Configuration:
- * - I2C Master mode (400 kHz clock)
- * - Fosc = 16 MHz
- * - SSP2ADD = 9 (for 400 kHz: Fosc / (4 * (SSP2ADD + 1)))
+ * - I2C Master mode (I2C_CLOCK_HZ), SCL2 on RD0 and SDA2 on RD1
+ * - SSP2ADD = _XTAL_FREQ / (4 * I2C_CLOCK_HZ) - 1 (9 at 16 MHz, 400 kHz)
  * - Slew rate disabled for 400 kHz operation
  * 
  * @return void
  */
 void configure_ssp2_i2c(void);
 
+/**
+ * @brief Enable interrupts for the peripheral drivers.
+ * 
+ * Uses legacy (single priority) mode: every source vectors to isr(),
+ * which dispatches to the driver handlers. Individual peripheral enable
+ * bits are set by the drivers' own init functions.
+ * 
+ * @return void
+ */
+void configure_interrupts(void);
+
 #endif // MAIN_H
\ No newline at end of file
@@ -0,0 +1,135 @@
+#ifndef MELODY_H
+#define MELODY_H
+
+/**
+ * @file melody.h
+ * @brief Header for melody.c — interrupt-driven PWM melody sequencer for Micro-Fencing project.
+ */
+
+#include "./hal.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* ---------------------------------------------------------------------
+ * Configuration Macros
+ * ------------------------------------------------------------------ */
+
+// Timer4 clock: Fosc / 4 / prescale. PR4 for each note is derived from
+// its frequency at compile time, so changing these retunes every melody.
+#define MELODY_PRESCALE    16          // Timer4 prescaler: 1, 4 or 16
+#define MELODY_TIMER_HZ    (_XTAL_FREQ / 4UL / MELODY_PRESCALE)
+
+// PR4 for a frequency in 0.1 Hz units (tone = MELODY_TIMER_HZ / (PR4 + 1))
+#define MELODY_PR4(dhz)    ((MELODY_TIMER_HZ * 10UL + (dhz) / 2UL) / (dhz) - 1UL)
+
+// Pause after each note, in tempo units.
+#define MELODY_GAP_UNITS 1
+
+/* ---------------------------------------------------------------------
+ * Notes
+ * ------------------------------------------------------------------ */
+
+// Equal-tempered frequencies (A4 = 440 Hz) in 0.1 Hz. At 16 MHz and 1:16
+// Timer4 bottoms out at 977 Hz, so the scale starts at C6; piezo
+// buzzers are loudest up here anyway.
+#define NOTE_DHZ_C6    10465UL
+#define NOTE_DHZ_CS6   11087UL
+#define NOTE_DHZ_D6    11747UL
+#define NOTE_DHZ_DS6   12445UL
+#define NOTE_DHZ_E6    13185UL
+#define NOTE_DHZ_F6    13969UL
+#define NOTE_DHZ_FS6   14800UL
+#define NOTE_DHZ_G6    15680UL
+#define NOTE_DHZ_GS6   16612UL
+#define NOTE_DHZ_A6    17600UL
+#define NOTE_DHZ_AS6   18647UL
+#define NOTE_DHZ_B6    19755UL
+#define NOTE_DHZ_C7    20930UL
+#define NOTE_DHZ_CS7   22175UL
+#define NOTE_DHZ_D7    23493UL
+#define NOTE_DHZ_DS7   24890UL
+#define NOTE_DHZ_E7    26370UL
+#define NOTE_DHZ_F7    27938UL
+#define NOTE_DHZ_FS7   29600UL
+#define NOTE_DHZ_G7    31360UL
+#define NOTE_DHZ_GS7   33224UL
+#define NOTE_DHZ_A7    35200UL
+#define NOTE_DHZ_AS7   37293UL
+#define NOTE_DHZ_B7    39511UL
+#define NOTE_DHZ_C8    41860UL
+
+#if MELODY_PR4(NOTE_DHZ_C6) > 255UL
+#error "Timer4 is too fast for C6; use a larger MELODY_PRESCALE"
+#endif
+#if MELODY_PR4(NOTE_DHZ_C8) < 32UL
+#error "Timer4 is too slow to tune C8; use a smaller MELODY_PRESCALE"
+#endif
+
+// Note numbers for MELODY_EVENT(); index the PR4 table in melody.c
+typedef enum {
+    NOTE_REST = 0,
+    NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6,
+    NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
+    NOTE_C7, NOTE_CS7, NOTE_D7, NOTE_DS7, NOTE_E7, NOTE_F7,
+    NOTE_FS7, NOTE_G7, NOTE_GS7, NOTE_A7, NOTE_AS7, NOTE_B7,
+    NOTE_C8,
+    NOTE_COUNT              // At most 32 (5 bits)
+} note_t;
+
+// Note lengths in tempo units, as 3-bit codes
+typedef enum {
+    LEN_1 = 0, LEN_2, LEN_3, LEN_4, LEN_6, LEN_8, LEN_12, LEN_16
+} note_len_t;
+
+// One packed melody byte: note number in bits 7:3, length code in 2:0
+#define MELODY_EVENT(note, len)  ((uint8_t)(((note) << 3) | (len)))
+#define MELODY_EVENT_NOTE(ev)    ((uint8_t)((ev) >> 3))
+#define MELODY_EVENT_LEN(ev)     ((uint8_t)((ev) & 0x07))
+
+/* ---------------------------------------------------------------------
+ * Melody Data
+ * ------------------------------------------------------------------ */
+
+typedef enum {
+    MELODY_BUTTON = 0,   // Played on a button press
+    MELODY_ACTION,       // Short cue at the start of a blade action
+    MELODY_START,        // Power-up, once the sensors are running
+    MELODY_TOUCH,        // Scored touch
+    MELODY_ERROR,        // Sensor fault
+    MELODY_LOW_BATTERY,  // Supply running low
+    MELODY_COUNT
+} melody_id_t;
+
+// const: melodies and their events stay in program memory on XC8
+typedef struct {
+    const uint8_t *events;     // MELODY_EVENT() bytes
+    uint8_t length;            // Number of events
+    uint8_t unit_ms;           // Tempo: milliseconds per length unit
+} melody_t;
+
+/* ---------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------ */
+
+// Configure CCP5 as PWM on the Timer4 timebase (tone off).
+void melody_init(void);
+
+void pwm_start(void);
+void pwm_stop(void);
+
+// Start a melody from its first note; returns immediately. A melody
+// already playing is replaced. Returns false for an unknown id.
+bool melody_play(melody_id_t id);
+
+// Silence the buzzer and abandon the current melody.
+void melody_stop(void);
+
+// True while a melody (including its final gap) is in progress.
+bool melody_is_playing(void);
+
+// 1 ms tick from the ISR: counts down the current note/gap and loads
+// the next note into PR4/CCPR5L when it runs out.
+void melody_tick(void);
+
+#endif /* MELODY_H */
@@ -0,0 +1,105 @@
+/**
+ * @file orientation.h
+ * @brief Fixed-point complementary filter for blade attitude (roll/pitch/yaw).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+#include "./hal.h"
+#include <stdint.h>
+#include "./accelerometer.h"
+
+/**
+ * Angles are Q16.16 degrees (1.0 deg = 65536).
+ *
+ * Each update integrates the gyro rates, then pulls roll and pitch toward
+ * the tilt implied by the accelerometer by 1/2^ORIENT_ACC_SHIFT of the
+ * error. The accel correction is skipped while |a| is outside
+ * 0.75 g..1.25 g (lunges, hits), so the gyro carries the estimate through
+ * fast actions. Yaw has no absolute reference and drifts with gyro bias.
+ *
+ * Estimated cost per update on the PIC18 (XC8, 8x8 hardware multiply,
+ * software divide), 16 MHz / 4 MIPS:
+ * - Gyro integration, 3 x 16x16 multiply + wrap:  ~250 cycles
+ * - |a|^2 gate, 3 x 16x16 square:                 ~150 cycles
+ * - isqrt(ay^2 + az^2), 16 shift/subtract steps:  ~650 cycles
+ * - 2 x atan2, one 32-bit divide each:           ~1400 cycles
+ * - Blend and wrap:                               ~100 cycles
+ * Total ~2550 cycles (~640 us) with the accel correction, ~250 cycles
+ * (~65 us) without it; 13% of the 5 ms frame at 200 Hz. Raising
+ * ORIENT_ACC_DECIMATE runs the correction on every Nth sample only.
+ */
+
+#ifndef ORIENT_ACC_SHIFT
+#define ORIENT_ACC_SHIFT     5   // Accel weight 1/32 per update (~160 ms at 200 Hz)
+#endif
+#ifndef ORIENT_ACC_DECIMATE
+#define ORIENT_ACC_DECIMATE  1   // Apply the accel correction every N updates
+#endif
+
+#define ORIENT_DEG(d)        ((int32_t)(d) << 16)  // Whole degrees to Q16.16
+
+// Accept the accel correction for 0.75 g < |a| < 1.25 g (compared squared)
+#define ORIENT_ACC_MIN_SQ    ((uint32_t)ACCEL_SENSITIVITY * ACCEL_SENSITIVITY / 16 * 9)
+#define ORIENT_ACC_MAX_SQ    ((uint32_t)ACCEL_SENSITIVITY * ACCEL_SENSITIVITY / 16 * 25)
+
+typedef struct
+{
+    int32_t roll;              // Rotation about X, Q16.16 degrees, -180..180
+    int32_t pitch;             // Rotation about Y, Q16.16 degrees, -90..90
+    int32_t yaw;               // Rotation about Z, Q16.16 degrees, gyro only
+    uint16_t gyro_step_q8;     // Q16 degrees per gyro count per sample, Q8 (saturates below ~60 Hz at ±2000°/s)
+    unsigned char decimate;    // Updates until the next accel correction
+    unsigned char accel_used;  // 1 if the last update applied the correction
+    unsigned char initialized; // 0 until the first accel fix sets roll/pitch
+} orientation_t;
+
+/**
+ * @brief Initialize the orientation filter for a given sample rate.
+ *
+ * Precomputes the per-sample gyro step so the update has no division
+ * for integration. Angles start at zero and snap to the accelerometer
+ * tilt on the first valid sample.
+ *
+ * @param orient Pointer to orientation_t state
+ * @param sample_rate_hz Rate at which orientation_update() will be called
+ * @param gyro_fs_sel Gyro range of the samples (accelerometer_get_gyro_range())
+ * @return void
+ */
+void orientation_init(orientation_t* orient, unsigned int sample_rate_hz,
+                      unsigned char gyro_fs_sel);
+
+/**
+ * @brief Follow a change of sample rate or gyro range, keeping the attitude.
+ *
+ * @param orient Pointer to orientation_t state
+ * @param sample_rate_hz New rate of orientation_update() calls
+ * @param gyro_fs_sel New gyro range (ACC_GYRO_FS_x)
+ * @return void
+ */
+void orientation_set_rate(orientation_t* orient, unsigned int sample_rate_hz,
+                          unsigned char gyro_fs_sel);
+
+/**
+ * @brief Advance the filter by one 6-axis sample.
+ *
+ * @param orient Pointer to orientation_t state
+ * @param motion Accel/gyro sample from accelerometer_get_motion_sample()
+ * @return void
+ */
+void orientation_update(orientation_t* orient, const motion_sample_t* motion);
+
+/**
+ * @brief Fixed-point atan2 in degrees.
+ *
+ * Octant reduction plus a first-order rational fit; max error ~0.25°.
+ *
+ * @param y Numerator component
+ * @param x Denominator component
+ * @return int32_t Angle in Q16.16 degrees, -180..180
+ */
+int32_t orientation_atan2(int32_t y, int32_t x);
+
+#endif  // ORIENTATION_H
@@ -0,0 +1,109 @@
+/**
+ * @file scheduler.h
+ * @brief Timer-tick cooperative task scheduler for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "./hal.h"
+#include <stddef.h>
+
+/**
+ * Time Base:
+ * - Timer6, prescaler 1:16 (Fosc/4/16 = 250 kHz), PR6 = 249
+ * - The period match resets TMR6 in hardware -> exact 1 ms tick, however
+ *   late the interrupt is serviced (no reload, no lost prescaler counts)
+ * - TMR6IF is a peripheral interrupt (PIR5): PEIE must be set
+ * - Tick counter is 16-bit and wraps every 65.5 s; all comparisons are
+ *   done on differences so the wrap is harmless
+ *
+ * Tasks are plain functions that run to completion. They are released
+ * every period_ms and must finish within deadline_ms of their release;
+ * a late finish or a skipped release increments the task's overrun count.
+ * Between ticks the CPU idles (IDLEN = 1, SLEEP) with peripherals running.
+ */
+
+#define SCHEDULER_MAX_TASKS  8     // Fixed task table size
+#define SCHEDULER_TICK_HZ    1000  // Tick rate (1 ms)
+#define SCHEDULER_NO_TASK    0xFF  // Returned when a task cannot be added
+
+#define SCHEDULER_T6_PRESCALE 16
+#define SCHEDULER_PR6         (_XTAL_FREQ / 4UL / SCHEDULER_T6_PRESCALE / SCHEDULER_TICK_HZ - 1UL)
+
+#if SCHEDULER_PR6 > 255
+#error "SCHEDULER_PR6 does not fit Timer6; raise SCHEDULER_T6_PRESCALE"
+#endif
+
+typedef void (*task_fn_t)(void);
+
+typedef struct
+{
+    task_fn_t function;       // Task body
+    unsigned int period_ms;   // Release period
+    unsigned int deadline_ms; // Relative deadline (<= period)
+    unsigned int release;     // Tick of the next release
+    unsigned int overruns;    // Missed deadlines and skipped releases
+} task_t;
+
+/**
+ * @brief Initialize the task table and start the Timer6 1 ms tick.
+ * 
+ * @return void
+ */
+void scheduler_init(void);
+
+/**
+ * @brief Register a periodic task.
+ * 
+ * @param function Task body, run to completion from scheduler_dispatch()
+ * @param period_ms Release period in ms (>= 1)
+ * @param offset_ms Delay before the first release, used to stagger tasks
+ * @param deadline_ms Relative deadline in ms (0 means deadline = period)
+ * @return unsigned char Task id, or SCHEDULER_NO_TASK if the table is full
+ *         or a parameter is invalid
+ */
+unsigned char scheduler_add_task(task_fn_t function, unsigned int period_ms,
+                                 unsigned int offset_ms, unsigned int deadline_ms);
+
+/**
+ * @brief Run every due task once, then idle until the next interrupt.
+ * 
+ * @return void
+ */
+void scheduler_dispatch(void);
+
+/**
+ * @brief Dispatch tasks forever.
+ * 
+ * @return void (never returns)
+ */
+void scheduler_run(void);
+
+/**
+ * @brief Milliseconds since scheduler_init() (wraps at 65535).
+ * 
+ * @return unsigned int Current tick count
+ */
+unsigned int scheduler_millis(void);
+
+/**
+ * @brief Number of missed deadlines / skipped releases for a task.
+ * 
+ * @param id Task id returned by scheduler_add_task()
+ * @return unsigned int Overrun count (0 for an invalid id)
+ */
+unsigned int scheduler_get_overruns(unsigned char id);
+
+/**
+ * @brief Timer6 interrupt handler; advances the tick.
+ * 
+ * Must be called from the interrupt service routine.
+ * 
+ * @return unsigned char 1 if a tick elapsed, 0 if TMR6IF was not set
+ *         or TMR6IE is off
+ */
+unsigned char scheduler_tick_isr(void);
+
+#endif // SCHEDULER_H
@@ -0,0 +1,93 @@
+/**
+ * @file telemetry.h
+ * @brief Framed binary telemetry over the EUSART for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "./hal.h"
+#include <stdint.h>
+#include "./telemetry_frames.h"
+#include "./uart.h"
+#include "./crc.h"
+#include "./accelerometer.h"
+#include "./detector.h"
+
+#ifndef TLM_DEFAULT_MODE
+#define TLM_DEFAULT_MODE TLM_MODE_DELTA
+#endif
+
+/**
+ * @brief Reset the stream state and select a mode.
+ *
+ * uart_init() must have been called.
+ *
+ * @param mode TLM_MODE_OFF, TLM_MODE_FULL or TLM_MODE_DELTA
+ * @return void
+ */
+void telemetry_init(unsigned char mode);
+
+/**
+ * @brief Change the stream mode; the next sample is sent as a keyframe.
+ *
+ * @param mode TLM_MODE_OFF, TLM_MODE_FULL or TLM_MODE_DELTA
+ * @return void
+ */
+void telemetry_set_mode(unsigned char mode);
+
+/**
+ * @brief Get the current stream mode.
+ *
+ * @return unsigned char TLM_MODE_*
+ */
+unsigned char telemetry_get_mode(void);
+
+/**
+ * @brief Stream one processed sample.
+ *
+ * Never blocks: a frame that does not fit in the TX ring is dropped and
+ * the next sample of every sensor is forced to a keyframe.
+ *
+ * @param sensor TLM_SENSOR_GUARD or TLM_SENSOR_WRIST
+ * @param motion Accel/gyro sample
+ * @param magnitude Instantaneous magnitude (°/s)
+ * @param average Moving average of the magnitude (°/s)
+ * @param timestamp_ms scheduler_millis() at the sample
+ * @return void
+ */
+void telemetry_send_sample(unsigned char sensor, const motion_sample_t* motion,
+                           unsigned int magnitude, unsigned int average,
+                           unsigned int timestamp_ms);
+
+/**
+ * @brief Stream one detector event.
+ *
+ * Pending delta samples are flushed first so the stream stays in order.
+ *
+ * @param event Event from detector_get_event()
+ * @return void
+ */
+void telemetry_send_event(const detect_event_t* event);
+
+/**
+ * @brief Decode received command frames.
+ *
+ * TLM_CMD_SET_MODE is applied here; other valid commands are returned for
+ * the application to act on. Frames with a bad CRC are discarded.
+ *
+ * @param command Pointer to store the command type
+ * @param value Pointer to store the one-byte body, 0 for commands without one
+ * @return unsigned char 1 if a command was returned, 0 if none pending
+ */
+unsigned char telemetry_poll_command(uint8_t* command, uint8_t* value);
+
+/**
+ * @brief Frames dropped because the TX ring was full.
+ *
+ * @return unsigned int Count since telemetry_init()
+ */
+unsigned int telemetry_get_dropped(void);
+
+#endif  // TELEMETRY_H
@@ -0,0 +1,72 @@
+/**
+ * @file telemetry_frames.h
+ * @brief Telemetry wire format, shared by the firmware and the host decoder.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef TELEMETRY_FRAMES_H
+#define TELEMETRY_FRAMES_H
+
+#include <stdint.h>
+
+/**
+ * Framing:
+ *   COBS( type, seq, body..., crc_lo, crc_hi ) 0x00
+ *
+ * COBS removes every 0x00 from the frame, so 0x00 only ever marks a frame
+ * end and a receiver can resynchronise after any lost byte. The CRC is
+ * CRC-16/CCITT-FALSE over type, seq and body. seq increments per frame,
+ * so the host can count gaps. Multi-byte fields are little-endian.
+ *
+ * Bodies:
+ *   SAMPLE  t_ms:u16 ax ay az gx gy gz:i16 mag:u16 avg:u16        (18)
+ *   DELTA   n:u8, n x { dax day daz dgx dgy dgz dmag davg:i8 }  (1 + 8n)
+ *   EVENT   event:u8 t_ms:u16 value:u16 duration_ms:u16             (7)
+ *
+ * SAMPLE and DELTA frames carry the sensor index (TLM_SENSOR_*) in the
+ * upper nibble of type; each sensor has its own delta chain. EVENT frames
+ * come from the guard sensor's detector.
+ *
+ * A DELTA entry is the difference from the previous sample of the same
+ * sensor, so a host can only apply deltas after that sensor's SAMPLE
+ * (keyframe) and must discard them after a seq gap until the next one.
+ *
+ * Line budget at 115200 baud (~11.5 kB/s):
+ *   SAMPLE frame   24 bytes on the wire per sample
+ *   DELTA frame    39 bytes per 4 samples, 9.75 per sample
+ * Full mode is fine up to ~450 Hz; delta mode keeps 1 kHz under budget.
+ * Both sensors together count against the same budget.
+ */
+
+#define TLM_FRAME_SAMPLE      0x01
+#define TLM_FRAME_DELTA       0x02
+#define TLM_FRAME_EVENT       0x03
+#define TLM_FRAME_TYPE_MASK   0x0F
+#define TLM_FRAME_SENSOR_SHIFT 4    // Sensor index in type bits 4..6
+
+#define TLM_SENSOR_GUARD      0     // Blade guard MPU-6050 (AD0 low)
+#define TLM_SENSOR_WRIST      1     // Wrist MPU-6050 (AD0 high)
+#define TLM_MAX_SENSORS       2
+
+// Host to device
+#define TLM_CMD_SET_MODE      0x81  // body: mode:u8
+#define TLM_CMD_SAVE_CONFIG   0x82  // store the current configuration
+#define TLM_CMD_RECALIBRATE   0x83  // re-run the gyro calibration and store it
+#define TLM_CMD_SET_PROFILE   0x84  // body: acc_profile_t:u8 (not stored until SAVE_CONFIG)
+
+#define TLM_MODE_OFF          0x00
+#define TLM_MODE_FULL         0x01  // Every sample as a SAMPLE frame
+#define TLM_MODE_DELTA        0x02  // Keyframes plus batched DELTA frames
+
+#define TLM_HEADER_LEN        2     // type, seq
+#define TLM_CRC_LEN           2
+#define TLM_SAMPLE_BODY_LEN   18
+#define TLM_DELTA_ENTRY_LEN   8
+#define TLM_DELTA_BATCH       4     // Samples per DELTA frame
+#define TLM_EVENT_BODY_LEN    7
+#define TLM_KEYFRAME_INTERVAL 50    // Max samples between keyframes
+
+#define TLM_MAX_FRAME_LEN     (TLM_HEADER_LEN + 1 + TLM_DELTA_BATCH * TLM_DELTA_ENTRY_LEN + TLM_CRC_LEN)
+#define TLM_MAX_WIRE_LEN      (TLM_MAX_FRAME_LEN + 2)   // + COBS code byte + delimiter
+
+#endif  // TELEMETRY_FRAMES_H
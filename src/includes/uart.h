@@ -0,0 +1,81 @@
+/**
+ * @file uart.h
+ * @brief Interrupt-driven EUSART1 driver for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+#ifndef UART_H
+#define UART_H
+
+#include "./hal.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * EUSART1 pins:
+ * - TX1 on RC6, RX1 on RC7 (ANSELC must be cleared)
+ * - 8N1, BRG16 = 1, BRGH = 1: baud = Fosc / (4 * (SPBRG + 1))
+ *
+ * Both directions go through ring buffers serviced by uart_isr(), so
+ * writers never wait for the line. At 115200 baud a TX interrupt fires
+ * every ~87 us while data is queued.
+ */
+
+#define UART_DEFAULT_BAUD  115200UL
+#define UART_TX_SIZE       128  // TX ring length (power of two, <= 256)
+#define UART_RX_SIZE       32   // RX ring length (power of two, <= 256)
+
+/**
+ * @brief Configure EUSART1 for asynchronous 8N1 and enable its interrupts.
+ *
+ * Peripheral interrupts must be enabled separately (configure_interrupts).
+ *
+ * @param baud Baud rate; 115200 gives SPBRG = 34 (-0.8% error)
+ * @return void
+ */
+void uart_init(unsigned long baud);
+
+/**
+ * @brief Free space in the TX ring.
+ *
+ * @return unsigned char Bytes that uart_write() will accept right now
+ */
+unsigned char uart_tx_free(void);
+
+/**
+ * @brief Queue bytes for transmission without blocking.
+ *
+ * All or nothing: if the ring cannot take every byte, nothing is queued.
+ *
+ * @param data Bytes to send
+ * @param length Number of bytes
+ * @return unsigned char 1 if queued, 0 if the ring was too full
+ */
+unsigned char uart_write(const uint8_t* data, unsigned char length);
+
+/**
+ * @brief Take one received byte.
+ *
+ * @param byte Pointer to store the byte
+ * @return unsigned char 1 if a byte was returned, 0 if the ring is empty
+ */
+unsigned char uart_read(uint8_t* byte);
+
+/**
+ * @brief Receive bytes lost to a full RX ring or a hardware overrun.
+ *
+ * @return unsigned int Count since uart_init()
+ */
+unsigned int uart_get_rx_overruns(void);
+
+/**
+ * @brief EUSART1 interrupt handler; moves bytes between the rings and the port.
+ *
+ * Must be called from the interrupt service routine. Returns immediately
+ * if neither TX1IF (with TX1IE) nor RC1IF is set.
+ *
+ * @return void
+ */
+void uart_isr(void);
+
+#endif  // UART_H
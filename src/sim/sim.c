@@ -0,0 +1,718 @@
+/**
+ * @file sim.c
+ * @brief Host-side peripheral simulator core for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Owns the simulated register file, simulated time, Timer0/2/4/6, GPIO
+ * (button on RB0, MPU-6050 INT on RB1 and RB2, interrupt-on-change, INT0-2),
+ * interrupt delivery to the firmware's isr(), and the output log (RGB LED
+ * duty, buzzer tone, RA0 error indicator). The firmware's main() is
+ * compiled as firmware_main() and called after the simulator is set up.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "./sim.h"
+
+// Firmware entry points
+extern void isr(void);
+extern int firmware_main(void);
+
+#define SIM_DEFAULT_DURATION_MS 5000.0
+#define SIM_MAX_ISR_LOOPS       1000   // ISR re-entries before declaring a stuck flag
+
+/* ---------------------------------------------------------------------
+ * Register file
+ * ------------------------------------------------------------------ */
+
+#define SIM_DEFINE_SFR(name) volatile sim_##name##_t sim_##name;
+SIM_SFR_LIST(SIM_DEFINE_SFR)
+
+/* ---------------------------------------------------------------------
+ * Simulator state
+ * ------------------------------------------------------------------ */
+
+sim_time_t sim_now = 0;
+
+typedef struct
+{
+    volatile uint8_t* con;     // TxCON (CKPS 1:0, ON 2, OUTPS 6:3)
+    volatile uint8_t* tmr;     // TMRx
+    volatile uint8_t* pr;      // PRx
+    volatile uint8_t* pir;     // Flag register
+    uint8_t flag;              // Flag bit mask
+    sim_time_t acc;            // Cycles into the current period
+    uint8_t post;              // Postscaler count
+} sim_timer_t;
+
+static sim_timer_t timers[3];
+static sim_time_t timer0_acc = 0;
+
+static sim_mpu6050_t mpu;
+static sim_trace_t trace;
+static int have_trace = 0;
+
+// Optional second sensor at AD0 high with its INT on RB2
+static sim_mpu6050_t wrist_mpu;
+static sim_trace_t wrist_trace;
+static int have_wrist = 0;
+
+static sim_time_t end_time = 0;
+static int quiet = 0;
+static int in_isr = 0;
+static uint8_t pins_b = 0xEF;       // External levels on PORTB (pulled up, INT low)
+
+static clock_t wall_start;
+static unsigned long isr_count = 0;
+static unsigned long log_lines = 0;
+
+// RGB duties latched from CCPRxL:DCxB at the last Timer2 period match
+static unsigned pwm_duty[3];
+
+// Last logged outputs
+static unsigned last_led[3] = { ~0u, ~0u, ~0u };
+static unsigned long last_tone = ~0ul;
+static int last_err = -1;
+
+/* ---------------------------------------------------------------------
+ * Output log
+ * ------------------------------------------------------------------ */
+
+static void sim_log(const char* what, const char* detail)
+{
+	log_lines++;
+	if (!quiet)
+	{
+		printf("%10.3f ms  %-5s %s\n", (double)sim_now / SIM_TCY_PER_MS, what, detail);
+	}
+}
+
+static unsigned sim_pwm_duty(uint8_t ccpcon, uint8_t ccprl)
+{
+	// PWM mode is CCPxM = 11xx
+	if ((ccpcon & 0x0C) != 0x0C)
+	{
+		return 0;
+	}
+	return ((unsigned)ccprl << 2) | ((ccpcon >> 4) & 0x03);
+}
+
+/**
+ * @brief Load the RGB duty buffers, as the CCPs do on a Timer2 match.
+ */
+static void sim_pwm_latch(void)
+{
+	pwm_duty[0] = sim_pwm_duty(CCP1CON, CCPR1L);
+	pwm_duty[1] = sim_pwm_duty(CCP2CON, CCPR2L);
+	pwm_duty[2] = sim_pwm_duty(CCP3CON, CCPR3L);
+}
+
+static unsigned sim_timer_prescale(uint8_t con)
+{
+	static const unsigned prescale[4] = { 1, 4, 16, 16 };
+	return prescale[con & 0x03];
+}
+
+/**
+ * @brief Log changes on the RGB LED, buzzer and RA0.
+ */
+static void sim_watch_outputs(void)
+{
+	char detail[96];
+	unsigned led[3];
+	unsigned long tone = 0;
+	int err;
+	
+	// A duty written mid-period shows from the next Timer2 match
+	memcpy(led, pwm_duty, sizeof(led));
+	if (memcmp(led, last_led, sizeof(led)) != 0)
+	{
+		memcpy(last_led, led, sizeof(led));
+		snprintf(detail, sizeof(detail), "r=%4u g=%4u b=%4u (of %u)",
+				 led[0], led[1], led[2], 4u * (PR2 + 1u));
+		sim_log("LED", detail);
+	}
+	
+	if (T4CONbits.TMR4ON && (CCP5CON & 0x0C) == 0x0C && PR4 != 0)
+	{
+		tone = (SIM_FOSC_HZ / 4UL) / (sim_timer_prescale(T4CON) * (PR4 + 1UL));
+	}
+	if (tone != last_tone)
+	{
+		last_tone = tone;
+		if (tone)
+		{
+			snprintf(detail, sizeof(detail), "%lu Hz", tone);
+		}
+		else
+		{
+			snprintf(detail, sizeof(detail), "off");
+		}
+		sim_log("TONE", detail);
+	}
+	
+	err = PORTAbits.RA0;
+	if (err != last_err)
+	{
+		last_err = err;
+		sim_log("ERR", err ? "on" : "off");
+	}
+}
+
+/* ---------------------------------------------------------------------
+ * Timers
+ * ------------------------------------------------------------------ */
+
+static sim_time_t sim_timer0_next(void)
+{
+	unsigned long prescale;
+	unsigned long span;
+	unsigned long count;
+	
+	if (!T0CONbits.TMR0ON)
+	{
+		return SIM_NEVER;
+	}
+	
+	prescale = T0CONbits.PSA ? 1UL : (2UL << T0CONbits.T0PS);
+	span = T0CONbits.T08BIT ? 256UL : 65536UL;
+	count = T0CONbits.T08BIT ? TMR0L : (((unsigned long)TMR0H << 8) | TMR0L);
+	
+	return sim_now + (span - count) * prescale - timer0_acc;
+}
+
+static void sim_timer0_advance(sim_time_t dt)
+{
+	unsigned long prescale;
+	unsigned long span;
+	unsigned long count;
+	
+	if (!T0CONbits.TMR0ON)
+	{
+		return;
+	}
+	
+	prescale = T0CONbits.PSA ? 1UL : (2UL << T0CONbits.T0PS);
+	span = T0CONbits.T08BIT ? 256UL : 65536UL;
+	count = T0CONbits.T08BIT ? TMR0L : (((unsigned long)TMR0H << 8) | TMR0L);
+	
+	timer0_acc += dt;
+	count += (unsigned long)(timer0_acc / prescale);
+	timer0_acc %= prescale;
+	
+	if (count >= span)
+	{
+		INTCONbits.TMR0IF = 1;
+		count %= span;
+	}
+	
+	TMR0L = (uint8_t)(count & 0xFF);
+	if (!T0CONbits.T08BIT)
+	{
+		TMR0H = (uint8_t)(count >> 8);
+	}
+}
+
+static sim_time_t sim_timer_period(const sim_timer_t* t)
+{
+	return (sim_time_t)(*t->pr + 1u) * sim_timer_prescale(*t->con);
+}
+
+static sim_time_t sim_timer_next(const sim_timer_t* t)
+{
+	sim_time_t period;
+	unsigned outps;
+	
+	if (!(*t->con & 0x04))
+	{
+		return SIM_NEVER;
+	}
+	
+	period = sim_timer_period(t);
+	outps = (*t->con >> 3) & 0x0F;
+	if (t->acc >= period)
+	{
+		return sim_now;
+	}
+	return sim_now + (period - t->acc) + (sim_time_t)(outps - t->post) * period;
+}
+
+static void sim_timer_advance(sim_timer_t* t, sim_time_t dt)
+{
+	sim_time_t period;
+	unsigned outps;
+	
+	if (!(*t->con & 0x04))
+	{
+		return;
+	}
+	
+	period = sim_timer_period(t);
+	outps = (*t->con >> 3) & 0x0F;
+	
+	t->acc += dt;
+	while (t->acc >= period)
+	{
+		t->acc -= period;
+		if (t == &timers[0])
+		{
+			sim_pwm_latch();
+		}
+		if (t->post >= outps)
+		{
+			t->post = 0;
+			*t->pir |= t->flag;
+		}
+		else
+		{
+			t->post++;
+		}
+	}
+	*t->tmr = (uint8_t)(t->acc / sim_timer_prescale(*t->con));
+}
+
+/* ---------------------------------------------------------------------
+ * GPIO
+ * ------------------------------------------------------------------ */
+
+/**
+ * @brief Drive external pin levels into PORTB and raise INTx / IOC flags.
+ */
+static void sim_update_pins(void)
+{
+	double next_change;
+	uint8_t now_pins = 0xFF;
+	uint8_t inputs = TRISB;
+	uint8_t changed;
+	
+	// RB0: active-low button from the trace
+	if (have_trace && sim_trace_button(&trace, (double)sim_now / SIM_TCY_PER_MS, &next_change))
+	{
+		now_pins &= (uint8_t)~0x01;
+	}
+	
+	// RB1: MPU-6050 INT
+	if (!sim_mpu6050_int_pin(&mpu))
+	{
+		now_pins &= (uint8_t)~0x02;
+	}
+	
+	// RB2: wrist MPU-6050 INT (pulled up when not fitted)
+	if (have_wrist && !sim_mpu6050_int_pin(&wrist_mpu))
+	{
+		now_pins &= (uint8_t)~0x04;
+	}
+	
+	// Inputs read the pin; outputs read back what the firmware wrote
+	changed = (uint8_t)((pins_b ^ now_pins) & inputs);
+	pins_b = now_pins;
+	PORTB = (uint8_t)((PORTB & ~inputs) | (pins_b & inputs));
+	
+	// External interrupts: INTEDGx = 1 rising, 0 falling
+	if ((changed & 0x01) && (((pins_b & 0x01) != 0) == INTCON2bits.INTEDG0))
+	{
+		INTCONbits.INT0IF = 1;
+	}
+	if ((changed & 0x02) && (((pins_b & 0x02) != 0) == INTCON2bits.INTEDG1))
+	{
+		INTCON3bits.INT1IF = 1;
+	}
+	if ((changed & 0x04) && (((pins_b & 0x04) != 0) == INTCON2bits.INTEDG2))
+	{
+		INTCON3bits.INT2IF = 1;
+	}
+	
+	// Interrupt-on-change on RB7:RB4
+	if (changed & IOCB & 0xF0)
+	{
+		INTCONbits.RBIF = 1;
+	}
+}
+
+static sim_time_t sim_pins_next(void)
+{
+	double next_change;
+	
+	if (!have_trace)
+	{
+		return SIM_NEVER;
+	}
+	
+	(void)sim_trace_button(&trace, (double)sim_now / SIM_TCY_PER_MS, &next_change);
+	if (next_change < 0.0)
+	{
+		return SIM_NEVER;
+	}
+	return (sim_time_t)(next_change * SIM_TCY_PER_MS + 0.5);
+}
+
+/* ---------------------------------------------------------------------
+ * Interrupts
+ * ------------------------------------------------------------------ */
+
+/**
+ * @brief True if any enabled interrupt flag is set (ignores GIE).
+ */
+static int sim_irq_raised(void)
+{
+	uint8_t core = (uint8_t)(INTCON & (INTCON >> 3) & 0x07);
+	uint8_t ext = (uint8_t)(INTCON3 & (INTCON3 >> 3) & 0x03);
+	uint8_t periph = (uint8_t)((PIR1 & PIE1) | (PIR2 & PIE2) | (PIR3 & PIE3) | (PIR5 & PIE5));
+	
+	return core || ext || (INTCONbits.PEIE && periph);
+}
+
+static void sim_finish(void);
+
+/**
+ * @brief Apply register side effects of the code that just ran.
+ */
+static void sim_sync(void)
+{
+	sim_i2c_sync();
+	sim_eeprom_sync();
+	sim_uart_sync();
+	sim_update_pins();
+	sim_watch_outputs();
+}
+
+/**
+ * @brief Vector to isr() while interrupts are enabled and pending.
+ */
+static void sim_deliver_irqs(void)
+{
+	unsigned loops = 0;
+	
+	while (!in_isr && INTCONbits.GIE && sim_irq_raised())
+	{
+		if (++loops > SIM_MAX_ISR_LOOPS)
+		{
+			fprintf(stderr, "sim: interrupt flag never cleared (INTCON=%02X PIR1=%02X PIR3=%02X PIR5=%02X)\n",
+					INTCON, PIR1, PIR3, PIR5);
+			exit(2);
+		}
+		
+		// Hardware clears GIE on entry and RETFIE sets it again
+		INTCONbits.GIE = 0;
+		in_isr = 1;
+		isr();
+		in_isr = 0;
+		INTCONbits.GIE = 1;
+		isr_count++;
+		
+		sim_sync();
+	}
+}
+
+/* ---------------------------------------------------------------------
+ * Time
+ * ------------------------------------------------------------------ */
+
+static sim_time_t sim_min(sim_time_t a, sim_time_t b)
+{
+	return a < b ? a : b;
+}
+
+static sim_time_t sim_next_event(void)
+{
+	unsigned i;
+	sim_time_t next = end_time;
+	
+	next = sim_min(next, sim_timer0_next());
+	for (i = 0; i < 3; i++)
+	{
+		next = sim_min(next, sim_timer_next(&timers[i]));
+	}
+	next = sim_min(next, sim_i2c_next_event());
+	next = sim_min(next, sim_mpu6050_next_event(&mpu));
+	if (have_wrist)
+	{
+		next = sim_min(next, sim_mpu6050_next_event(&wrist_mpu));
+	}
+	next = sim_min(next, sim_eeprom_next_event());
+	next = sim_min(next, sim_uart_next_event());
+	next = sim_min(next, sim_pins_next());
+	
+	return next;
+}
+
+/**
+ * @brief Move time to target (<= next event) and process what became due.
+ */
+static void sim_step_to(sim_time_t target)
+{
+	sim_time_t dt;
+	unsigned i;
+	
+	if (target > sim_now)
+	{
+		dt = target - sim_now;
+		sim_timer0_advance(dt);
+		for (i = 0; i < 3; i++)
+		{
+			sim_timer_advance(&timers[i], dt);
+		}
+		sim_now = target;
+	}
+	
+	sim_i2c_advance();
+	sim_mpu6050_advance(&mpu);
+	if (have_wrist)
+	{
+		sim_mpu6050_advance(&wrist_mpu);
+	}
+	sim_eeprom_advance();
+	sim_uart_advance();
+	sim_sync();
+	
+	if (sim_now >= end_time)
+	{
+		sim_finish();
+	}
+	
+	sim_deliver_irqs();
+}
+
+/**
+ * @brief Advance time by cycles, stopping at every event on the way.
+ */
+static void sim_advance(sim_time_t cycles)
+{
+	sim_time_t target = sim_now + cycles;
+	
+	while (sim_now < target)
+	{
+		sim_step_to(sim_min(target, sim_next_event()));
+	}
+}
+
+void sim_spin(void)
+{
+	sim_sync();
+	sim_deliver_irqs();
+	sim_advance(SIM_SPIN_TCY);
+}
+
+void sim_sleep(void)
+{
+	unsigned long isr_before = isr_count;
+	
+	sim_sync();
+	
+	// Any enabled flag wakes the core, whether or not GIE vectors it;
+	// flags serviced while stepping count as a wake-up too
+	while (!sim_irq_raised() && isr_count == isr_before)
+	{
+		sim_time_t next = sim_next_event();
+		sim_step_to(next > sim_now ? next : sim_now + 1);
+	}
+	
+	sim_deliver_irqs();
+}
+
+/* ---------------------------------------------------------------------
+ * Setup / teardown
+ * ------------------------------------------------------------------ */
+
+static void sim_reset_registers(void)
+{
+	// Power-on values that matter to the firmware
+	TRISA = 0xFF;
+	TRISB = 0xFF;
+	TRISC = 0xFF;
+	TRISD = 0xFF;
+	PORTD = 0xFF;
+	ANSELA = 0xFF;
+	ANSELB = 0xFF;
+	ANSELC = 0xFF;
+	ANSELD = 0xFF;
+	INTCON2 = 0xFF;
+	WPUB = 0xFF;
+	PR2 = 0xFF;
+	PR4 = 0xFF;
+	PR6 = 0xFF;
+	T0CON = 0xFF;
+	SSP2STAT = 0x00;
+	PORTB = pins_b;
+	
+	timers[0] = (sim_timer_t){ &T2CON, &TMR2, &PR2, &PIR1, 0x02, 0, 0 };
+	timers[1] = (sim_timer_t){ &T4CON, &TMR4, &PR4, &PIR5, 0x01, 0, 0 };
+	timers[2] = (sim_timer_t){ &T6CON, &TMR6, &PR6, &PIR5, 0x04, 0, 0 };
+}
+
+static void sim_finish(void)
+{
+	double wall_s = (double)(clock() - wall_start) / CLOCKS_PER_SEC;
+	double sim_ms = (double)sim_now / SIM_TCY_PER_MS;
+	
+	sim_eeprom_save();
+	sim_uart_close();
+	
+	fflush(stdout);
+	fprintf(stderr,
+			"\n--- micro-fencing simulation ---\n"
+			"simulated time   %10.1f ms\n"
+			"wall time        %10.3f s (%.0fx real time)\n"
+			"interrupts       %10lu\n"
+			"i2c starts       %10lu (%lu bytes out, %lu in, %lu NACK)\n"
+			"i2c faults       %10lu collisions, %lu bus clears\n"
+			"mpu samples      %10lu guard, %lu wrist (%lu FIFO overflows)\n"
+			"eeprom writes    %10lu\n"
+			"uart bytes       %10lu out, %lu in (%lu overruns, %lu lost)\n"
+			"output changes   %10lu\n",
+			sim_ms, wall_s, wall_s > 0.0 ? (sim_ms / 1000.0) / wall_s : 0.0,
+			isr_count,
+			sim_i2c_stats.starts, sim_i2c_stats.bytes_written,
+			sim_i2c_stats.bytes_read, sim_i2c_stats.nacks,
+			sim_i2c_stats.collisions, sim_i2c_stats.bus_clears,
+			mpu.samples, wrist_mpu.samples, mpu.overflows + wrist_mpu.overflows,
+			sim_eeprom_writes,
+			sim_uart_stats.tx_bytes, sim_uart_stats.rx_bytes,
+			sim_uart_stats.rx_overruns, sim_uart_stats.tx_lost, log_lines);
+	exit(0);
+}
+
+static void sim_usage(const char* argv0)
+{
+	fprintf(stderr,
+			"usage: %s [-t trace] [-w trace] [-d duration_ms] [-b gx,gy,gz] [-e image]\n"
+			"       [-u path|pty] [-U path] [-x from,to] [-X at] [-q]\n"
+			"  -t  motion trace: time_ms gx gy gz [ax ay az [button [temp_c]]]\n"
+			"  -w  fit a second (wrist) sensor at AD0 high, INT on RB2, driven by this trace\n"
+			"  -d  simulated duration (default: trace length, or %.0f ms)\n"
+			"  -b  gyro zero-rate offset in deg/s (default 0,0,0)\n"
+			"  -e  data EEPROM image, loaded at start and saved on exit\n"
+			"  -u  EUSART1 TX output file, or \"pty\" for a pseudo-terminal (also RX)\n"
+			"  -U  EUSART1 RX input file, fed at the line rate\n"
+			"  -x  detach the sensors from the I2C bus between from and to ms\n"
+			"  -X  a sensor holds SDA low from this time (ms) until the bus is cleared\n"
+			"  -q  only print the summary\n",
+			argv0, SIM_DEFAULT_DURATION_MS);
+}
+
+int main(int argc, char** argv)
+{
+	const char* trace_path = NULL;
+	const char* wrist_path = NULL;
+	const char* eeprom_path = NULL;
+	const char* uart_tx_path = NULL;
+	const char* uart_rx_path = NULL;
+	double duration_ms = -1.0;
+	double bias[3] = { 0.0, 0.0, 0.0 };
+	double detach[2] = { -1.0, -1.0 };
+	double stuck_ms = -1.0;
+	int i;
+	
+	for (i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+		{
+			trace_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc)
+		{
+			wrist_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc)
+		{
+			duration_ms = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+		{
+			if (sscanf(argv[++i], "%lf,%lf,%lf", &bias[0], &bias[1], &bias[2]) != 3)
+			{
+				sim_usage(argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+		{
+			eeprom_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-u") == 0 && i + 1 < argc)
+		{
+			uart_tx_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-U") == 0 && i + 1 < argc)
+		{
+			uart_rx_path = argv[++i];
+		}
+		else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc)
+		{
+			if (sscanf(argv[++i], "%lf,%lf", &detach[0], &detach[1]) != 2)
+			{
+				sim_usage(argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "-X") == 0 && i + 1 < argc)
+		{
+			stuck_ms = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-q") == 0)
+		{
+			quiet = 1;
+		}
+		else
+		{
+			sim_usage(argv[0]);
+			return 1;
+		}
+	}
+	
+	if (trace_path != NULL)
+	{
+		if (sim_trace_load(&trace, trace_path) != 0)
+		{
+			return 1;
+		}
+		have_trace = 1;
+	}
+	
+	if (wrist_path != NULL)
+	{
+		if (sim_trace_load(&wrist_trace, wrist_path) != 0)
+		{
+			return 1;
+		}
+		have_wrist = 1;
+	}
+	
+	if (sim_eeprom_load(eeprom_path) != 0)
+	{
+		return 1;
+	}
+	
+	if (sim_uart_open(uart_tx_path, uart_rx_path) != 0)
+	{
+		return 1;
+	}
+	
+	if (duration_ms < 0.0)
+	{
+		duration_ms = have_trace ? sim_trace_end_ms(&trace) : SIM_DEFAULT_DURATION_MS;
+	}
+	end_time = (sim_time_t)(duration_ms * SIM_TCY_PER_MS);
+	
+	sim_reset_registers();
+	sim_mpu6050_init(&mpu, 0x68, have_trace ? &trace : NULL);
+	memcpy(mpu.gyro_bias_dps, bias, sizeof(bias));
+	sim_i2c_attach(&mpu);
+	if (have_wrist)
+	{
+		sim_mpu6050_init(&wrist_mpu, 0x69, &wrist_trace);
+		memcpy(wrist_mpu.gyro_bias_dps, bias, sizeof(bias));
+		sim_i2c_attach(&wrist_mpu);
+	}
+	sim_i2c_fault(detach[0], detach[1], stuck_ms);
+	
+	wall_start = clock();
+	firmware_main();
+	
+	// The firmware never returns on target; treat a return as the end
+	sim_finish();
+	return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file sim.h
+ * @brief Host-side peripheral simulator internals for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Time is counted in instruction cycles (Tcy = 4 / Fosc = 250 ns). Firmware
+ * code runs in zero simulated time between sync points; peripherals are
+ * advanced event by event, so idle periods are skipped and the simulation
+ * runs much faster than real time.
+ */
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "./sim_sfr.h"
+
+#define SIM_FOSC_HZ      16000000UL
+#define SIM_TCY_PER_MS   (SIM_FOSC_HZ / 4000UL)   // 4000 Tcy per ms
+#define SIM_SPIN_TCY     4                       // Cycles per busy-wait pass
+#define SIM_NEVER        UINT64_MAX
+
+typedef uint64_t sim_time_t;
+
+extern sim_time_t sim_now;
+
+/* ---------------------------------------------------------------------
+ * Motion trace (sim_trace.c)
+ * ------------------------------------------------------------------ */
+
+typedef struct
+{
+    double t_ms;        // Time stamp
+    double gyro[3];     // Angular rate X/Y/Z (deg/s)
+    double accel[3];    // Acceleration X/Y/Z (g)
+    int button;         // 1 while the button is held
+    double temp_c;      // Die temperature (deg C)
+} sim_trace_point_t;
+
+typedef struct
+{
+    sim_trace_point_t* points;
+    size_t count;
+} sim_trace_t;
+
+// Load "time_ms gx gy gz [ax ay az [button [temp_c]]]" lines ('#' comments).
+int sim_trace_load(sim_trace_t* trace, const char* path);
+
+// Motion values linearly interpolated at t_ms (held after the last point).
+void sim_trace_sample(const sim_trace_t* trace, double t_ms, sim_trace_point_t* out);
+
+// Button state at t_ms and time of the next button change (-1 if none).
+int sim_trace_button(const sim_trace_t* trace, double t_ms, double* next_change_ms);
+
+double sim_trace_end_ms(const sim_trace_t* trace);
+
+/* ---------------------------------------------------------------------
+ * MPU-6050 slave (sim_mpu6050.c)
+ * ------------------------------------------------------------------ */
+
+#define SIM_MPU_FIFO_SIZE 1024
+
+typedef struct
+{
+    uint8_t address;             // 7-bit I2C address (0x68 AD0 low, 0x69 AD0 high)
+    uint8_t regs[128];           // Register file
+    uint8_t fifo[SIM_MPU_FIFO_SIZE];
+    uint16_t fifo_head;          // Oldest byte
+    uint16_t fifo_count;
+    uint8_t reg_ptr;             // Register pointer (auto-increments)
+    uint8_t bus_state;           // Slave protocol state
+    sim_time_t next_sample;      // Next internal sample instant
+    sim_time_t int_until;        // End of the current INT pulse
+    uint8_t int_latched;         // INT held until INT_STATUS is read
+    const sim_trace_t* trace;    // Motion source (NULL = at rest)
+    double gyro_bias_dps[3];     // Zero-rate offset added to every sample
+    unsigned long samples;       // Statistics
+    unsigned long overflows;
+} sim_mpu6050_t;
+
+void sim_mpu6050_init(sim_mpu6050_t* mpu, uint8_t address, const sim_trace_t* trace);
+void sim_mpu6050_advance(sim_mpu6050_t* mpu);
+sim_time_t sim_mpu6050_next_event(const sim_mpu6050_t* mpu);
+uint8_t sim_mpu6050_int_pin(const sim_mpu6050_t* mpu);
+
+// Bus interface, called by the SSP2 model
+void sim_mpu6050_i2c_start(sim_mpu6050_t* mpu);
+void sim_mpu6050_i2c_stop(sim_mpu6050_t* mpu);
+int sim_mpu6050_i2c_write(sim_mpu6050_t* mpu, uint8_t byte);   // 1 = ACK
+int sim_mpu6050_i2c_read(sim_mpu6050_t* mpu, uint8_t* byte);   // 1 = driven
+
+/* ---------------------------------------------------------------------
+ * SSP2 I2C master + bus (sim_i2c.c)
+ * ------------------------------------------------------------------ */
+
+#define SIM_I2C_MAX_SLAVES   4
+#define SIM_I2C_STUCK_CLOCKS 5   // SCL pulses a stuck slave needs to finish its byte
+
+void sim_i2c_attach(sim_mpu6050_t* slave);
+
+// Detach the sensor for [from, to) ms and/or hold SDA low from stuck_at ms
+// (negative = no fault).
+void sim_i2c_fault(double detach_from_ms, double detach_to_ms, double stuck_at_ms);
+void sim_i2c_sync(void);
+void sim_i2c_advance(void);
+sim_time_t sim_i2c_next_event(void);
+
+typedef struct
+{
+    unsigned long starts;
+    unsigned long bytes_written;
+    unsigned long bytes_read;
+    unsigned long nacks;
+    unsigned long collisions;
+    unsigned long bus_clears;  // Stuck SDA released by recovery clocks
+} sim_i2c_stats_t;
+
+extern sim_i2c_stats_t sim_i2c_stats;
+
+/* ---------------------------------------------------------------------
+ * Data EEPROM (sim_eeprom.c)
+ * ------------------------------------------------------------------ */
+
+#define SIM_EEPROM_SIZE      256
+#define SIM_EEPROM_WRITE_TCY (4UL * SIM_TCY_PER_MS)   // ~4 ms per byte
+
+// Load the image from path (missing file = erased, 0xFF); kept for saving.
+int sim_eeprom_load(const char* path);
+
+// Write the image back to the path given to sim_eeprom_load().
+void sim_eeprom_save(void);
+
+void sim_eeprom_sync(void);
+void sim_eeprom_advance(void);
+sim_time_t sim_eeprom_next_event(void);
+
+extern unsigned long sim_eeprom_writes;
+
+/* ---------------------------------------------------------------------
+ * EUSART1 (sim_uart.c)
+ * ------------------------------------------------------------------ */
+
+// TX bytes go to path ("pty" opens a pseudo-terminal and prints its name);
+// RX bytes come from rx_path, or from the pty when TX uses one.
+int sim_uart_open(const char* tx_path, const char* rx_path);
+void sim_uart_close(void);
+
+void sim_uart_sync(void);
+void sim_uart_advance(void);
+sim_time_t sim_uart_next_event(void);
+
+typedef struct
+{
+    unsigned long tx_bytes;
+    unsigned long rx_bytes;
+    unsigned long rx_overruns;
+    unsigned long tx_lost;     // Bytes the pty could not take
+} sim_uart_stats_t;
+
+extern sim_uart_stats_t sim_uart_stats;
+
+#endif // SIM_H
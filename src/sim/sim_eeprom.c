@@ -0,0 +1,138 @@
+/**
+ * @file sim_eeprom.c
+ * @brief Data EEPROM model for the host-side simulator.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * 256 bytes, erased to 0xFF. A read completes on the EEDATA access that
+ * follows RD = 1. A write starts when WR is set with WREN = 1 right after
+ * EECON2 = 0x55, 0xAA, and finishes ~4 ms later by clearing WR and setting
+ * EEIF. The image can be loaded from and saved to a file so configuration
+ * survives between runs, like the real part across power cycles.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "./sim.h"
+
+unsigned long sim_eeprom_writes = 0;
+
+static uint8_t memory[SIM_EEPROM_SIZE];
+static const char* image_path = NULL;
+
+static uint8_t unlock_prev = 0;           // Value of the EECON2 write before the last
+static sim_time_t write_done = SIM_NEVER;
+static uint8_t write_addr = 0;
+static uint8_t write_data = 0;
+
+int sim_eeprom_load(const char* path)
+{
+	FILE* f;
+
+	memset(memory, 0xFF, sizeof(memory));
+	image_path = path;
+	if (path == NULL)
+	{
+		return 0;
+	}
+
+	f = fopen(path, "rb");
+	if (f == NULL)
+	{
+		// First run: start erased, create the file on exit
+		return 0;
+	}
+	if (fread(memory, 1, sizeof(memory), f) != sizeof(memory))
+	{
+		fprintf(stderr, "sim: %s is not a %d-byte EEPROM image\n", path, SIM_EEPROM_SIZE);
+		fclose(f);
+		return -1;
+	}
+	fclose(f);
+	return 0;
+}
+
+void sim_eeprom_save(void)
+{
+	FILE* f;
+
+	if (image_path == NULL)
+	{
+		return;
+	}
+
+	f = fopen(image_path, "wb");
+	if (f == NULL || fwrite(memory, 1, sizeof(memory), f) != sizeof(memory))
+	{
+		fprintf(stderr, "sim: cannot write %s\n", image_path);
+	}
+	if (f != NULL)
+	{
+		fclose(f);
+	}
+}
+
+volatile uint8_t* sim_eecon2_access(void)
+{
+	// The register still holds the previous write; remember it so the
+	// sync point can see the last two values of the sequence
+	unlock_prev = sim_EECON2.reg;
+	return &sim_EECON2.reg;
+}
+
+volatile uint8_t* sim_eedata_access(void)
+{
+	if (EECON1bits.RD)
+	{
+		if (!EECON1bits.EEPGD && !EECON1bits.CFGS)
+		{
+			sim_EEDATA.reg = memory[EEADR];
+		}
+		EECON1bits.RD = 0;
+	}
+	return &sim_EEDATA.reg;
+}
+
+void sim_eeprom_sync(void)
+{
+	if (!EECON1bits.WR || write_done != SIM_NEVER)
+	{
+		return;
+	}
+
+	// WR only sticks after the unlock sequence with WREN set
+	if (!EECON1bits.WREN || unlock_prev != 0x55 || sim_EECON2.reg != 0xAA ||
+		EECON1bits.EEPGD || EECON1bits.CFGS)
+	{
+		fprintf(stderr, "sim: EEPROM write at 0x%02X without unlock sequence ignored\n", EEADR);
+		EECON1bits.WR = 0;
+		return;
+	}
+
+	write_addr = EEADR;
+	write_data = sim_EEDATA.reg;
+	write_done = sim_now + SIM_EEPROM_WRITE_TCY;
+
+	// The sequence must be repeated for every byte
+	sim_EECON2.reg = 0;
+	unlock_prev = 0;
+}
+
+void sim_eeprom_advance(void)
+{
+	if (write_done == SIM_NEVER || sim_now < write_done)
+	{
+		return;
+	}
+
+	memory[write_addr] = write_data;
+	sim_eeprom_writes++;
+	write_done = SIM_NEVER;
+	EECON1bits.WR = 0;
+	PIR2bits.EEIF = 1;
+}
+
+sim_time_t sim_eeprom_next_event(void)
+{
+	return write_done;
+}
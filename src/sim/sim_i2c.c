@@ -0,0 +1,294 @@
+/**
+ * @file sim_i2c.c
+ * @brief MSSP2 I2C master model and bus for the host-side simulator.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * The firmware requests bus actions exactly as on the PIC18: by setting
+ * SEN/RSEN/PEN/RCEN/ACKEN or writing SSP2BUF. Each action completes after
+ * the number of SCL periods it takes on the wire (SCL period = SSP2ADD + 1
+ * Tcy), then clears its request bit and raises SSP2IF.
+ *
+ * Two wiring faults can be injected: a detached sensor (nothing ACKs,
+ * reads float high) and a slave holding SDA low, as after a reset in the
+ * middle of a read. While SDA is stuck every START/RESTART/STOP ends in a
+ * bus collision (BCL2IF, no SSP2IF); the slave lets go once SCL has been
+ * clocked SIM_I2C_STUCK_CLOCKS times with SSP2 disabled.
+ */
+
+#include "./sim.h"
+
+// In-flight master action
+#define I2C_SIM_IDLE     0
+#define I2C_SIM_START    1
+#define I2C_SIM_RESTART  2
+#define I2C_SIM_STOP     3
+#define I2C_SIM_TX       4
+#define I2C_SIM_RX       5
+#define I2C_SIM_ACK      6
+
+sim_i2c_stats_t sim_i2c_stats;
+
+static sim_mpu6050_t* slaves[SIM_I2C_MAX_SLAVES];
+static unsigned slave_count = 0;
+
+static uint8_t ssp2buf = 0;         // SSP2BUF storage
+static uint8_t tx_pending = 0;      // Firmware wrote SSP2BUF
+static int action = I2C_SIM_IDLE;
+static sim_time_t action_done = SIM_NEVER;
+
+// Fault injection
+static sim_time_t detach_from = SIM_NEVER;
+static sim_time_t detach_to = SIM_NEVER;
+static sim_time_t stuck_at = SIM_NEVER;
+static int sda_stuck = 0;
+static int scl_level = 1;
+static unsigned scl_pulses = 0;
+
+void sim_i2c_fault(double detach_from_ms, double detach_to_ms, double stuck_at_ms)
+{
+	if (detach_from_ms >= 0.0)
+	{
+		detach_from = (sim_time_t)(detach_from_ms * SIM_TCY_PER_MS);
+		detach_to = (sim_time_t)(detach_to_ms * SIM_TCY_PER_MS);
+	}
+	if (stuck_at_ms >= 0.0)
+	{
+		stuck_at = (sim_time_t)(stuck_at_ms * SIM_TCY_PER_MS);
+	}
+}
+
+static int sim_i2c_detached(void)
+{
+	return sim_now >= detach_from && sim_now < detach_to;
+}
+
+/**
+ * @brief Drive RD0/RD1 (SCL2/SDA2) and watch for recovery clocks while SSP2 is off.
+ */
+static void sim_i2c_pins(void)
+{
+	int scl = TRISDbits.TRISD0 ? 1 : LATDbits.LATD0;
+	int sda = TRISDbits.TRISD1 ? 1 : LATDbits.LATD1;
+	unsigned i;
+	
+	if (!sda_stuck && sim_now >= stuck_at)
+	{
+		sda_stuck = 1;
+		stuck_at = SIM_NEVER;
+		scl_pulses = 0;
+	}
+	
+	if (SSP2CON1bits.SSPEN)
+	{
+		scl = 1;
+		sda = 1;
+	}
+	else if (scl && !scl_level && sda_stuck && ++scl_pulses >= SIM_I2C_STUCK_CLOCKS)
+	{
+		// The slave finishes its byte and releases SDA
+		sda_stuck = 0;
+		sim_i2c_stats.bus_clears++;
+		for (i = 0; i < slave_count; i++)
+		{
+			sim_mpu6050_i2c_stop(slaves[i]);
+		}
+	}
+	scl_level = scl;
+	
+	PORTDbits.RD0 = scl;
+	PORTDbits.RD1 = sda_stuck ? 0 : sda;
+}
+
+void sim_i2c_attach(sim_mpu6050_t* slave)
+{
+	if (slave_count < SIM_I2C_MAX_SLAVES)
+	{
+		slaves[slave_count++] = slave;
+	}
+}
+
+/**
+ * @brief Classify an SSP2BUF access at the time it happens.
+ *
+ * With BF set the firmware is collecting a received byte (read clears BF);
+ * otherwise it is loading a byte to transmit, so the transmit-in-progress
+ * status (R_NOT_W, BF) must be visible before the next instruction.
+ */
+volatile uint8_t* sim_ssp2buf_access(void)
+{
+	if (SSP2STATbits.BF)
+	{
+		SSP2STATbits.BF = 0;
+	}
+	else if (action == I2C_SIM_IDLE)
+	{
+		SSP2STATbits.R_NOT_W = 1;
+		SSP2STATbits.BF = 1;
+		tx_pending = 1;
+	}
+	else
+	{
+		SSP2CON1bits.WCOL = 1;
+	}
+	return (volatile uint8_t*)&ssp2buf;
+}
+
+static sim_time_t sim_i2c_bit_tcy(void)
+{
+	return (sim_time_t)SSP2ADD + 1;
+}
+
+static void sim_i2c_begin(int what, unsigned bits)
+{
+	action = what;
+	action_done = sim_now + bits * sim_i2c_bit_tcy();
+}
+
+/**
+ * @brief Pick up a new request from the control bits or SSP2BUF.
+ */
+void sim_i2c_sync(void)
+{
+	sim_i2c_pins();
+	
+	// Disabling SSP2 abandons whatever was on the bus
+	if (!SSP2CON1bits.SSPEN)
+	{
+		action = I2C_SIM_IDLE;
+		action_done = SIM_NEVER;
+		tx_pending = 0;
+		return;
+	}
+	
+	if (SSP2CON1bits.SSPM != 0x08 || action != I2C_SIM_IDLE)
+	{
+		return;
+	}
+	
+	if (tx_pending)
+	{
+		tx_pending = 0;
+		sim_i2c_begin(I2C_SIM_TX, 9);
+	}
+	else if (SSP2CON2bits.SEN)
+	{
+		sim_i2c_begin(I2C_SIM_START, 1);
+	}
+	else if (SSP2CON2bits.RSEN)
+	{
+		sim_i2c_begin(I2C_SIM_RESTART, 2);
+	}
+	else if (SSP2CON2bits.PEN)
+	{
+		sim_i2c_begin(I2C_SIM_STOP, 1);
+	}
+	else if (SSP2CON2bits.RCEN)
+	{
+		sim_i2c_begin(I2C_SIM_RX, 8);
+	}
+	else if (SSP2CON2bits.ACKEN)
+	{
+		sim_i2c_begin(I2C_SIM_ACK, 1);
+	}
+}
+
+/**
+ * @brief Complete the in-flight action if it is due.
+ */
+void sim_i2c_advance(void)
+{
+	unsigned i;
+	int acked;
+	uint8_t byte;
+	
+	if (action == I2C_SIM_IDLE || sim_now < action_done)
+	{
+		return;
+	}
+	
+	sim_i2c_pins();
+	if (sda_stuck && (action == I2C_SIM_START || action == I2C_SIM_RESTART || action == I2C_SIM_STOP))
+	{
+		// SDA low where the master expects it high: bus collision
+		SSP2CON2bits.SEN = 0;
+		SSP2CON2bits.RSEN = 0;
+		SSP2CON2bits.PEN = 0;
+		PIR3bits.BCL2IF = 1;
+		sim_i2c_stats.collisions++;
+		action = I2C_SIM_IDLE;
+		action_done = SIM_NEVER;
+		return;
+	}
+	
+	switch (action)
+	{
+		case I2C_SIM_START:
+		case I2C_SIM_RESTART:
+			SSP2CON2bits.SEN = 0;
+			SSP2CON2bits.RSEN = 0;
+			SSP2STATbits.S = 1;
+			SSP2STATbits.P = 0;
+			sim_i2c_stats.starts++;
+			for (i = 0; i < slave_count && !sim_i2c_detached(); i++)
+			{
+				sim_mpu6050_i2c_start(slaves[i]);
+			}
+			break;
+			
+		case I2C_SIM_STOP:
+			SSP2CON2bits.PEN = 0;
+			SSP2STATbits.S = 0;
+			SSP2STATbits.P = 1;
+			for (i = 0; i < slave_count && !sim_i2c_detached(); i++)
+			{
+				sim_mpu6050_i2c_stop(slaves[i]);
+			}
+			break;
+			
+		case I2C_SIM_TX:
+			// A stuck SDA reads as an ACK; a detached bus as a NACK
+			acked = sda_stuck;
+			for (i = 0; i < slave_count && !sda_stuck && !sim_i2c_detached(); i++)
+			{
+				acked |= sim_mpu6050_i2c_write(slaves[i], ssp2buf);
+			}
+			SSP2STATbits.R_NOT_W = 0;
+			SSP2STATbits.BF = 0;
+			SSP2CON2bits.ACKSTAT = acked ? 0 : 1;
+			sim_i2c_stats.bytes_written++;
+			if (!acked)
+			{
+				sim_i2c_stats.nacks++;
+			}
+			break;
+			
+		case I2C_SIM_RX:
+			// Nobody driving SDA reads as 0xFF (pull-ups), a stuck one as 0x00
+			ssp2buf = sda_stuck ? 0x00 : 0xFF;
+			for (i = 0; i < slave_count && !sda_stuck && !sim_i2c_detached(); i++)
+			{
+				if (sim_mpu6050_i2c_read(slaves[i], &byte))
+				{
+					ssp2buf = byte;
+				}
+			}
+			SSP2CON2bits.RCEN = 0;
+			SSP2STATbits.BF = 1;
+			sim_i2c_stats.bytes_read++;
+			break;
+			
+		default:
+			SSP2CON2bits.ACKEN = 0;
+			break;
+	}
+	
+	action = I2C_SIM_IDLE;
+	action_done = SIM_NEVER;
+	PIR3bits.SSP2IF = 1;
+}
+
+sim_time_t sim_i2c_next_event(void)
+{
+	return action_done;
+}
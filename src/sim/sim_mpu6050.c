@@ -0,0 +1,385 @@
+/**
+ * @file sim_mpu6050.c
+ * @brief Register-level MPU-6050 I2C slave model for the host-side simulator.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Models the parts of the MPU-6050 the firmware uses: WHO_AM_I, power
+ * management, SMPLRT_DIV / CONFIG / GYRO_CONFIG / ACCEL_CONFIG, the data
+ * registers (0x3B-0x48), INT pin / INT_ENABLE / INT_STATUS and the FIFO.
+ * Samples are taken from the motion trace at the programmed sample rate.
+ */
+
+#include <string.h>
+#include "./sim.h"
+
+// Register map (subset)
+#define REG_SMPLRT_DIV    0x19
+#define REG_CONFIG        0x1A
+#define REG_GYRO_CONFIG   0x1B
+#define REG_ACCEL_CONFIG  0x1C
+#define REG_FIFO_EN       0x23
+#define REG_INT_PIN_CFG   0x37
+#define REG_INT_ENABLE    0x38
+#define REG_INT_STATUS    0x3A
+#define REG_ACCEL_XOUT_H  0x3B
+#define REG_TEMP_OUT_H    0x41
+#define REG_GYRO_XOUT_H   0x43
+#define REG_USER_CTRL     0x6A
+#define REG_PWR_MGMT_1    0x6B
+#define REG_FIFO_COUNTH   0x72
+#define REG_FIFO_COUNTL   0x73
+#define REG_FIFO_R_W      0x74
+#define REG_WHO_AM_I      0x75
+
+#define INT_DATA_RDY      0x01
+#define INT_FIFO_OFLOW    0x10
+#define PIN_CFG_LEVEL     0x80   // INT active low
+#define PIN_CFG_LATCH     0x20   // INT held until cleared
+#define USER_FIFO_EN      0x40
+#define USER_FIFO_RESET   0x04
+#define PWR_DEVICE_RESET  0x80
+#define PWR_SLEEP         0x40
+
+#define INT_PULSE_TCY     200    // 50 us data-ready pulse
+
+// Slave protocol states
+#define BUS_IDLE          0
+#define BUS_ADDRESS       1      // Next byte is the address
+#define BUS_REGISTER      2      // Next byte is the register pointer
+#define BUS_WRITE         3      // Register data follows
+#define BUS_READ          4      // Selected for reading
+#define BUS_IGNORE        5      // Address did not match
+
+static void sim_mpu6050_reset(sim_mpu6050_t* mpu)
+{
+	memset(mpu->regs, 0, sizeof(mpu->regs));
+	mpu->regs[REG_PWR_MGMT_1] = PWR_SLEEP;
+	mpu->regs[REG_WHO_AM_I] = 0x68;
+	mpu->fifo_head = 0;
+	mpu->fifo_count = 0;
+	mpu->reg_ptr = 0;
+	mpu->next_sample = SIM_NEVER;
+	mpu->int_until = 0;
+	mpu->int_latched = 0;
+}
+
+void sim_mpu6050_init(sim_mpu6050_t* mpu, uint8_t address, const sim_trace_t* trace)
+{
+	memset(mpu, 0, sizeof(*mpu));
+	mpu->address = address;
+	mpu->trace = trace;
+	mpu->bus_state = BUS_IDLE;
+	sim_mpu6050_reset(mpu);
+}
+
+/**
+ * @brief Sample period in Tcy from SMPLRT_DIV and DLPF_CFG.
+ */
+static sim_time_t sim_mpu6050_sample_period(const sim_mpu6050_t* mpu)
+{
+	uint8_t dlpf = mpu->regs[REG_CONFIG] & 0x07;
+	unsigned long gyro_rate_hz = (dlpf == 0 || dlpf == 7) ? 8000UL : 1000UL;
+	
+	return ((sim_time_t)(SIM_FOSC_HZ / 4UL) * (mpu->regs[REG_SMPLRT_DIV] + 1UL)) / gyro_rate_hz;
+}
+
+/**
+ * @brief Re-phase the sample clock after a configuration change.
+ */
+static void sim_mpu6050_restart_clock(sim_mpu6050_t* mpu)
+{
+	if (mpu->regs[REG_PWR_MGMT_1] & PWR_SLEEP)
+	{
+		mpu->next_sample = SIM_NEVER;
+	}
+	else
+	{
+		mpu->next_sample = sim_now + sim_mpu6050_sample_period(mpu);
+	}
+}
+
+static void sim_mpu6050_put16(uint8_t* dst, double value)
+{
+	long v = (long)(value >= 0.0 ? value + 0.5 : value - 0.5);
+	
+	if (v > 32767)
+	{
+		v = 32767;
+	}
+	if (v < -32768)
+	{
+		v = -32768;
+	}
+	dst[0] = (uint8_t)((uint16_t)v >> 8);
+	dst[1] = (uint8_t)((uint16_t)v & 0xFF);
+}
+
+static void sim_mpu6050_fifo_push(sim_mpu6050_t* mpu, const uint8_t* bytes, unsigned n)
+{
+	unsigned i;
+	
+	for (i = 0; i < n; i++)
+	{
+		if (mpu->fifo_count == SIM_MPU_FIFO_SIZE)
+		{
+			// Oldest byte is dropped on overflow
+			mpu->fifo_head = (mpu->fifo_head + 1) % SIM_MPU_FIFO_SIZE;
+			mpu->fifo_count--;
+			if (!(mpu->regs[REG_INT_STATUS] & INT_FIFO_OFLOW))
+			{
+				mpu->overflows++;
+			}
+			mpu->regs[REG_INT_STATUS] |= INT_FIFO_OFLOW;
+		}
+		mpu->fifo[(mpu->fifo_head + mpu->fifo_count) % SIM_MPU_FIFO_SIZE] = bytes[i];
+		mpu->fifo_count++;
+	}
+}
+
+static void sim_mpu6050_raise_int(sim_mpu6050_t* mpu, uint8_t status_bits)
+{
+	mpu->regs[REG_INT_STATUS] |= status_bits;
+	
+	if (mpu->regs[REG_INT_ENABLE] & status_bits)
+	{
+		if (mpu->regs[REG_INT_PIN_CFG] & PIN_CFG_LATCH)
+		{
+			mpu->int_latched = 1;
+		}
+		else
+		{
+			mpu->int_until = sim_now + INT_PULSE_TCY;
+		}
+	}
+}
+
+/**
+ * @brief Take one sample from the trace into the data registers and FIFO.
+ */
+static void sim_mpu6050_sample(sim_mpu6050_t* mpu)
+{
+	sim_trace_point_t p;
+	double gyro_lsb = 131.0 / (double)(1 << ((mpu->regs[REG_GYRO_CONFIG] >> 3) & 0x03));
+	double accel_lsb = 16384.0 / (double)(1 << ((mpu->regs[REG_ACCEL_CONFIG] >> 3) & 0x03));
+	uint8_t* r = mpu->regs;
+	uint8_t fifo_en = r[REG_FIFO_EN];
+	uint8_t overflow_before = r[REG_INT_STATUS] & INT_FIFO_OFLOW;
+	int axis;
+	
+	sim_trace_sample(mpu->trace, (double)sim_now / SIM_TCY_PER_MS, &p);
+	
+	for (axis = 0; axis < 3; axis++)
+	{
+		sim_mpu6050_put16(&r[REG_ACCEL_XOUT_H + 2 * axis], p.accel[axis] * accel_lsb);
+		sim_mpu6050_put16(&r[REG_GYRO_XOUT_H + 2 * axis],
+						  (p.gyro[axis] + mpu->gyro_bias_dps[axis]) * gyro_lsb);
+	}
+	sim_mpu6050_put16(&r[REG_TEMP_OUT_H], (p.temp_c - 36.53) * 340.0);
+	
+	// FIFO frames follow register order: accel, temp, gyro X/Y/Z
+	if (r[REG_USER_CTRL] & USER_FIFO_EN)
+	{
+		if (fifo_en & 0x08)
+		{
+			sim_mpu6050_fifo_push(mpu, &r[REG_ACCEL_XOUT_H], 6);
+		}
+		if (fifo_en & 0x80)
+		{
+			sim_mpu6050_fifo_push(mpu, &r[REG_TEMP_OUT_H], 2);
+		}
+		if (fifo_en & 0x40)
+		{
+			sim_mpu6050_fifo_push(mpu, &r[REG_GYRO_XOUT_H], 2);
+		}
+		if (fifo_en & 0x20)
+		{
+			sim_mpu6050_fifo_push(mpu, &r[REG_GYRO_XOUT_H + 2], 2);
+		}
+		if (fifo_en & 0x10)
+		{
+			sim_mpu6050_fifo_push(mpu, &r[REG_GYRO_XOUT_H + 4], 2);
+		}
+	}
+	
+	mpu->samples++;
+	sim_mpu6050_raise_int(mpu, INT_DATA_RDY);
+	if (!overflow_before && (r[REG_INT_STATUS] & INT_FIFO_OFLOW))
+	{
+		sim_mpu6050_raise_int(mpu, INT_FIFO_OFLOW);
+	}
+}
+
+void sim_mpu6050_advance(sim_mpu6050_t* mpu)
+{
+	while (mpu->next_sample != SIM_NEVER && sim_now >= mpu->next_sample)
+	{
+		sim_mpu6050_sample(mpu);
+		mpu->next_sample += sim_mpu6050_sample_period(mpu);
+	}
+}
+
+sim_time_t sim_mpu6050_next_event(const sim_mpu6050_t* mpu)
+{
+	sim_time_t next = mpu->next_sample;
+	
+	if (mpu->int_until > sim_now && mpu->int_until < next)
+	{
+		next = mpu->int_until;
+	}
+	return next;
+}
+
+uint8_t sim_mpu6050_int_pin(const sim_mpu6050_t* mpu)
+{
+	uint8_t active = mpu->int_latched || (sim_now < mpu->int_until);
+	
+	return (mpu->regs[REG_INT_PIN_CFG] & PIN_CFG_LEVEL) ? !active : active;
+}
+
+/**
+ * @brief Register write with side effects.
+ */
+static void sim_mpu6050_write_reg(sim_mpu6050_t* mpu, uint8_t reg, uint8_t value)
+{
+	switch (reg)
+	{
+		case REG_PWR_MGMT_1:
+			if (value & PWR_DEVICE_RESET)
+			{
+				sim_mpu6050_reset(mpu);
+				return;
+			}
+			mpu->regs[reg] = value;
+			sim_mpu6050_restart_clock(mpu);
+			break;
+			
+		case REG_SMPLRT_DIV:
+		case REG_CONFIG:
+			mpu->regs[reg] = value;
+			sim_mpu6050_restart_clock(mpu);
+			break;
+			
+		case REG_USER_CTRL:
+			if (value & USER_FIFO_RESET)
+			{
+				mpu->fifo_head = 0;
+				mpu->fifo_count = 0;
+			}
+			mpu->regs[reg] = value & (uint8_t)~USER_FIFO_RESET;
+			break;
+			
+		case REG_FIFO_R_W:
+			sim_mpu6050_fifo_push(mpu, &value, 1);
+			break;
+			
+		case REG_INT_STATUS:
+		case REG_FIFO_COUNTH:
+		case REG_FIFO_COUNTL:
+		case REG_WHO_AM_I:
+			// Read-only
+			break;
+			
+		default:
+			if (reg >= REG_ACCEL_XOUT_H && reg <= REG_GYRO_XOUT_H + 5)
+			{
+				break;   // Sensor data is read-only
+			}
+			mpu->regs[reg] = value;
+			break;
+	}
+}
+
+/**
+ * @brief Register read with side effects.
+ */
+static uint8_t sim_mpu6050_read_reg(sim_mpu6050_t* mpu, uint8_t reg)
+{
+	uint8_t value;
+	
+	switch (reg)
+	{
+		case REG_INT_STATUS:
+			value = mpu->regs[reg];
+			mpu->regs[reg] = 0;
+			mpu->int_latched = 0;
+			return value;
+			
+		case REG_FIFO_COUNTH:
+			return (uint8_t)(mpu->fifo_count >> 8);
+			
+		case REG_FIFO_COUNTL:
+			return (uint8_t)(mpu->fifo_count & 0xFF);
+			
+		case REG_FIFO_R_W:
+			if (mpu->fifo_count == 0)
+			{
+				return 0;
+			}
+			value = mpu->fifo[mpu->fifo_head];
+			mpu->fifo_head = (mpu->fifo_head + 1) % SIM_MPU_FIFO_SIZE;
+			mpu->fifo_count--;
+			return value;
+			
+		default:
+			return mpu->regs[reg];
+	}
+}
+
+static void sim_mpu6050_next_reg(sim_mpu6050_t* mpu)
+{
+	if (mpu->reg_ptr != REG_FIFO_R_W)
+	{
+		mpu->reg_ptr = (mpu->reg_ptr + 1) & 0x7F;
+	}
+}
+
+void sim_mpu6050_i2c_start(sim_mpu6050_t* mpu)
+{
+	mpu->bus_state = BUS_ADDRESS;
+}
+
+void sim_mpu6050_i2c_stop(sim_mpu6050_t* mpu)
+{
+	mpu->bus_state = BUS_IDLE;
+}
+
+int sim_mpu6050_i2c_write(sim_mpu6050_t* mpu, uint8_t byte)
+{
+	switch (mpu->bus_state)
+	{
+		case BUS_ADDRESS:
+			if ((byte >> 1) != mpu->address)
+			{
+				mpu->bus_state = BUS_IGNORE;
+				return 0;
+			}
+			mpu->bus_state = (byte & 0x01) ? BUS_READ : BUS_REGISTER;
+			return 1;
+			
+		case BUS_REGISTER:
+			mpu->reg_ptr = byte & 0x7F;
+			mpu->bus_state = BUS_WRITE;
+			return 1;
+			
+		case BUS_WRITE:
+			sim_mpu6050_write_reg(mpu, mpu->reg_ptr, byte);
+			sim_mpu6050_next_reg(mpu);
+			return 1;
+			
+		default:
+			return 0;
+	}
+}
+
+int sim_mpu6050_i2c_read(sim_mpu6050_t* mpu, uint8_t* byte)
+{
+	if (mpu->bus_state != BUS_READ)
+	{
+		return 0;
+	}
+	
+	*byte = sim_mpu6050_read_reg(mpu, mpu->reg_ptr);
+	sim_mpu6050_next_reg(mpu);
+	return 1;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file sim_sfr.h
+ * @brief Simulated PIC18F45K22 special function registers for host builds.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Included through hal.h when the firmware is compiled with gcc. Every SFR
+ * the drivers use is a byte/bit-field union with the same NAME and
+ * NAMEbits spelling as <xc.h>, so driver code compiles unchanged. The
+ * simulator (sim.c) looks at the register file at every sync point
+ * (HAL_SPIN(), SLEEP()) and applies the peripheral side effects.
+ */
+#ifndef SIM_SFR_H
+#define SIM_SFR_H
+
+#include <stdint.h>
+
+#define SIM_BIT(n)       unsigned char n : 1;
+#define SIM_FIELD(n, w)  unsigned char n : w;
+#define SIM_PAD(w)       unsigned char : w;
+
+#define SIM_SFR(name, fields) \
+    typedef union { uint8_t reg; struct { fields } bits; } sim_##name##_t; \
+    extern volatile sim_##name##_t sim_##name
+
+// Plain byte registers (no bit names needed)
+#define SIM_REG(name) \
+    typedef union { uint8_t reg; struct { SIM_FIELD(value, 8) } bits; } sim_##name##_t; \
+    extern volatile sim_##name##_t sim_##name
+
+/* ---------------------------------------------------------------------
+ * Register file
+ * ------------------------------------------------------------------ */
+
+// MSSP2 (I2C master)
+SIM_SFR(SSP2CON1, SIM_FIELD(SSPM, 4) SIM_BIT(CKP) SIM_BIT(SSPEN) SIM_BIT(SSPOV) SIM_BIT(WCOL));
+SIM_SFR(SSP2CON2, SIM_BIT(SEN) SIM_BIT(RSEN) SIM_BIT(PEN) SIM_BIT(RCEN)
+                  SIM_BIT(ACKEN) SIM_BIT(ACKDT) SIM_BIT(ACKSTAT) SIM_BIT(GCEN));
+SIM_SFR(SSP2STAT, SIM_BIT(BF) SIM_BIT(UA) SIM_BIT(R_NOT_W) SIM_BIT(S)
+                  SIM_BIT(P) SIM_BIT(D_NOT_A) SIM_BIT(CKE) SIM_BIT(SMP));
+SIM_REG(SSP2ADD);
+
+// Interrupt control
+SIM_SFR(INTCON,  SIM_BIT(RBIF) SIM_BIT(INT0IF) SIM_BIT(TMR0IF) SIM_BIT(RBIE)
+                 SIM_BIT(INT0IE) SIM_BIT(TMR0IE) SIM_BIT(PEIE) SIM_BIT(GIE));
+SIM_SFR(INTCON2, SIM_BIT(RBIP) SIM_PAD(1) SIM_BIT(TMR0IP) SIM_PAD(1)
+                 SIM_BIT(INTEDG2) SIM_BIT(INTEDG1) SIM_BIT(INTEDG0) SIM_BIT(RBPU));
+SIM_SFR(INTCON3, SIM_BIT(INT1IF) SIM_BIT(INT2IF) SIM_PAD(1) SIM_BIT(INT1IE)
+                 SIM_BIT(INT2IE) SIM_PAD(1) SIM_BIT(INT1IP) SIM_BIT(INT2IP));
+SIM_SFR(RCON,    SIM_BIT(BOR) SIM_BIT(POR) SIM_BIT(PD) SIM_BIT(TO)
+                 SIM_BIT(RI) SIM_PAD(1) SIM_BIT(SBOREN) SIM_BIT(IPEN));
+SIM_SFR(PIR1, SIM_BIT(TMR1IF) SIM_BIT(TMR2IF) SIM_BIT(CCP1IF) SIM_BIT(SSP1IF)
+              SIM_BIT(TX1IF) SIM_BIT(RC1IF) SIM_BIT(ADIF) SIM_PAD(1));
+SIM_SFR(PIE1, SIM_BIT(TMR1IE) SIM_BIT(TMR2IE) SIM_BIT(CCP1IE) SIM_BIT(SSP1IE)
+              SIM_BIT(TX1IE) SIM_BIT(RC1IE) SIM_BIT(ADIE) SIM_PAD(1));
+SIM_SFR(PIR2, SIM_BIT(CCP2IF) SIM_BIT(TMR3IF) SIM_BIT(HLVDIF) SIM_BIT(BCL1IF)
+              SIM_BIT(EEIF) SIM_PAD(1) SIM_BIT(C1IF) SIM_BIT(OSCFIF));
+SIM_SFR(PIE2, SIM_BIT(CCP2IE) SIM_BIT(TMR3IE) SIM_BIT(HLVDIE) SIM_BIT(BCL1IE)
+              SIM_BIT(EEIE) SIM_PAD(1) SIM_BIT(C1IE) SIM_BIT(OSCFIE));
+SIM_SFR(PIR3, SIM_BIT(CCP3IF) SIM_BIT(TMR5GIF) SIM_BIT(TMR3GIF) SIM_BIT(TMR1GIF)
+              SIM_BIT(RC2IF) SIM_BIT(TX2IF) SIM_BIT(BCL2IF) SIM_BIT(SSP2IF));
+SIM_SFR(PIE3, SIM_BIT(CCP3IE) SIM_BIT(TMR5GIE) SIM_BIT(TMR3GIE) SIM_BIT(TMR1GIE)
+              SIM_BIT(RC2IE) SIM_BIT(TX2IE) SIM_BIT(BCL2IE) SIM_BIT(SSP2IE));
+SIM_SFR(PIR5, SIM_BIT(TMR4IF) SIM_BIT(TMR5IF) SIM_BIT(TMR6IF) SIM_PAD(5));
+SIM_SFR(PIE5, SIM_BIT(TMR4IE) SIM_BIT(TMR5IE) SIM_BIT(TMR6IE) SIM_PAD(5));
+
+// GPIO
+SIM_SFR(PORTA, SIM_BIT(RA0) SIM_BIT(RA1) SIM_BIT(RA2) SIM_BIT(RA3)
+               SIM_BIT(RA4) SIM_BIT(RA5) SIM_BIT(RA6) SIM_BIT(RA7));
+SIM_SFR(PORTB, SIM_BIT(RB0) SIM_BIT(RB1) SIM_BIT(RB2) SIM_BIT(RB3)
+               SIM_BIT(RB4) SIM_BIT(RB5) SIM_BIT(RB6) SIM_BIT(RB7));
+SIM_SFR(PORTC, SIM_BIT(RC0) SIM_BIT(RC1) SIM_BIT(RC2) SIM_BIT(RC3)
+               SIM_BIT(RC4) SIM_BIT(RC5) SIM_BIT(RC6) SIM_BIT(RC7));
+SIM_SFR(PORTD, SIM_BIT(RD0) SIM_BIT(RD1) SIM_BIT(RD2) SIM_BIT(RD3)
+               SIM_BIT(RD4) SIM_BIT(RD5) SIM_BIT(RD6) SIM_BIT(RD7));
+SIM_SFR(LATA,  SIM_BIT(LATA0) SIM_BIT(LATA1) SIM_BIT(LATA2) SIM_BIT(LATA3)
+               SIM_BIT(LATA4) SIM_BIT(LATA5) SIM_BIT(LATA6) SIM_BIT(LATA7));
+SIM_SFR(LATB,  SIM_BIT(LATB0) SIM_BIT(LATB1) SIM_BIT(LATB2) SIM_BIT(LATB3)
+               SIM_BIT(LATB4) SIM_BIT(LATB5) SIM_BIT(LATB6) SIM_BIT(LATB7));
+SIM_SFR(LATC,  SIM_BIT(LATC0) SIM_BIT(LATC1) SIM_BIT(LATC2) SIM_BIT(LATC3)
+               SIM_BIT(LATC4) SIM_BIT(LATC5) SIM_BIT(LATC6) SIM_BIT(LATC7));
+SIM_SFR(LATD,  SIM_BIT(LATD0) SIM_BIT(LATD1) SIM_BIT(LATD2) SIM_BIT(LATD3)
+               SIM_BIT(LATD4) SIM_BIT(LATD5) SIM_BIT(LATD6) SIM_BIT(LATD7));
+SIM_SFR(TRISA, SIM_BIT(TRISA0) SIM_BIT(TRISA1) SIM_BIT(TRISA2) SIM_BIT(TRISA3)
+               SIM_BIT(TRISA4) SIM_BIT(TRISA5) SIM_BIT(TRISA6) SIM_BIT(TRISA7));
+SIM_SFR(TRISB, SIM_BIT(TRISB0) SIM_BIT(TRISB1) SIM_BIT(TRISB2) SIM_BIT(TRISB3)
+               SIM_BIT(TRISB4) SIM_BIT(TRISB5) SIM_BIT(TRISB6) SIM_BIT(TRISB7));
+SIM_SFR(TRISC, SIM_BIT(TRISC0) SIM_BIT(TRISC1) SIM_BIT(TRISC2) SIM_BIT(TRISC3)
+               SIM_BIT(TRISC4) SIM_BIT(TRISC5) SIM_BIT(TRISC6) SIM_BIT(TRISC7));
+SIM_SFR(TRISD, SIM_BIT(TRISD0) SIM_BIT(TRISD1) SIM_BIT(TRISD2) SIM_BIT(TRISD3)
+               SIM_BIT(TRISD4) SIM_BIT(TRISD5) SIM_BIT(TRISD6) SIM_BIT(TRISD7));
+SIM_REG(ANSELA);
+SIM_REG(ANSELB);
+SIM_SFR(ANSELC, SIM_PAD(2) SIM_BIT(ANSC2) SIM_BIT(ANSC3) SIM_BIT(ANSC4)
+                SIM_BIT(ANSC5) SIM_BIT(ANSC6) SIM_BIT(ANSC7));
+SIM_REG(ANSELD);
+SIM_SFR(IOCB, SIM_PAD(4) SIM_BIT(IOCB4) SIM_BIT(IOCB5) SIM_BIT(IOCB6) SIM_BIT(IOCB7));
+SIM_REG(WPUB);
+
+// Oscillator
+SIM_SFR(OSCCON, SIM_FIELD(SCS, 2) SIM_BIT(HFIOFS) SIM_BIT(OSTS)
+                SIM_FIELD(IRCF, 3) SIM_BIT(IDLEN));
+
+// Timers
+SIM_SFR(T0CON, SIM_FIELD(T0PS, 3) SIM_BIT(PSA) SIM_BIT(T0SE) SIM_BIT(T0CS)
+               SIM_BIT(T08BIT) SIM_BIT(TMR0ON));
+SIM_REG(TMR0L);
+SIM_REG(TMR0H);
+SIM_SFR(T2CON, SIM_FIELD(T2CKPS, 2) SIM_BIT(TMR2ON) SIM_FIELD(T2OUTPS, 4) SIM_PAD(1));
+SIM_SFR(T4CON, SIM_FIELD(T4CKPS, 2) SIM_BIT(TMR4ON) SIM_FIELD(T4OUTPS, 4) SIM_PAD(1));
+SIM_SFR(T6CON, SIM_FIELD(T6CKPS, 2) SIM_BIT(TMR6ON) SIM_FIELD(T6OUTPS, 4) SIM_PAD(1));
+SIM_REG(TMR2);
+SIM_REG(TMR4);
+SIM_REG(TMR6);
+SIM_REG(PR2);
+SIM_REG(PR4);
+SIM_REG(PR6);
+
+// CCP / PWM
+SIM_SFR(CCP1CON, SIM_FIELD(CCP1M, 4) SIM_FIELD(DC1B, 2) SIM_FIELD(P1M, 2));
+SIM_SFR(CCP2CON, SIM_FIELD(CCP2M, 4) SIM_FIELD(DC2B, 2) SIM_FIELD(P2M, 2));
+SIM_SFR(CCP3CON, SIM_FIELD(CCP3M, 4) SIM_FIELD(DC3B, 2) SIM_FIELD(P3M, 2));
+SIM_SFR(CCP5CON, SIM_FIELD(CCP5M, 4) SIM_FIELD(DC5B, 2) SIM_PAD(2));
+SIM_REG(CCPR1L);
+SIM_REG(CCPR2L);
+SIM_REG(CCPR3L);
+SIM_REG(CCPR5L);
+SIM_REG(CCPTMRS0);
+SIM_REG(CCPTMRS1);
+
+// Data EEPROM
+SIM_SFR(EECON1, SIM_BIT(RD) SIM_BIT(WR) SIM_BIT(WREN) SIM_BIT(WRERR)
+                SIM_BIT(FREE) SIM_PAD(1) SIM_BIT(CFGS) SIM_BIT(EEPGD));
+SIM_REG(EECON2);
+SIM_REG(EEADR);
+SIM_REG(EEDATA);
+
+// EUSART1
+SIM_SFR(TXSTA1,   SIM_BIT(TX9D) SIM_BIT(TRMT) SIM_BIT(BRGH) SIM_BIT(SENDB)
+                  SIM_BIT(SYNC) SIM_BIT(TXEN) SIM_BIT(TX9) SIM_BIT(CSRC));
+SIM_SFR(RCSTA1,   SIM_BIT(RX9D) SIM_BIT(OERR) SIM_BIT(FERR) SIM_BIT(ADDEN)
+                  SIM_BIT(CREN) SIM_BIT(SREN) SIM_BIT(RX9) SIM_BIT(SPEN));
+SIM_SFR(BAUDCON1, SIM_BIT(ABDEN) SIM_BIT(WUE) SIM_PAD(1) SIM_BIT(BRG16)
+                  SIM_BIT(CKTXP) SIM_BIT(DTRXP) SIM_BIT(RCIDL) SIM_BIT(ABDOVF));
+SIM_REG(SPBRG1);
+SIM_REG(SPBRGH1);
+SIM_REG(TXREG1);
+SIM_REG(RCREG1);
+
+// X-macro list used by sim.c to allocate the register file
+#define SIM_SFR_LIST(X) \
+    X(SSP2CON1) X(SSP2CON2) X(SSP2STAT) X(SSP2ADD) \
+    X(INTCON) X(INTCON2) X(INTCON3) X(RCON) \
+    X(PIR1) X(PIE1) X(PIR2) X(PIE2) X(PIR3) X(PIE3) X(PIR5) X(PIE5) \
+    X(PORTA) X(PORTB) X(PORTC) X(PORTD) X(LATA) X(LATB) X(LATC) X(LATD) \
+    X(TRISA) X(TRISB) X(TRISC) X(TRISD) X(ANSELA) X(ANSELB) X(ANSELC) X(ANSELD) \
+    X(IOCB) X(WPUB) \
+    X(OSCCON) X(T0CON) X(TMR0L) X(TMR0H) \
+    X(T2CON) X(T4CON) X(T6CON) X(TMR2) X(TMR4) X(TMR6) X(PR2) X(PR4) X(PR6) \
+    X(CCP1CON) X(CCP2CON) X(CCP3CON) X(CCP5CON) \
+    X(CCPR1L) X(CCPR2L) X(CCPR3L) X(CCPR5L) X(CCPTMRS0) X(CCPTMRS1) \
+    X(EECON1) X(EECON2) X(EEADR) X(EEDATA) \
+    X(TXSTA1) X(RCSTA1) X(BAUDCON1) X(SPBRG1) X(SPBRGH1) X(TXREG1) X(RCREG1)
+
+/* ---------------------------------------------------------------------
+ * XC8 spellings
+ * ------------------------------------------------------------------ */
+
+#define SSP2CON1     sim_SSP2CON1.reg
+#define SSP2CON1bits sim_SSP2CON1.bits
+#define SSP2CON2     sim_SSP2CON2.reg
+#define SSP2CON2bits sim_SSP2CON2.bits
+#define SSP2STAT     sim_SSP2STAT.reg
+#define SSP2STATbits sim_SSP2STAT.bits
+#define SSP2ADD      sim_SSP2ADD.reg
+
+// Buffer accesses are tracked: a write starts a transmit, a read clears BF
+#define SSP2BUF      (*sim_ssp2buf_access())
+
+#define INTCON       sim_INTCON.reg
+#define INTCONbits   sim_INTCON.bits
+#define INTCON2      sim_INTCON2.reg
+#define INTCON2bits  sim_INTCON2.bits
+#define INTCON3      sim_INTCON3.reg
+#define INTCON3bits  sim_INTCON3.bits
+#define RCON         sim_RCON.reg
+#define RCONbits     sim_RCON.bits
+#define PIR1         sim_PIR1.reg
+#define PIR1bits     sim_PIR1.bits
+#define PIE1         sim_PIE1.reg
+#define PIE1bits     sim_PIE1.bits
+#define PIR2         sim_PIR2.reg
+#define PIR2bits     sim_PIR2.bits
+#define PIE2         sim_PIE2.reg
+#define PIE2bits     sim_PIE2.bits
+#define PIR3         sim_PIR3.reg
+#define PIR3bits     sim_PIR3.bits
+#define PIE3         sim_PIE3.reg
+#define PIE3bits     sim_PIE3.bits
+#define PIR5         sim_PIR5.reg
+#define PIR5bits     sim_PIR5.bits
+#define PIE5         sim_PIE5.reg
+#define PIE5bits     sim_PIE5.bits
+
+#define PORTA        sim_PORTA.reg
+#define PORTAbits    sim_PORTA.bits
+#define PORTB        sim_PORTB.reg
+#define PORTBbits    sim_PORTB.bits
+#define PORTC        sim_PORTC.reg
+#define PORTCbits    sim_PORTC.bits
+#define PORTD        sim_PORTD.reg
+#define PORTDbits    sim_PORTD.bits
+#define LATA         sim_LATA.reg
+#define LATAbits     sim_LATA.bits
+#define LATB         sim_LATB.reg
+#define LATBbits     sim_LATB.bits
+#define LATC         sim_LATC.reg
+#define LATCbits     sim_LATC.bits
+#define LATD         sim_LATD.reg
+#define LATDbits     sim_LATD.bits
+#define TRISA        sim_TRISA.reg
+#define TRISAbits    sim_TRISA.bits
+#define TRISB        sim_TRISB.reg
+#define TRISBbits    sim_TRISB.bits
+#define TRISC        sim_TRISC.reg
+#define TRISCbits    sim_TRISC.bits
+#define TRISD        sim_TRISD.reg
+#define TRISDbits    sim_TRISD.bits
+#define ANSELA       sim_ANSELA.reg
+#define ANSELB       sim_ANSELB.reg
+#define ANSELC       sim_ANSELC.reg
+#define ANSELCbits   sim_ANSELC.bits
+#define ANSELD       sim_ANSELD.reg
+#define IOCB         sim_IOCB.reg
+#define IOCBbits     sim_IOCB.bits
+#define WPUB         sim_WPUB.reg
+
+#define OSCCON       sim_OSCCON.reg
+#define OSCCONbits   sim_OSCCON.bits
+
+#define T0CON        sim_T0CON.reg
+#define T0CONbits    sim_T0CON.bits
+#define TMR0L        sim_TMR0L.reg
+#define TMR0H        sim_TMR0H.reg
+#define T2CON        sim_T2CON.reg
+#define T2CONbits    sim_T2CON.bits
+#define T4CON        sim_T4CON.reg
+#define T4CONbits    sim_T4CON.bits
+#define T6CON        sim_T6CON.reg
+#define T6CONbits    sim_T6CON.bits
+#define TMR2         sim_TMR2.reg
+#define TMR4         sim_TMR4.reg
+#define TMR6         sim_TMR6.reg
+#define PR2          sim_PR2.reg
+#define PR4          sim_PR4.reg
+#define PR6          sim_PR6.reg
+
+#define CCP1CON      sim_CCP1CON.reg
+#define CCP1CONbits  sim_CCP1CON.bits
+#define CCP2CON      sim_CCP2CON.reg
+#define CCP2CONbits  sim_CCP2CON.bits
+#define CCP3CON      sim_CCP3CON.reg
+#define CCP3CONbits  sim_CCP3CON.bits
+#define CCP5CON      sim_CCP5CON.reg
+#define CCP5CONbits  sim_CCP5CON.bits
+#define CCPR1L       sim_CCPR1L.reg
+#define CCPR2L       sim_CCPR2L.reg
+#define CCPR3L       sim_CCPR3L.reg
+#define CCPR5L       sim_CCPR5L.reg
+#define CCPTMRS0     sim_CCPTMRS0.reg
+#define CCPTMRS1     sim_CCPTMRS1.reg
+
+#define EECON1       sim_EECON1.reg
+#define EECON1bits   sim_EECON1.bits
+#define EEADR        sim_EEADR.reg
+
+// The unlock sequence and read strobe are tracked per access
+#define EECON2       (*sim_eecon2_access())
+#define EEDATA       (*sim_eedata_access())
+
+#define TXSTA1       sim_TXSTA1.reg
+#define TXSTA1bits   sim_TXSTA1.bits
+#define RCSTA1       sim_RCSTA1.reg
+#define RCSTA1bits   sim_RCSTA1.bits
+#define BAUDCON1     sim_BAUDCON1.reg
+#define BAUDCON1bits sim_BAUDCON1.bits
+#define SPBRG1       sim_SPBRG1.reg
+#define SPBRGH1      sim_SPBRGH1.reg
+
+// A TXREG1 access is a write (starts a transmit), RCREG1 a read (pops the FIFO)
+#define TXREG1       (*sim_txreg1_access())
+#define RCREG1       (*sim_rcreg1_access())
+
+/* ---------------------------------------------------------------------
+ * Compiler intrinsics
+ * ------------------------------------------------------------------ */
+
+#define __interrupt(...)
+#define SLEEP()      sim_sleep()
+#define NOP()        sim_spin()
+#define CLRWDT()     ((void)0)
+
+/* ---------------------------------------------------------------------
+ * Simulator hooks (sim.c)
+ * ------------------------------------------------------------------ */
+
+// Busy-wait body: apply register side effects and advance a few cycles.
+void sim_spin(void);
+
+// Idle until an enabled interrupt flag is raised (IDLEN = 1 semantics).
+void sim_sleep(void);
+
+// Mark an SSP2BUF access and return the buffer register.
+volatile uint8_t* sim_ssp2buf_access(void);
+
+// Record an EECON2 access (unlock sequence) and return the register.
+volatile uint8_t* sim_eecon2_access(void);
+
+// Complete a pending RD strobe and return EEDATA.
+volatile uint8_t* sim_eedata_access(void);
+
+// Mark a TXREG1 write / pop the receive FIFO into RCREG1.
+volatile uint8_t* sim_txreg1_access(void);
+volatile uint8_t* sim_rcreg1_access(void);
+
+#endif // SIM_SFR_H
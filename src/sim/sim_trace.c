@@ -0,0 +1,198 @@
+/**
+ * @file sim_trace.c
+ * @brief Scripted motion trace for the host-side simulator.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "./sim.h"
+
+#define SIM_TRACE_DEFAULT_TEMP_C 25.0
+
+/**
+ * @brief Load a whitespace-separated trace file.
+ *
+ * Columns: time_ms gx gy gz [ax ay az [button [temp_c]]]. Missing accel
+ * defaults to 1 g on Z (flat and still), missing button to released and
+ * missing temperature to 25 deg C. Points must be in time order.
+ */
+int sim_trace_load(sim_trace_t* trace, const char* path)
+{
+	FILE* file;
+	char line[256];
+	size_t capacity = 0;
+	unsigned long line_no = 0;
+	
+	trace->points = NULL;
+	trace->count = 0;
+	
+	file = fopen(path, "r");
+	if (file == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+	
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		sim_trace_point_t p;
+		int fields;
+		
+		line_no++;
+		if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#')
+		{
+			continue;
+		}
+		
+		memset(&p, 0, sizeof(p));
+		p.accel[2] = 1.0;
+		p.temp_c = SIM_TRACE_DEFAULT_TEMP_C;
+		
+		fields = sscanf(line, "%lf %lf %lf %lf %lf %lf %lf %d %lf",
+						&p.t_ms, &p.gyro[0], &p.gyro[1], &p.gyro[2],
+						&p.accel[0], &p.accel[1], &p.accel[2],
+						&p.button, &p.temp_c);
+		if (fields < 4 || (fields > 4 && fields < 7))
+		{
+			fprintf(stderr, "%s:%lu: expected time_ms gx gy gz [ax ay az [button [temp_c]]]\n",
+					path, line_no);
+			fclose(file);
+			return -1;
+		}
+		
+		if (trace->count > 0 && p.t_ms < trace->points[trace->count - 1].t_ms)
+		{
+			fprintf(stderr, "%s:%lu: time goes backwards\n", path, line_no);
+			fclose(file);
+			return -1;
+		}
+		
+		if (trace->count == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			trace->points = realloc(trace->points, capacity * sizeof(*trace->points));
+			if (trace->points == NULL)
+			{
+				fclose(file);
+				return -1;
+			}
+		}
+		trace->points[trace->count++] = p;
+	}
+	
+	fclose(file);
+	
+	if (trace->count == 0)
+	{
+		fprintf(stderr, "%s: empty trace\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Index of the last point at or before t_ms (0 if before the first).
+ */
+static size_t sim_trace_find(const sim_trace_t* trace, double t_ms)
+{
+	size_t lo = 0;
+	size_t hi = trace->count;
+	
+	while (hi - lo > 1)
+	{
+		size_t mid = (lo + hi) / 2;
+		if (trace->points[mid].t_ms <= t_ms)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+/**
+ * @brief Interpolate motion at t_ms.
+ */
+void sim_trace_sample(const sim_trace_t* trace, double t_ms, sim_trace_point_t* out)
+{
+	const sim_trace_point_t* a;
+	const sim_trace_point_t* b;
+	double f;
+	size_t i;
+	int axis;
+	
+	if (trace == NULL || trace->count == 0)
+	{
+		memset(out, 0, sizeof(*out));
+		out->t_ms = t_ms;
+		out->accel[2] = 1.0;
+		out->temp_c = SIM_TRACE_DEFAULT_TEMP_C;
+		return;
+	}
+	
+	i = sim_trace_find(trace, t_ms);
+	a = &trace->points[i];
+	b = (i + 1 < trace->count) ? &trace->points[i + 1] : a;
+	
+	f = 0.0;
+	if (b->t_ms > a->t_ms && t_ms > a->t_ms)
+	{
+		f = (t_ms - a->t_ms) / (b->t_ms - a->t_ms);
+		if (f > 1.0)
+		{
+			f = 1.0;
+		}
+	}
+	
+	out->t_ms = t_ms;
+	for (axis = 0; axis < 3; axis++)
+	{
+		out->gyro[axis] = a->gyro[axis] + f * (b->gyro[axis] - a->gyro[axis]);
+		out->accel[axis] = a->accel[axis] + f * (b->accel[axis] - a->accel[axis]);
+	}
+	out->temp_c = a->temp_c + f * (b->temp_c - a->temp_c);
+	out->button = a->button;
+}
+
+/**
+ * @brief Button level at t_ms; the button is a step function of the trace.
+ */
+int sim_trace_button(const sim_trace_t* trace, double t_ms, double* next_change_ms)
+{
+	size_t i;
+	int level;
+	
+	*next_change_ms = -1.0;
+	if (trace == NULL || trace->count == 0)
+	{
+		return 0;
+	}
+	
+	i = sim_trace_find(trace, t_ms);
+	level = (trace->points[i].t_ms <= t_ms) ? trace->points[i].button : 0;
+	
+	for (i = i + 1; i < trace->count; i++)
+	{
+		if (trace->points[i].button != level)
+		{
+			*next_change_ms = trace->points[i].t_ms;
+			break;
+		}
+	}
+	return level;
+}
+
+double sim_trace_end_ms(const sim_trace_t* trace)
+{
+	if (trace == NULL || trace->count == 0)
+	{
+		return 0.0;
+	}
+	return trace->points[trace->count - 1].t_ms;
+}
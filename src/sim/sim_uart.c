@@ -0,0 +1,311 @@
+/**
+ * @file sim_uart.c
+ * @brief EUSART1 model for the host-side simulator.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ *
+ * Asynchronous mode only. A TXREG1 write moves to the shift register when
+ * it is idle, so TX1IF reflects an empty TXREG1 as on the part; each byte
+ * takes 10 bit times from the BRG settings. Received bytes enter a 2-deep
+ * FIFO; a third byte while it is full sets OERR and is lost.
+ *
+ * The line can be attached to a file or FIFO (TX only, RX from a second
+ * file) or to a pseudo-terminal, which the host decoder opens like a real
+ * serial port.
+ */
+
+#define _DEFAULT_SOURCE
+#define _XOPEN_SOURCE 600
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "./sim.h"
+
+#define SIM_UART_RX_POLL_TCY SIM_TCY_PER_MS   // Idle pty poll interval
+
+sim_uart_stats_t sim_uart_stats;
+
+static FILE* tx_file = NULL;
+static FILE* rx_file = NULL;
+static int pty_master = -1;
+static int pty_slave = -1;
+
+static uint8_t tx_pending = 0;       // Firmware wrote TXREG1 since the last sync
+static uint8_t txreg_full = 0;
+static uint8_t txreg = 0;
+static uint8_t tsr = 0;
+static sim_time_t tsr_done = SIM_NEVER;
+
+static uint8_t rx_fifo[2];
+static uint8_t rx_count = 0;
+static sim_time_t rx_next = SIM_NEVER;
+static int rx_armed = 0;
+
+/**
+ * @brief Instruction cycles per bit for the current BRG configuration.
+ */
+static sim_time_t sim_uart_bit_tcy(void)
+{
+	unsigned long brg;
+	unsigned divisor;
+
+	if (BAUDCON1bits.BRG16)
+	{
+		brg = ((unsigned long)SPBRGH1 << 8) | SPBRG1;
+		divisor = TXSTA1bits.BRGH ? 4 : 16;
+	}
+	else
+	{
+		brg = SPBRG1;
+		divisor = TXSTA1bits.BRGH ? 16 : 64;
+	}
+
+	// Baud = Fosc / (divisor * (brg + 1)); Tcy = 4 / Fosc
+	return (sim_time_t)(divisor * (brg + 1UL) / 4UL);
+}
+
+static sim_time_t sim_uart_byte_tcy(void)
+{
+	return 10 * sim_uart_bit_tcy();
+}
+
+int sim_uart_open(const char* tx_path, const char* rx_path)
+{
+	struct termios tio;
+
+	if (tx_path != NULL && strcmp(tx_path, "pty") == 0)
+	{
+		pty_master = posix_openpt(O_RDWR | O_NOCTTY);
+		if (pty_master < 0 || grantpt(pty_master) != 0 || unlockpt(pty_master) != 0)
+		{
+			perror("sim: posix_openpt");
+			return -1;
+		}
+
+		// Raw line discipline so TX bytes are not echoed back as RX; the
+		// slave stays open so writes never fail with EIO
+		pty_slave = open(ptsname(pty_master), O_RDWR | O_NOCTTY);
+		if (pty_slave >= 0 && tcgetattr(pty_slave, &tio) == 0)
+		{
+			cfmakeraw(&tio);
+			tcsetattr(pty_slave, TCSANOW, &tio);
+		}
+		fcntl(pty_master, F_SETFL, fcntl(pty_master, F_GETFL) | O_NONBLOCK);
+		fprintf(stderr, "sim: EUSART1 on %s\n", ptsname(pty_master));
+	}
+	else if (tx_path != NULL)
+	{
+		tx_file = fopen(tx_path, "wb");
+		if (tx_file == NULL)
+		{
+			perror(tx_path);
+			return -1;
+		}
+	}
+
+	if (rx_path != NULL)
+	{
+		rx_file = fopen(rx_path, "rb");
+		if (rx_file == NULL)
+		{
+			perror(rx_path);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void sim_uart_close(void)
+{
+	if (tx_file != NULL)
+	{
+		fclose(tx_file);
+		tx_file = NULL;
+	}
+	if (rx_file != NULL)
+	{
+		fclose(rx_file);
+		rx_file = NULL;
+	}
+	if (pty_master >= 0)
+	{
+		close(pty_master);
+		pty_master = -1;
+	}
+	if (pty_slave >= 0)
+	{
+		close(pty_slave);
+		pty_slave = -1;
+	}
+}
+
+volatile uint8_t* sim_txreg1_access(void)
+{
+	tx_pending = 1;
+	return &sim_TXREG1.reg;
+}
+
+volatile uint8_t* sim_rcreg1_access(void)
+{
+	if (rx_count > 0)
+	{
+		sim_RCREG1.reg = rx_fifo[0];
+		rx_fifo[0] = rx_fifo[1];
+		rx_count--;
+	}
+	PIR1bits.RC1IF = rx_count > 0;
+	return &sim_RCREG1.reg;
+}
+
+/**
+ * @brief Put a finished byte on the attached line.
+ */
+static void sim_uart_emit(uint8_t byte)
+{
+	sim_uart_stats.tx_bytes++;
+
+	if (tx_file != NULL)
+	{
+		fputc(byte, tx_file);
+	}
+	else if (pty_master >= 0)
+	{
+		if (write(pty_master, &byte, 1) != 1)
+		{
+			sim_uart_stats.tx_lost++;
+		}
+	}
+}
+
+/**
+ * @brief Fetch the next byte from the attached RX source.
+ * @return 1 and the byte, 0 if nothing now, -1 if the source is exhausted
+ */
+static int sim_uart_source(uint8_t* byte)
+{
+	int c;
+
+	if (rx_file != NULL)
+	{
+		c = fgetc(rx_file);
+		if (c == EOF)
+		{
+			return -1;
+		}
+		*byte = (uint8_t)c;
+		return 1;
+	}
+
+	if (pty_master >= 0)
+	{
+		ssize_t n = read(pty_master, byte, 1);
+		return (n == 1) ? 1 : 0;
+	}
+
+	return -1;
+}
+
+static void sim_uart_flags(void)
+{
+	TXSTA1bits.TRMT = (tsr_done == SIM_NEVER);
+	PIR1bits.TX1IF = (RCSTA1bits.SPEN && TXSTA1bits.TXEN) ? !txreg_full : 0;
+	PIR1bits.RC1IF = rx_count > 0;
+}
+
+void sim_uart_sync(void)
+{
+	if (tx_pending)
+	{
+		tx_pending = 0;
+		if (tsr_done == SIM_NEVER)
+		{
+			tsr = sim_TXREG1.reg;
+			tsr_done = sim_now + sim_uart_byte_tcy();
+		}
+		else
+		{
+			txreg = sim_TXREG1.reg;
+			txreg_full = 1;
+		}
+	}
+
+	// Clearing CREN resets an overrun
+	if (!RCSTA1bits.CREN)
+	{
+		RCSTA1bits.OERR = 0;
+	}
+
+	// Start feeding RX once the firmware has enabled the receiver
+	if (!rx_armed && RCSTA1bits.SPEN && RCSTA1bits.CREN && (rx_file != NULL || pty_master >= 0))
+	{
+		rx_armed = 1;
+		rx_next = sim_now + sim_uart_byte_tcy();
+	}
+
+	sim_uart_flags();
+}
+
+void sim_uart_advance(void)
+{
+	uint8_t byte;
+	int got;
+
+	if (tsr_done != SIM_NEVER && sim_now >= tsr_done)
+	{
+		sim_uart_emit(tsr);
+		if (txreg_full)
+		{
+			tsr = txreg;
+			txreg_full = 0;
+			tsr_done = sim_now + sim_uart_byte_tcy();
+		}
+		else
+		{
+			tsr_done = SIM_NEVER;
+		}
+	}
+
+	if (rx_next != SIM_NEVER && sim_now >= rx_next)
+	{
+		got = sim_uart_source(&byte);
+		if (got > 0)
+		{
+			sim_uart_stats.rx_bytes++;
+			if (!RCSTA1bits.SPEN || !RCSTA1bits.CREN || RCSTA1bits.OERR)
+			{
+				sim_uart_stats.rx_overruns++;
+			}
+			else if (rx_count >= 2)
+			{
+				RCSTA1bits.OERR = 1;
+				sim_uart_stats.rx_overruns++;
+			}
+			else
+			{
+				rx_fifo[rx_count++] = byte;
+			}
+			rx_next = sim_now + sim_uart_byte_tcy();
+		}
+		else if (got == 0)
+		{
+			rx_next = sim_now + SIM_UART_RX_POLL_TCY;
+		}
+		else
+		{
+			rx_next = SIM_NEVER;
+		}
+	}
+
+	sim_uart_flags();
+}
+
+sim_time_t sim_uart_next_event(void)
+{
+	return tsr_done < rx_next ? tsr_done : rx_next;
+}
@@ -6,49 +6,1113 @@
  */
 
 #include "../includes/accelerometer.h"
+#include "../includes/color_lut.h"
+#include "../includes/scheduler.h"
 
 // #include "./accelerometer.h"
 
-unsigned char accelerometer_initialized = 0;
+// Asynchronous read state
+#define GYRO_ASYNC_IDLE     0x00
+#define GYRO_ASYNC_PENDING  0x01
+#define GYRO_ASYNC_DONE     0x02
+#define GYRO_ASYNC_FAILED   0x03
+
+#define RANGE_NONE          0xFF  // No GYRO_CONFIG write in flight
+
+#if (ACC_RING_SIZE & (ACC_RING_SIZE - 1)) != 0 || ACC_RING_SIZE > 128
+#error "ACC_RING_SIZE must be a power of two no larger than 128"
+#endif
+#define RING_MASK (ACC_RING_SIZE - 1)
+
+// The calibration mean is kept in Q8: sum * 2^(8 - ACC_CAL_SHIFT)
+#if ACC_CAL_SHIFT > 8
+#error "ACC_CAL_SHIFT must be 8 or less"
+#endif
+
+typedef struct
+{
+	unsigned char dlpf_cfg;
+	unsigned char gyro_fs_sel;
+	unsigned int sample_rate_hz;
+} acc_profile_settings_t;
+
+// Indexed by acc_profile_t
+static const acc_profile_settings_t profiles[ACC_PROFILE_COUNT] =
+{
+	{ 1, ACC_GYRO_FS_1000, 500 },                                    // Low latency
+	{ ACC_DEFAULT_DLPF, ACC_DEFAULT_GYRO_FS, ACC_DEFAULT_SAMPLE_RATE_HZ },  // Balanced
+	{ 5, ACC_GYRO_FS_250, 100 }                                      // Smooth
+};
+
+// Sensors sampling on data-ready
+static accelerometer_t* data_ready_sensors[ACC_MAX_SENSORS];
+
+/**
+ * @brief Subtract the bias from one raw axis and round it to the sample
+ *        unit, saturating to int16.
+ * 
+ * Works in ±250°/s counts, where the bias is kept, so a reading taken at
+ * any range loses nothing before the single rounding step. What that step
+ * drops (at most half a unit, 0 once saturated) goes to rem if given.
+ */
+static int16_t accelerometer_debias(uint16_t raw, int16_t bias, unsigned char range,
+									unsigned char unit, int8_t* rem)
+{
+	int32_t exact = (int32_t)(int16_t)raw * (1 << range) - bias;
+	int32_t value = exact;
+	
+	if (unit != 0)
+	{
+		value = (exact + (1L << (unit - 1))) >> unit;
+	}
+	
+	if (value > INT16_MAX)
+	{
+		value = INT16_MAX;
+	}
+	else if (value < INT16_MIN)
+	{
+		value = INT16_MIN;
+	}
+	
+	if (rem != NULL)
+	{
+		exact -= value * (1L << unit);
+		*rem = (exact >= INT8_MIN && exact <= INT8_MAX) ? (int8_t)exact : 0;
+	}
+	return (int16_t)value;
+}
+
+/**
+ * @brief Combine big-endian register bytes into 16-bit signed gyro values,
+ *        remove the zero-rate bias and scale them to the sample unit.
+ *        rem (three axes) receives the rounding remainders, unless NULL.
+ */
+static void accelerometer_unpack_gyro(const accelerometer_t* acc, const unsigned char* buffer,
+									  gyro_data_t* gyro, int8_t* rem)
+{
+	unsigned char range = acc->gyro_hw_fs;
+	unsigned char unit = acc->gyro_fs_sel;
+	
+	gyro->gx = accelerometer_debias(((uint16_t)buffer[0] << 8) | buffer[1], acc->gyro_bias[0],
+									range, unit, (rem != NULL) ? &rem[0] : NULL);
+	gyro->gy = accelerometer_debias(((uint16_t)buffer[2] << 8) | buffer[3], acc->gyro_bias[1],
+									range, unit, (rem != NULL) ? &rem[1] : NULL);
+	gyro->gz = accelerometer_debias(((uint16_t)buffer[4] << 8) | buffer[5], acc->gyro_bias[2],
+									range, unit, (rem != NULL) ? &rem[2] : NULL);
+}
+
+/**
+ * @brief One axis of a motion sample in ±250°/s counts, before rounding.
+ */
+static int32_t accelerometer_residual(const accelerometer_t* acc, const motion_sample_t* motion,
+									  unsigned char axis)
+{
+	int16_t value = (axis == 0) ? motion->gyro.gx :
+					(axis == 1) ? motion->gyro.gy : motion->gyro.gz;
+	
+	return ((int32_t)value * (1 << acc->gyro_fs_sel)) + motion->gyro_rem[axis];
+}
+
+/**
+ * @brief Publish the rounded tracked bias for the read path,
+ *        in ±250°/s counts.
+ */
+static void accelerometer_apply_bias(accelerometer_t* acc)
+{
+	int16_t bias[3];
+	unsigned char axis;
+	unsigned char gie;
+	
+	for (axis = 0; axis < 3; axis++)
+	{
+		bias[axis] = (int16_t)((acc->gyro_bias_base_q8[axis] + 128) >> 8);
+	}
+	
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	acc->gyro_bias[0] = bias[0];
+	acc->gyro_bias[1] = bias[1];
+	acc->gyro_bias[2] = bias[2];
+	INTCONbits.GIE = gie;
+}
+
+/**
+ * @brief Unpack the 14-byte ACCEL_XOUT_H..GYRO_ZOUT_L block.
+ */
+static void accelerometer_unpack_motion(const accelerometer_t* acc, const unsigned char* buffer,
+										motion_sample_t* motion)
+{
+	motion->ax   = (int16_t)(((uint16_t)buffer[0] << 8) | buffer[1]);
+	motion->ay   = (int16_t)(((uint16_t)buffer[2] << 8) | buffer[3]);
+	motion->az   = (int16_t)(((uint16_t)buffer[4] << 8) | buffer[5]);
+	motion->temp = (int16_t)(((uint16_t)buffer[6] << 8) | buffer[7]);
+	accelerometer_unpack_gyro(acc, &buffer[8], &motion->gyro, motion->gyro_rem);
+}
+
+/**
+ * @brief I2C completion callback for an auto-ranging GYRO_CONFIG write (ISR context).
+ */
+static void accelerometer_range_write_complete(i2c_status_t status, void* context)
+{
+	accelerometer_t* acc = (accelerometer_t*)context;
+	
+	// Reads queued behind the write complete after it, at the new range
+	if (status == I2C_OK)
+	{
+		acc->gyro_hw_fs = acc->range_pending;
+		acc->range_settle = ACC_AUTORANGE_SETTLE;
+	}
+	acc->range_pending = RANGE_NONE;
+}
+
+/**
+ * @brief Choose the gyro range for the next samples from the raw peak.
+ */
+static unsigned char accelerometer_autorange_target(accelerometer_t* acc,
+													const unsigned char* buffer)
+{
+	uint16_t raw;
+	uint16_t peak = 0;
+	unsigned char axis;
+	unsigned char range = acc->gyro_hw_fs;
+	
+	for (axis = 0; axis < 3; axis++)
+	{
+		// |raw| as unsigned, so -32768 reads as 32768
+		raw = ((uint16_t)buffer[axis * 2] << 8) | buffer[(axis * 2) + 1];
+		if (raw & 0x8000u)
+		{
+			raw = (uint16_t)(0u - raw);
+		}
+		if (raw > peak)
+		{
+			peak = raw;
+		}
+	}
+	
+	if (peak >= ACC_AUTORANGE_HIGH)
+	{
+		acc->range_quiet = 0;
+		if (range < ACC_AUTORANGE_MAX_FS)
+		{
+			// A clipped axis gives no hint how far over it is
+			return (peak >= ACC_AUTORANGE_CLIP) ? ACC_AUTORANGE_MAX_FS : range + 1;
+		}
+	}
+	else if (peak < ACC_AUTORANGE_LOW && range > acc->range_min)
+	{
+		if (++acc->range_quiet >= ACC_AUTORANGE_HOLD)
+		{
+			acc->range_quiet = 0;
+			return range - 1;
+		}
+	}
+	else
+	{
+		acc->range_quiet = 0;
+	}
+	
+	return range;
+}
+
+/**
+ * @brief Auto-ranging step for a freshly unpacked gyro sample.
+ * 
+ * Repeats the previous gyro reading while the DLPF settles after a
+ * switch, then asks for a new range when the raw peak calls for one:
+ * queued behind the data-ready reads from the ISR, blocking otherwise.
+ * rem is cleared along with a repeated reading, unless NULL.
+ */
+static void accelerometer_autorange(accelerometer_t* acc, const unsigned char* buffer,
+									gyro_data_t* gyro, int8_t* rem, unsigned char from_isr)
+{
+	unsigned char target;
+	
+	// FIFO frames are not tagged with the range they were taken at
+	if (!acc->autorange || acc->fifo_frame_size != 0)
+	{
+		return;
+	}
+	
+	if (acc->range_settle != 0)
+	{
+		acc->range_settle--;
+		*gyro = acc->range_hold;
+		if (rem != NULL)
+		{
+			rem[0] = 0;
+			rem[1] = 0;
+			rem[2] = 0;
+		}
+		return;
+	}
+	acc->range_hold = *gyro;
+	
+	if (acc->range_pending != RANGE_NONE)
+	{
+		return;
+	}
+	
+	target = accelerometer_autorange_target(acc, buffer);
+	if (target == acc->gyro_hw_fs)
+	{
+		return;
+	}
+	
+	if (from_isr)
+	{
+		acc->range_pending = target;
+		if (i2c_async_write(acc->address, MPU6050_GYRO_CONFIG,
+							(unsigned char)(target << ACC_GYRO_FS_SHIFT),
+							accelerometer_range_write_complete, acc) != I2C_OK)
+		{
+			// Queue full; the next sample asks again
+			acc->range_pending = RANGE_NONE;
+		}
+	}
+	else if (i2c_single_write(acc->address, MPU6050_GYRO_CONFIG,
+							  (unsigned char)(target << ACC_GYRO_FS_SHIFT)) == I2C_OK)
+	{
+		acc->gyro_hw_fs = target;
+		acc->range_settle = ACC_AUTORANGE_SETTLE;
+	}
+}
+
+/**
+ * @brief I2C completion callback for the asynchronous gyro read (ISR context).
+ */
+static void accelerometer_gyro_read_complete(i2c_status_t status, void* context)
+{
+	accelerometer_t* acc = (accelerometer_t*)context;
+	
+	if (status != I2C_OK)
+	{
+		acc->async_state = GYRO_ASYNC_FAILED;
+		return;
+	}
+	
+	accelerometer_unpack_gyro(acc, acc->async_buffer, &acc->async_gyro, NULL);
+	accelerometer_autorange(acc, acc->async_buffer, &acc->async_gyro, NULL, 1);
+	acc->async_state = GYRO_ASYNC_DONE;
+}
+
+/**
+ * @brief I2C completion callback for the data-ready motion read (ISR context).
+ */
+static void accelerometer_motion_read_complete(i2c_status_t status, void* context)
+{
+	accelerometer_t* acc = (accelerometer_t*)context;
+	motion_sample_t sample;
+	unsigned char head;
+	
+	if (status != I2C_OK)
+	{
+		acc->async_state = GYRO_ASYNC_FAILED;
+		return;
+	}
+	
+	// Room was checked when the read started, and only the main loop
+	// frees slots; publish the slot once it is complete
+	accelerometer_unpack_motion(acc, acc->async_buffer, &sample);
+	accelerometer_autorange(acc, &acc->async_buffer[8], &sample.gyro, sample.gyro_rem, 1);
+	sample.t_ms = acc->async_ms;
+	head = acc->ring.head;
+	acc->ring.slots[head & RING_MASK] = sample;
+	acc->ring.head = (unsigned char)(head + 1);
+	acc->async_state = GYRO_ASYNC_IDLE;
+}
+
+/**
+ * @brief Take the result of accelerometer_start_read_gyro().
+ */
+static acc_error_t accelerometer_take_async(accelerometer_t* acc, gyro_data_t* gyro)
+{
+	unsigned char gie = INTCONbits.GIE;
+	
+	switch (acc->async_state)
+	{
+		case GYRO_ASYNC_PENDING:
+			return ACC_BUSY;
+			
+		case GYRO_ASYNC_DONE:
+			INTCONbits.GIE = 0;
+			*gyro = acc->async_gyro;
+			if (acc->async_state == GYRO_ASYNC_DONE)
+			{
+				acc->async_state = GYRO_ASYNC_IDLE;
+			}
+			INTCONbits.GIE = gie;
+			return ACC_SUCCESS;
+			
+		case GYRO_ASYNC_FAILED:
+			INTCONbits.GIE = 0;
+			if (acc->async_state == GYRO_ASYNC_FAILED)
+			{
+				acc->async_state = GYRO_ASYNC_IDLE;
+			}
+			INTCONbits.GIE = gie;
+			return ACC_I2C_ERROR;
+			
+		default:
+			// No read was started
+			return ACC_NOT_INITIALIZED;
+	}
+}
+
+/**
+ * @brief INT pins of the sensors sampling on data-ready (0 if none).
+ */
+static unsigned char accelerometer_sampling(void)
+{
+	unsigned char pins = 0;
+	unsigned char i;
+	
+	for (i = 0; i < ACC_MAX_SENSORS; i++)
+	{
+		if (data_ready_sensors[i] != NULL)
+		{
+			pins |= data_ready_sensors[i]->int_mask;
+		}
+	}
+	
+	return pins;
+}
+
+/**
+ * @brief Enable INT1/INT2 for the given INT pins and mask the others.
+ */
+static void accelerometer_arm_int(unsigned char pins)
+{
+	INTCON3bits.INT1IE = (pins & ACC_INT_RB1) ? 1 : 0;
+	INTCON3bits.INT2IE = (pins & ACC_INT_RB2) ? 1 : 0;
+}
+
+/**
+ * @brief Initialize the MPU-6050 accelerometer/gyroscope.
+ */
+acc_error_t accelerometer_init(accelerometer_t* acc, unsigned char address,
+							   unsigned char int_mask)
+{
+	unsigned char device_id = 0;
+	unsigned char axis;
+	
+	if (acc == NULL || (int_mask != ACC_INT_RB1 && int_mask != ACC_INT_RB2))
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	// Fresh instance: no bias, FIFO off, not sampling
+	acc->address = address;
+	acc->int_mask = int_mask;
+	acc->initialized = 0;
+	acc->data_ready_enabled = 0;
+	acc->fifo_frame_size = 0;
+	acc->async_state = GYRO_ASYNC_IDLE;
+	acc->ring.head = 0;
+	acc->ring.tail = 0;
+	acc->dropped_samples = 0;
+	acc->sample_rate_hz = ACC_DEFAULT_SAMPLE_RATE_HZ;
+	acc->gyro_fs_sel = ACC_DEFAULT_GYRO_FS;
+	acc->gyro_hw_fs = ACC_DEFAULT_GYRO_FS;
+	acc->profile = ACC_DEFAULT_PROFILE;
+	acc->autorange = 0;
+	acc->range_min = ACC_DEFAULT_GYRO_FS;
+	acc->range_pending = RANGE_NONE;
+	acc->range_settle = 0;
+	acc->range_quiet = 0;
+	for (axis = 0; axis < 3; axis++)
+	{
+		acc->gyro_bias[axis] = 0;
+		acc->gyro_bias_base_q8[axis] = 0;
+	}
+	acc->gyro_bias_temp_ref = 0;
+	acc->still_samples = 0;
+	acc->cal.active = 0;
+	
+	// Read WHO_AM_I register to verify device communication; it holds the
+	// upper six address bits only, so both AD0 levels return 0x68
+	if (i2c_single_read(acc->address, MPU6050_WHO_AM_I, &device_id) != I2C_OK ||
+		device_id != MPU6050_WHO_AM_I_VALUE)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	// Wake up the MPU-6050 (it may be in sleep mode), gyroscope
+	// sensitivity ±250°/s (GYRO_CONFIG = 0x00), default DLPF, and a
+	// data-ready pulse on INT (active high, push-pull, 50 us)
+	if (i2c_single_write(acc->address, MPU6050_PWR_MGMT_1, 0x09) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_GYRO_CONFIG,
+						 ACC_DEFAULT_GYRO_FS << ACC_GYRO_FS_SHIFT) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_REG_CONFIG, ACC_DEFAULT_DLPF) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_INT_PIN_CFG, 0x00) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_INT_ENABLE, MPU6050_INT_DATA_RDY) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	acc->initialized = 1;
+	return accelerometer_set_sample_rate(acc, ACC_DEFAULT_SAMPLE_RATE_HZ);
+}
+
+/**
+ * @brief Read raw gyroscope data from all three axes.
+ * Performs I2C burst read of 6 bytes starting from GYRO_XOUT_H (0x43).
+ */
+acc_error_t accelerometer_read_gyro(accelerometer_t* acc, gyro_data_t* gyro)
+{
+	unsigned char buffer[6];
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (gyro == NULL)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	// Read 6 bytes starting from GYRO_XOUT_H (0x43)
+	if (i2c_bulk_read(acc->address, MPU6050_GYRO_XOUT_H, buffer, 6) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	// Combine high and low bytes into 16-bit signed values
+	accelerometer_unpack_gyro(acc, buffer, gyro, NULL);
+	accelerometer_autorange(acc, buffer, gyro, NULL, 0);
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Read accel, temperature and gyro in one 14-byte burst from 0x3B.
+ */
+acc_error_t accelerometer_read_motion(accelerometer_t* acc, motion_sample_t* motion)
+{
+	unsigned char buffer[MPU6050_MOTION_BLOCK_LEN];
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (motion == NULL)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	// Registers 0x3B..0x48 are contiguous: accel, temp, gyro
+	if (i2c_bulk_read(acc->address, MPU6050_ACCEL_XOUT_H, buffer, MPU6050_MOTION_BLOCK_LEN) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	accelerometer_unpack_motion(acc, buffer, motion);
+	accelerometer_autorange(acc, &buffer[8], &motion->gyro, motion->gyro_rem, 0);
+	motion->t_ms = scheduler_millis();
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Start a non-blocking gyroscope read on the async I2C engine.
+ */
+acc_error_t accelerometer_start_read_gyro(accelerometer_t* acc)
+{
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (acc->async_state == GYRO_ASYNC_PENDING)
+	{
+		return ACC_BUSY;
+	}
+	
+	acc->async_state = GYRO_ASYNC_PENDING;
+	if (i2c_async_read(acc->address, MPU6050_GYRO_XOUT_H, acc->async_buffer, 6,
+					   accelerometer_gyro_read_complete, acc) != I2C_OK)
+	{
+		acc->async_state = GYRO_ASYNC_IDLE;
+		return ACC_BUSY;
+	}
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Collect the result of a non-blocking gyroscope read.
+ */
+acc_error_t accelerometer_get_async_gyro(accelerometer_t* acc, gyro_data_t* gyro)
+{
+	if (acc == NULL || gyro == NULL)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	return accelerometer_take_async(acc, gyro);
+}
+
+/**
+ * @brief Program SMPLRT_DIV for the requested sample rate.
+ */
+acc_error_t accelerometer_set_sample_rate(accelerometer_t* acc, unsigned int hz)
+{
+	unsigned int divider;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (hz < ACC_MIN_SAMPLE_RATE_HZ || hz > ACC_GYRO_OUTPUT_RATE_HZ)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	divider = (ACC_GYRO_OUTPUT_RATE_HZ / hz) - 1;
+	if (i2c_single_write(acc->address, MPU6050_SMPLRT_DIV, (unsigned char)divider) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	acc->sample_rate_hz = ACC_GYRO_OUTPUT_RATE_HZ / (divider + 1);
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Select the MPU-6050 digital low-pass filter (CONFIG.DLPF_CFG).
+ */
+acc_error_t accelerometer_set_dlpf(accelerometer_t* acc, unsigned char dlpf_cfg)
+{
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	// 0 and 7 switch the gyro output rate to 8 kHz, which the sample
+	// rate divider math assumes is 1 kHz
+	if (dlpf_cfg < ACC_DLPF_MIN || dlpf_cfg > ACC_DLPF_MAX)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	if (i2c_single_write(acc->address, MPU6050_REG_CONFIG, dlpf_cfg) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Select the gyro full-scale range (GYRO_CONFIG.FS_SEL).
+ */
+acc_error_t accelerometer_set_gyro_range(accelerometer_t* acc, unsigned char fs_sel)
+{
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (fs_sel > ACC_GYRO_FS_2000)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	if (accelerometer_sampling())
+	{
+		// Queued samples would be read at one range and scaled for another
+		return ACC_BUSY;
+	}
+	
+	if (i2c_single_write(acc->address, MPU6050_GYRO_CONFIG,
+						 (unsigned char)(fs_sel << ACC_GYRO_FS_SHIFT)) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	// With auto-ranging this is the floor, and samples stay in the
+	// units of the widest range
+	acc->gyro_hw_fs = fs_sel;
+	acc->range_min = fs_sel;
+	acc->gyro_fs_sel = acc->autorange ? ACC_AUTORANGE_MAX_FS : fs_sel;
+	acc->range_settle = 0;
+	acc->range_quiet = 0;
+	
+	// The spread of a calibration in progress was taken in the old unit
+	if (acc->cal.active)
+	{
+		accelerometer_calibrate_start(acc);
+	}
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Get the range the samples are expressed in.
+ */
+unsigned char accelerometer_get_gyro_range(const accelerometer_t* acc)
+{
+	return acc->gyro_fs_sel;
+}
+
+/**
+ * @brief Get the range the sensor is measuring at right now.
+ */
+unsigned char accelerometer_get_gyro_hw_range(const accelerometer_t* acc)
+{
+	return acc->gyro_hw_fs;
+}
+
+/**
+ * @brief Turn gyro auto-ranging on or off.
+ */
+acc_error_t accelerometer_set_autorange(accelerometer_t* acc, unsigned char enable)
+{
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (accelerometer_sampling())
+	{
+		return ACC_BUSY;
+	}
+	
+	acc->autorange = enable ? 1 : 0;
+	
+	// Back to the floor, with the sample unit for the new mode
+	return accelerometer_set_gyro_range(acc, acc->range_min);
+}
+
+/**
+ * @brief Program DLPF, sample rate and gyro range from a profile.
+ */
+acc_error_t accelerometer_set_profile(accelerometer_t* acc, unsigned char profile)
+{
+	const acc_profile_settings_t* settings;
+	acc_error_t status;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (profile >= ACC_PROFILE_COUNT)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	if (accelerometer_sampling())
+	{
+		return ACC_BUSY;
+	}
+	
+	settings = &profiles[profile];
+	status = accelerometer_set_dlpf(acc, settings->dlpf_cfg);
+	if (status == ACC_SUCCESS)
+	{
+		status = accelerometer_set_sample_rate(acc, settings->sample_rate_hz);
+	}
+	if (status == ACC_SUCCESS)
+	{
+		status = accelerometer_set_gyro_range(acc, settings->gyro_fs_sel);
+	}
+	if (status == ACC_SUCCESS)
+	{
+		acc->profile = profile;
+	}
+	
+	return status;
+}
+
+/**
+ * @brief Get the profile last applied.
+ */
+unsigned char accelerometer_get_profile(const accelerometer_t* acc)
+{
+	return acc->profile;
+}
+
+/**
+ * @brief Get the programmed sample rate.
+ */
+unsigned int accelerometer_get_sample_rate(const accelerometer_t* acc)
+{
+	return acc->sample_rate_hz;
+}
+
+/**
+ * @brief Average stationary samples at boot to find the gyro zero-rate bias.
+ */
+acc_error_t accelerometer_calibrate_gyro(accelerometer_t* acc)
+{
+	motion_sample_t motion;
+	acc_error_t status;
+	unsigned int polls;
+	unsigned char int_status;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (accelerometer_sampling())
+	{
+		// The ISR owns the bus once any sensor samples on data-ready
+		return ACC_BUSY;
+	}
+	
+	accelerometer_calibrate_start(acc);
+	do
+	{
+		// Pace on the sensor's DATA_RDY flag so each sample is new
+		polls = 0;
+		do
+		{
+			if (i2c_single_read(acc->address, MPU6050_INT_STATUS, &int_status) != I2C_OK ||
+				++polls >= ACC_CAL_POLL_LIMIT)
+			{
+				acc->cal.active = 0;
+				return ACC_I2C_ERROR;
+			}
+		} while (!(int_status & MPU6050_INT_DATA_RDY));
+		
+		if (accelerometer_read_motion(acc, &motion) != ACC_SUCCESS)
+		{
+			acc->cal.active = 0;
+			return ACC_I2C_ERROR;
+		}
+		
+		status = accelerometer_calibrate_add(acc, &motion);
+	} while (status == ACC_BUSY);
+	
+	return status;
+}
+
+/**
+ * @brief Start a gyro calibration fed by accelerometer_calibrate_add().
+ */
+acc_error_t accelerometer_calibrate_start(accelerometer_t* acc)
+{
+	unsigned char axis;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	for (axis = 0; axis < 3; axis++)
+	{
+		acc->cal.sum[axis] = 0;
+		acc->cal.min[axis] = INT16_MAX;
+		acc->cal.max[axis] = INT16_MIN;
+	}
+	acc->cal.temp_sum = 0;
+	acc->cal.count = 0;
+	acc->cal.active = 1;
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Add one sample to the calibration in progress.
+ */
+acc_error_t accelerometer_calibrate_add(accelerometer_t* acc, const motion_sample_t* motion)
+{
+	unsigned char axis;
+	
+	if (acc == NULL || motion == NULL || !acc->cal.active)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	// Samples already have the current bias removed
+	for (axis = 0; axis < 3; axis++)
+	{
+		int16_t v = (axis == 0) ? motion->gyro.gx :
+					(axis == 1) ? motion->gyro.gy : motion->gyro.gz;
+		acc->cal.sum[axis] += accelerometer_residual(acc, motion, axis);
+		if (v < acc->cal.min[axis]) acc->cal.min[axis] = v;
+		if (v > acc->cal.max[axis]) acc->cal.max[axis] = v;
+	}
+	acc->cal.temp_sum += motion->temp;
+	
+	if (++acc->cal.count < (1u << ACC_CAL_SHIFT))
+	{
+		return ACC_BUSY;
+	}
+	acc->cal.active = 0;
+	
+	for (axis = 0; axis < 3; axis++)
+	{
+		if ((int32_t)acc->cal.max[axis] - acc->cal.min[axis] > (ACC_CAL_MAX_SPREAD >> acc->gyro_fs_sel))
+		{
+			// Moved during calibration; keep the previous bias
+			return ACC_NOT_STILL;
+		}
+	}
+	
+	acc->gyro_bias_temp_ref = (int16_t)(acc->cal.temp_sum >> ACC_CAL_SHIFT);
+	for (axis = 0; axis < 3; axis++)
+	{
+		// Residual mean (Q8, ±250°/s counts) on top of the bias already applied
+		acc->gyro_bias_base_q8[axis] = ((int32_t)acc->gyro_bias[axis] * 256) +
+									   acc->cal.sum[axis] * (256 >> ACC_CAL_SHIFT);
+	}
+	acc->still_samples = 0;
+	accelerometer_apply_bias(acc);
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Follow slow bias drift while the blade is still.
+ */
+void accelerometer_track_bias(accelerometer_t* acc, const motion_sample_t* motion)
+{
+	int16_t still;
+	unsigned char axis;
+	
+	if (acc == NULL || motion == NULL)
+	{
+		return;
+	}
+	
+	// Still = every debiased axis inside the band for a while
+	still = ACC_STILL_GYRO >> acc->gyro_fs_sel;
+	if (motion->gyro.gx > still || motion->gyro.gx < -still ||
+		motion->gyro.gy > still || motion->gyro.gy < -still ||
+		motion->gyro.gz > still || motion->gyro.gz < -still)
+	{
+		acc->still_samples = 0;
+	}
+	else if (acc->still_samples < ACC_STILL_SAMPLES)
+	{
+		acc->still_samples++;
+	}
+	else
+	{
+		// EMA toward the residual (±250°/s counts): base += residual / 2^ACC_BIAS_TRACK_SHIFT
+		for (axis = 0; axis < 3; axis++)
+		{
+			acc->gyro_bias_base_q8[axis] += (accelerometer_residual(acc, motion, axis) * 256) >>
+											ACC_BIAS_TRACK_SHIFT;
+		}
+		accelerometer_apply_bias(acc);
+	}
+}
+
+/**
+ * @brief Get the gyro bias currently subtracted from readings.
+ */
+void accelerometer_get_gyro_bias(const accelerometer_t* acc, gyro_data_t* bias)
+{
+	unsigned char gie;
+	
+	if (acc == NULL || bias == NULL)
+	{
+		return;
+	}
+	
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	bias->gx = acc->gyro_bias[0];
+	bias->gy = acc->gyro_bias[1];
+	bias->gz = acc->gyro_bias[2];
+	INTCONbits.GIE = gie;
+}
 
 /**
- * @brief Initialize the MPU-6050 accelerometer/gyroscope.
+ * @brief Get the calibrated bias and its calibration temperature for storage.
+ */
+void accelerometer_get_gyro_calibration(const accelerometer_t* acc, gyro_data_t* bias,
+										int16_t* temp_ref)
+{
+	if (acc == NULL || bias == NULL || temp_ref == NULL)
+	{
+		return;
+	}
+	
+	bias->gx = (int16_t)((acc->gyro_bias_base_q8[0] + 128) >> 8);
+	bias->gy = (int16_t)((acc->gyro_bias_base_q8[1] + 128) >> 8);
+	bias->gz = (int16_t)((acc->gyro_bias_base_q8[2] + 128) >> 8);
+	*temp_ref = acc->gyro_bias_temp_ref;
+}
+
+/**
+ * @brief Restore a stored bias instead of calibrating.
+ */
+void accelerometer_set_gyro_calibration(accelerometer_t* acc, const gyro_data_t* bias,
+										int16_t temp_ref)
+{
+	if (acc == NULL || bias == NULL)
+	{
+		return;
+	}
+	
+	acc->gyro_bias_base_q8[0] = (int32_t)bias->gx * 256;
+	acc->gyro_bias_base_q8[1] = (int32_t)bias->gy * 256;
+	acc->gyro_bias_base_q8[2] = (int32_t)bias->gz * 256;
+	acc->gyro_bias_temp_ref = temp_ref;
+	acc->still_samples = 0;
+	accelerometer_apply_bias(acc);
+}
+
+/**
+ * @brief Enable the external interrupt on the sensor's INT pin.
  */
-acc_error_t accelerometer_init()
+acc_error_t accelerometer_enable_data_ready(accelerometer_t* acc)
 {
-	unsigned char device_id;
+	acc_error_t status;
+	unsigned char int_status;
+	unsigned char slot = ACC_MAX_SENSORS;
+	unsigned char i;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
 	
-	// Read WHO_AM_I register to verify device communication
-	device_id = i2c_single_read(MPU6050_WHO_AM_I);
+	// Stop the other sensors queueing reads around the blocking one below
+	accelerometer_arm_int(0);
 	
-	// MPU-6050 WHO_AM_I should return 0x68 (with AD0 low)
-	if (device_id != 0x68)
+	for (i = 0; i < ACC_MAX_SENSORS; i++)
 	{
-		return ACC_I2C_ERROR;
+		if (data_ready_sensors[i] == acc || (data_ready_sensors[i] == NULL && slot == ACC_MAX_SENSORS))
+		{
+			slot = i;
+		}
+	}
+	if (slot == ACC_MAX_SENSORS)
+	{
+		accelerometer_arm_int(accelerometer_sampling());
+		return ACC_BUSY;
+	}
+	
+	acc->async_state = GYRO_ASYNC_IDLE;
+	acc->ring.head = 0;
+	acc->ring.tail = 0;
+	acc->dropped_samples = 0;
+	acc->data_ready_enabled = 1;
+	
+	// Clear data-ready latched in the sensor before INTx is armed; arm
+	// anyway on failure, the next edge retries the bus
+	status = (i2c_single_read(acc->address, MPU6050_INT_STATUS, &int_status) == I2C_OK) ?
+			 ACC_SUCCESS : ACC_I2C_ERROR;
+	
+	// Rising edge; drop an edge seen before this sensor was sampling. The
+	// other sensor's flag stays set, so its pulse during the read above is
+	// still serviced
+	data_ready_sensors[slot] = acc;
+	if (acc->int_mask == ACC_INT_RB1)
+	{
+		INTCON2bits.INTEDG1 = 1;
+		INTCON3bits.INT1IF = 0;
+	}
+	else
+	{
+		INTCON2bits.INTEDG2 = 1;
+		INTCON3bits.INT2IF = 0;
+	}
+	accelerometer_arm_int(accelerometer_sampling());
+	
+	return status;
+}
+
+/**
+ * @brief Disable the sensor's external interrupt and wait for its read to finish.
+ */
+acc_error_t accelerometer_disable_data_ready(accelerometer_t* acc)
+{
+	unsigned char i;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
 	}
 	
-	// Wake up the MPU-6050 (it may be in sleep mode)
-	// PWR_MGMT_1 = 0x00 (internal clock, no sleep)
-	i2c_single_write(MPU6050_PWR_MGMT_1, 0x09);
+	accelerometer_arm_int(0);
+	acc->data_ready_enabled = 0;
+	for (i = 0; i < ACC_MAX_SENSORS; i++)
+	{
+		if (data_ready_sensors[i] == acc)
+		{
+			data_ready_sensors[i] = NULL;
+		}
+	}
+	accelerometer_arm_int(accelerometer_sampling());
 	
-	// Configure gyroscope sensitivity to ±250°/s (GYRO_CONFIG = 0x00)
-	i2c_single_write(MPU6050_GYRO_CONFIG, 0x00);
+	// A burst started before INTx was masked completes from the SSP2 ISR
+	while (acc->async_state == GYRO_ASYNC_PENDING) HAL_SPIN();
+	acc->async_state = GYRO_ASYNC_IDLE;
 	
-	i2c_single_write(MPU6050_REG_CONFIG, 0x03);
+	// So is a range switch queued behind it
+	while (acc->range_pending != RANGE_NONE) HAL_SPIN();
 	
-	accelerometer_initialized = 1;
 	return ACC_SUCCESS;
 }
 
 /**
- * @brief Read raw gyroscope data from all three axes.
- * Performs I2C burst read of 6 bytes starting from GYRO_XOUT_H (0x43).
+ * @brief Copy up to max queued samples out of the ring (main loop side).
  */
-acc_error_t accelerometer_read_gyro(gyro_data_t* gyro)
+static acc_error_t accelerometer_ring_take(accelerometer_t* acc, motion_sample_t* samples,
+										   unsigned char max, unsigned char* count)
 {
-	unsigned char buffer[6];
+	unsigned char tail = acc->ring.tail;
+	unsigned char queued = (unsigned char)(acc->ring.head - tail);
+	unsigned char i;
+	unsigned char gie;
+	
+	*count = 0;
+	if (queued == 0)
+	{
+		if (acc->async_state != GYRO_ASYNC_FAILED)
+		{
+			// The next data-ready edge has not arrived yet
+			return ACC_BUSY;
+		}
+		
+		// The ISR may be starting the next read; clear only the failure
+		gie = INTCONbits.GIE;
+		INTCONbits.GIE = 0;
+		if (acc->async_state == GYRO_ASYNC_FAILED)
+		{
+			acc->async_state = GYRO_ASYNC_IDLE;
+		}
+		INTCONbits.GIE = gie;
+		return ACC_I2C_ERROR;
+	}
+	
+	if (queued > max)
+	{
+		queued = max;
+	}
+	for (i = 0; i < queued; i++)
+	{
+		samples[i] = acc->ring.slots[(unsigned char)(tail + i) & RING_MASK];
+	}
+	
+	// Hand the slots back only once they are copied
+	acc->ring.tail = (unsigned char)(tail + queued);
+	*count = queued;
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Take the oldest queued data-ready sample.
+ */
+acc_error_t accelerometer_get_sample(accelerometer_t* acc, gyro_data_t* gyro)
+{
+	motion_sample_t motion;
+	unsigned char count;
+	acc_error_t status;
 	
-	if (!accelerometer_initialized)
+	if (acc == NULL || !acc->data_ready_enabled)
 	{
 		return ACC_NOT_INITIALIZED;
 	}
@@ -58,75 +1122,418 @@ acc_error_t accelerometer_read_gyro(gyro_data_t* gyro)
 		return ACC_INVALID_PARAM;
 	}
 	
-	// Read 6 bytes starting from GYRO_XOUT_H (0x43)
-	i2c_bulk_read(MPU6050_GYRO_XOUT_H, buffer, 6);
+	status = accelerometer_ring_take(acc, &motion, 1, &count);
+	if (status == ACC_SUCCESS)
+	{
+		*gyro = motion.gyro;
+	}
 	
-	// Combine high and low bytes into 16-bit signed values
-	gyro->gx = (int16_t)(((uint16_t)buffer[0] << 8) | buffer[1]);
-    gyro->gy = (int16_t)(((uint16_t)buffer[2] << 8) | buffer[3]);
-    gyro->gz = (int16_t)(((uint16_t)buffer[4] << 8) | buffer[5]);
+	return status;
+}
+
+/**
+ * @brief Take the oldest queued data-ready sample including accel and temperature.
+ */
+acc_error_t accelerometer_get_motion_sample(accelerometer_t* acc, motion_sample_t* motion)
+{
+	unsigned char count;
+	
+	return accelerometer_get_motion_samples(acc, motion, 1, &count);
+}
+
+/**
+ * @brief Take a batch of queued data-ready samples.
+ */
+acc_error_t accelerometer_get_motion_samples(accelerometer_t* acc, motion_sample_t* samples,
+											 unsigned char max, unsigned char* count)
+{
+	if (acc == NULL || !acc->data_ready_enabled)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (samples == NULL || count == NULL || max == 0)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	return accelerometer_ring_take(acc, samples, max, count);
+}
+
+/**
+ * @brief Number of data-ready samples lost before being queued.
+ */
+unsigned int accelerometer_get_dropped_samples(accelerometer_t* acc)
+{
+	unsigned int dropped;
+	unsigned char gie;
+	
+	if (acc == NULL)
+	{
+		return 0;
+	}
+	
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	dropped = acc->dropped_samples;
+	INTCONbits.GIE = gie;
+	
+	return dropped;
+}
+
+/**
+ * @brief Queue the 14-byte motion read for one data-ready pulse (ISR context).
+ */
+static void accelerometer_start_motion_read(accelerometer_t* acc, unsigned int now)
+{
+	// Previous read still on the bus, or the main loop is a whole queue
+	// behind; drop this sample rather than overwrite a queued one
+	if (acc->async_state == GYRO_ASYNC_PENDING ||
+		(unsigned char)(acc->ring.head - acc->ring.tail) >= ACC_RING_SIZE)
+	{
+		acc->dropped_samples++;
+		return;
+	}
+	
+	// One 14-byte burst: accel, temperature and gyro from the same sample,
+	// stamped with the edge rather than the completion or the main loop
+	acc->async_state = GYRO_ASYNC_PENDING;
+	acc->async_ms = now;
+	if (i2c_async_read(acc->address, MPU6050_ACCEL_XOUT_H, acc->async_buffer,
+					   MPU6050_MOTION_BLOCK_LEN, accelerometer_motion_read_complete, acc) != I2C_OK)
+	{
+		acc->async_state = GYRO_ASYNC_IDLE;
+		acc->dropped_samples++;
+	}
+}
+
+/**
+ * @brief INT1/INT2 handler; captures one sample per data-ready pulse.
+ */
+void accelerometer_isr(void)
+{
+	unsigned char rising = 0;
+	unsigned char i;
+	unsigned int now;
+	
+	// INTxIE is also cleared while a blocking call owns the bus
+	if (INTCON3bits.INT1IE && INTCON3bits.INT1IF)
+	{
+		INTCON3bits.INT1IF = 0;
+		rising |= ACC_INT_RB1;
+	}
+	if (INTCON3bits.INT2IE && INTCON3bits.INT2IF)
+	{
+		INTCON3bits.INT2IF = 0;
+		rising |= ACC_INT_RB2;
+	}
+	if (rising == 0)
+	{
+		return;
+	}
+	
+	now = scheduler_millis();
+	for (i = 0; i < ACC_MAX_SENSORS; i++)
+	{
+		if (data_ready_sensors[i] != NULL && (rising & data_ready_sensors[i]->int_mask))
+		{
+			accelerometer_start_motion_read(data_ready_sensors[i], now);
+		}
+	}
+}
+
+/**
+ * @brief Enable the MPU-6050 FIFO for gyro (and optionally accel) samples.
+ */
+acc_error_t accelerometer_fifo_enable(accelerometer_t* acc, unsigned char mode)
+{
+	unsigned char int_status;
+	
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (mode != ACC_FIFO_GYRO_ONLY && mode != ACC_FIFO_WITH_ACCEL)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	// Stop and flush before changing the frame layout
+	acc->fifo_frame_size = 0;
+	if (i2c_single_write(acc->address, MPU6050_USER_CTRL, 0x00) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_FIFO_EN, (mode == ACC_FIFO_WITH_ACCEL) ?
+						 (MPU6050_FIFO_EN_GYRO | MPU6050_FIFO_EN_ACCEL) :
+						 MPU6050_FIFO_EN_GYRO) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	// Clear a stale overflow flag, then start queueing
+	if (i2c_single_read(acc->address, MPU6050_INT_STATUS, &int_status) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	acc->fifo_frame_size = (mode == ACC_FIFO_WITH_ACCEL) ? 12 : 6;
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Disable the FIFO.
+ */
+acc_error_t accelerometer_fifo_disable(accelerometer_t* acc)
+{
+	if (acc == NULL || !acc->initialized)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	acc->fifo_frame_size = 0;
+	if (i2c_single_write(acc->address, MPU6050_USER_CTRL, 0x00) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_FIFO_EN, 0x00) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	return ACC_SUCCESS;
+}
+
+/**
+ * @brief Reset the FIFO after an overflow and keep it running.
+ */
+static acc_error_t accelerometer_fifo_recover(accelerometer_t* acc)
+{
+	if (i2c_single_write(acc->address, MPU6050_USER_CTRL, 0x00) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_USER_CTRL, MPU6050_USER_FIFO_RESET) != I2C_OK ||
+		i2c_single_write(acc->address, MPU6050_USER_CTRL, MPU6050_USER_FIFO_EN) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	
+	return ACC_FIFO_OVERFLOW;
+}
+
+/**
+ * @brief Drain whole frames from the FIFO in as few bursts as possible.
+ */
+acc_error_t accelerometer_fifo_read(accelerometer_t* acc,
+									gyro_data_t* samples,
+									unsigned char max_samples,
+									unsigned char* count)
+{
+	unsigned char buffer[2];
+	unsigned char int_status;
+	unsigned int fifo_bytes;
+	unsigned int frames;
+	unsigned char i;
+	
+	if (acc == NULL || !acc->initialized || acc->fifo_frame_size == 0)
+	{
+		return ACC_NOT_INITIALIZED;
+	}
+	
+	if (samples == NULL || count == NULL)
+	{
+		return ACC_INVALID_PARAM;
+	}
+	
+	*count = 0;
+	
+	// INT_STATUS clears on read, so it reports overflow since the last drain
+	if (i2c_single_read(acc->address, MPU6050_INT_STATUS, &int_status) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	if (int_status & MPU6050_INT_FIFO_OFLOW)
+	{
+		return accelerometer_fifo_recover(acc);
+	}
+	
+	if (i2c_bulk_read(acc->address, MPU6050_FIFO_COUNTH, buffer, 2) != I2C_OK)
+	{
+		return ACC_I2C_ERROR;
+	}
+	fifo_bytes = ((unsigned int)buffer[0] << 8) | buffer[1];
+	
+	// A full FIFO or partial frame means the frame alignment is lost
+	if (fifo_bytes >= MPU6050_FIFO_SIZE || (fifo_bytes % acc->fifo_frame_size) != 0)
+	{
+		return accelerometer_fifo_recover(acc);
+	}
+	
+	frames = fifo_bytes / acc->fifo_frame_size;
+	if (frames > max_samples)
+	{
+		frames = max_samples;
+	}
+	
+	if (acc->fifo_frame_size == 6)
+	{
+		// Gyro frames have the same 6-byte size as gyro_data_t, so burst
+		// straight into the caller's array and convert in place
+		if (frames > ACC_FIFO_MAX_BURST)
+		{
+			frames = ACC_FIFO_MAX_BURST;
+		}
+		
+		if (frames > 0 &&
+			i2c_bulk_read(acc->address, MPU6050_FIFO_R_W, (unsigned char*)samples,
+						  (unsigned char)(frames * 6)) != I2C_OK)
+		{
+			return ACC_I2C_ERROR;
+		}
+		
+		for (i = 0; i < frames; i++)
+		{
+			accelerometer_unpack_gyro(acc, (const unsigned char*)&samples[i], &samples[i], NULL);
+		}
+		
+		*count = (unsigned char)frames;
+		return ACC_SUCCESS;
+	}
+	
+	// Accel + gyro frames: drain in small chunks, keep the gyro half
+	while (*count < frames)
+	{
+		unsigned char chunk[ACC_FIFO_ACCEL_CHUNK * 12];
+		unsigned char n = (unsigned char)(frames - *count);
+		
+		if (n > ACC_FIFO_ACCEL_CHUNK)
+		{
+			n = ACC_FIFO_ACCEL_CHUNK;
+		}
+		
+		if (i2c_bulk_read(acc->address, MPU6050_FIFO_R_W, chunk, (unsigned char)(n * 12)) != I2C_OK)
+		{
+			return ACC_I2C_ERROR;
+		}
+		
+		for (i = 0; i < n; i++)
+		{
+			accelerometer_unpack_gyro(acc, &chunk[(i * 12) + 6], &samples[*count], NULL);
+			(*count)++;
+		}
+	}
 	
 	return ACC_SUCCESS;
 }
 
+/**
+ * @brief Magnitude of the gyro vector in raw counts.
+ */
+static unsigned int accelerometer_magnitude_counts(const gyro_data_t* gyro)
+{
+#if ACC_MAG_MODE == ACC_MAG_ALPHA_MAX
+	unsigned int ax = (gyro->gx < 0) ? (unsigned int)(-(long)gyro->gx) : (unsigned int)gyro->gx;
+	unsigned int ay = (gyro->gy < 0) ? (unsigned int)(-(long)gyro->gy) : (unsigned int)gyro->gy;
+	unsigned int az = (gyro->gz < 0) ? (unsigned int)(-(long)gyro->gz) : (unsigned int)gyro->gz;
+	unsigned int t;
+	
+	// Sort so that ax >= ay >= az
+	if (ay > ax) { t = ax; ax = ay; ay = t; }
+	if (az > ay) { t = ay; ay = az; az = t; }
+	if (ay > ax) { t = ax; ax = ay; ay = t; }
+	
+	// max + 11/32 mid + 1/4 min; at most 52224 for full-scale input
+	return ax + (ay >> 2) + (ay >> 4) + (ay >> 5) + (az >> 2);
+#else
+	// Square raw counts so no precision is lost before the root;
+	// 3 * 32768^2 still fits in 32 bits
+	unsigned long sum;
+	sum  = (unsigned long)((long)gyro->gx * gyro->gx);
+	sum += (unsigned long)((long)gyro->gy * gyro->gy);
+	sum += (unsigned long)((long)gyro->gz * gyro->gz);
+	
+	return isqrt(sum);
+#endif
+}
+
 /**
  * @brief Calculate the magnitude of angular velocity.
  * Uses integer arithmetic: magnitude = sqrt(gx^2 + gy^2 + gz^2)
  */
-acc_error_t accelerometer_calculate_magnitude_with_check(gyro_data_t* gyro, 
+acc_error_t accelerometer_calculate_magnitude_with_check(const gyro_data_t* gyro, 
 														 unsigned int* magnitude)
 {
+	unsigned int raw;
+	
 	if (gyro == NULL || magnitude == NULL)
 	{
 		return ACC_INVALID_PARAM;
 	}
 	
-	// Use unsigned long to prevent overflow during multiplication
-	unsigned long sum = 0;
-	long gx_long = (long)gyro->gx / GYRO_SENSITIVITY;
-	long gy_long = (long)gyro->gy / GYRO_SENSITIVITY;
-	long gz_long = (long)gyro->gz / GYRO_SENSITIVITY;
-    	
-	sum = (gx_long * gx_long) + (gy_long * gy_long) + (gz_long * gz_long);
+	raw = accelerometer_magnitude_counts(gyro);
 	
-	// Integer square root approximation using Newton's method
-	*magnitude = (unsigned int) isqrt(sum);
+	// Single fixed-point scale from counts to deg/s (rounded)
+	*magnitude = (unsigned int)(((unsigned long)raw * ACC_MAG_SCALE_Q16 + 0x8000UL) >> 16);
 	
 	return ACC_SUCCESS;
 }
 
 /**
- * @brief Simple integer square root using Newton's method.
+ * @brief Integer square root by shift/subtract, no division.
  */
 unsigned int isqrt(unsigned long n)
 {
-	if (n == 0)
-	{
-		return 0;
-	} 
+	unsigned long root = 0;
+	unsigned long bit = 1UL << 30;
 	
-	unsigned int x = n;
-	unsigned int x1 = (x + 1) >> 1;
+	// Start at the highest power of four not above n
+	while (bit > n)
+	{
+		bit >>= 2;
+	}
 	
-	while (x1 < x)
+	while (bit != 0)
 	{
-		x = x1;
-		x1 = (x + n / x) >> 1;
+		if (n >= root + bit)
+		{
+			n -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
 	}
 	
-	return x;
+	return (unsigned int)root;
 }
 
 /**
  * @brief Simplified magnitude calculation (without check wrapper).
  */
-unsigned int accelerometer_calculate_magnitude(gyro_data_t* gyro)
+unsigned int accelerometer_calculate_magnitude(const gyro_data_t* gyro)
 {
 	unsigned int magnitude = 0;
 	accelerometer_calculate_magnitude_with_check(gyro, &magnitude);
 	return magnitude;
 }
 
+/**
+ * @brief Angular speed in °/s at the sensor's current gyro range.
+ */
+unsigned int accelerometer_get_speed(const accelerometer_t* acc, const gyro_data_t* gyro)
+{
+	unsigned int raw;
+	
+	if (acc == NULL || gyro == NULL)
+	{
+		return 0;
+	}
+	
+	raw = accelerometer_magnitude_counts(gyro);
+	
+	// A count at FS_SEL n is worth 2^n counts at ±250°/s; at most
+	// 56755 * 500 * 8, so the scaled product still fits in 32 bits
+	return (unsigned int)((((unsigned long)raw * ACC_MAG_SCALE_Q16 << acc->gyro_fs_sel) +
+						   0x8000UL) >> 16);
+}
+
 /**
  * @brief Update moving average buffer with new speed value.
  */
@@ -137,15 +1544,21 @@ void accelerometer_update_moving_avg(moving_avg_t* avg, unsigned int speed)
 		return;
 	}
 	
-	// Add new value to circular buffer
+	// Swap the oldest value out of the running sum and the new one in
+	avg->sum -= avg->buffer[avg->index];
+	avg->sum += speed;
 	avg->buffer[avg->index] = speed;
-	avg->index++;
 	
-	// Wrap around if buffer is full
-	if (avg->index >= MOVING_AVG_BUFFER_SIZE)
+	// Power-of-two window: wrap with a mask instead of a compare
+	avg->index = (avg->index + 1) & MOVING_AVG_INDEX_MASK;
+	
+	if (!avg->is_full)
 	{
-		avg->index = 0;
-		avg->is_full = 1;
+		avg->count++;
+		if (avg->count >= MOVING_AVG_BUFFER_SIZE)
+		{
+			avg->is_full = 1;
+		}
 	}
 }
 
@@ -154,29 +1567,26 @@ void accelerometer_update_moving_avg(moving_avg_t* avg, unsigned int speed)
  */
 unsigned int accelerometer_get_moving_avg(moving_avg_t* avg)
 {
-	unsigned int sum = 0;
-	unsigned char i;
-	unsigned char count = MOVING_AVG_BUFFER_SIZE;
-	
 	if (avg == NULL)
 	{
 		return 0;
 	}
 	
-	// Only calculate average if buffer is full
-	if (!avg->is_full)
+	if (avg->is_full)
 	{
-		return 0;
+		return (unsigned int)(avg->sum >> MOVING_AVG_SHIFT);
 	}
 	
-	// Sum all values in the buffer
-	for (i = 0; i < count; i++)
+#if MOVING_AVG_WARMUP
+	// Partial window: only runs for the first few samples after reset
+	if (avg->count == 0)
 	{
-		sum += avg->buffer[i];
+		return 0;
 	}
-	
-	// Return the average
-	return sum / count;
+	return (unsigned int)(avg->sum / avg->count);
+#else
+	return 0;
+#endif
 }
 
 /**
@@ -196,51 +1606,37 @@ void accelerometer_reset_moving_avg(moving_avg_t* avg)
 		avg->buffer[i] = 0;
 	}
 	
+	avg->sum = 0;
 	avg->index = 0;
+	avg->count = 0;
 	avg->is_full = 0;
 }
 
 /**
- * @brief Map speed value to RGB LED color.
+ * @brief Map speed value to RGB LED color through the generated table.
  */
 acc_error_t accelerometer_speed_to_color(unsigned int speed,
-										 unsigned char* r,
-										 unsigned char* g,
-										 unsigned char* b)
+										 unsigned int* r,
+										 unsigned int* g,
+										 unsigned int* b)
 {
+	unsigned int index;
+	
 	if (r == NULL || g == NULL || b == NULL)
 	{
 		return ACC_INVALID_PARAM;
 	}
 	
-	if (speed <= 100)
+	// One entry per 2^COLOR_LUT_SHIFT °/s; faster saturates at the last
+	index = speed >> COLOR_LUT_SHIFT;
+	if (index >= COLOR_LUT_SIZE)
 	{
-		// Stationary to slow: Red
-		*r = 255;
-		*g = 0;
-		*b = 0;
-	}
-	else if (speed <= 300)
-	{
-		// Slow to medium: Yellow (transitioning from Red to Green)
-		*r = 255;
-		*g = 50;
-		*b = 0;
-	}
-	else if (speed <= 600)
-	{
-		// Medium to fast: Green
-		*r = 0;
-		*g = 255;
-		*b = 0;
-	}
-	else
-	{
-		// Very fast: Blue
-		*r = 0;
-		*g = 0;
-		*b = 255;
+		index = COLOR_LUT_SIZE - 1;
 	}
 	
+	*r = color_lut[index][0];
+	*g = color_lut[index][1];
+	*b = color_lut[index][2];
+	
 	return ACC_SUCCESS;
 }
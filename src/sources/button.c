@@ -9,89 +9,170 @@
 
 // #include "./button.h"
 
-#define _XTAL_FREQ 16000000UL   // CPU Frequency in Hz
+typedef enum {
+    GESTURE_IDLE = 0,    // Released, nothing pending
+    GESTURE_DOWN,        // First press, timing for a long press
+    GESTURE_UP,          // Released after a short press, waiting for a second
+    GESTURE_HELD         // Gesture reported; waiting for the release
+} gesture_state_t;
+
+// --------- Debounce and gesture state (owned by the ISR) -------------
+static volatile uint8_t debounce_left = 0;  // ms until RB0 is sampled (0 = armed)
+static bool button_down = false;            // Debounced level
+static gesture_state_t gesture = GESTURE_IDLE;
+static uint16_t gesture_ms = 0;             // Time in the current state
+// ---------------------------------------------------------------------
+
+// --------- Event queue: written by the ISR, read by the main loop ----
+static volatile uint8_t queue[BUTTON_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;     // Next slot to write (ISR)
+static volatile uint8_t queue_tail = 0;     // Next slot to read (main loop)
+static volatile uint8_t queue_dropped = 0;
+// ---------------------------------------------------------------------
 
-unsigned char notes[MELODY_LENGTH] = {
-    e5, b4, c5, d5, c5, b4, a4
-};
+static bool button_pressed(void)
+{
+    // Low-active button
+    return !PORTBbits.RB0;
+}
+
+static void button_queue(button_event_t event)
+{
+    uint8_t next = (uint8_t)((queue_head + 1) & (BUTTON_QUEUE_SIZE - 1));
 
-unsigned char dura[MELODY_LENGTH] = {
-    6, 3, 3, 6, 3, 3, 6
-};
+    if (next == queue_tail) {
+        if (queue_dropped != 0xFF) {
+            queue_dropped++;
+        }
+        return;
+    }
+    queue[queue_head] = (uint8_t)event;
+    queue_head = next;
+}
 
-// --------- Helper delays to avoid compile-time constant error ----------
-void delay_ms_runtime(uint16_t ms)
+/**
+ * @brief Wait for the edge that leaves the debounced level.
+ */
+static void button_arm(void)
 {
-    while (ms--) {
-        __delay_ms(1);
+    // Press = falling edge, release = rising edge. Changing INTEDG0 can
+    // set the flag, so clear it afterwards.
+    INTCON2bits.INTEDG0 = button_down ? 1 : 0;
+    INTCONbits.INT0IF = 0;
+    INTCONbits.INT0IE = 1;
+
+    // An edge between the sample and here would be missed; catch it now
+    if (button_pressed() != button_down) {
+        INTCONbits.INT0IE = 0;
+        debounce_left = BUTTON_DEBOUNCE_MS;
     }
 }
 
-void delay_units(uint16_t units)
+static void button_gesture_edge(bool pressed)
 {
-    while (units--) {
-        __delay_ms(UNIT_MS);
+    switch (gesture) {
+        case GESTURE_IDLE:
+            if (pressed) {
+                gesture = GESTURE_DOWN;
+                gesture_ms = 0;
+            }
+            break;
+
+        case GESTURE_DOWN:
+            if (!pressed) {
+                gesture = GESTURE_UP;
+                gesture_ms = 0;
+            }
+            break;
+
+        case GESTURE_UP:
+            if (pressed) {
+                button_queue(BUTTON_DOUBLE);
+                gesture = GESTURE_HELD;
+            }
+            break;
+
+        default:
+            if (!pressed) {
+                gesture = GESTURE_IDLE;
+            }
+            break;
+    }
+}
+
+static void button_gesture_tick(void)
+{
+    if (gesture == GESTURE_DOWN) {
+        if (++gesture_ms >= BUTTON_LONG_MS) {
+            button_queue(BUTTON_LONG);
+            gesture = GESTURE_HELD;
+        }
+    } else if (gesture == GESTURE_UP) {
+        if (++gesture_ms >= BUTTON_DOUBLE_MS) {
+            button_queue(BUTTON_SHORT);
+            gesture = GESTURE_IDLE;
+        }
     }
 }
-// ---------------------------------------------------------------------
 
 void button_init(void)
 {
-    // Configure CCP5 as PWM (CCP5CON<3:0> = 1100 = 0x0C)
-    CCP5CON = 0x0C;
+    INTCONbits.INT0IE = 0;
 
-    // Ensure CCP5 uses Timer4 as PWM timebase
-    CCPTMRS1 = 0x04;
+    button_down = button_pressed();
+    gesture = button_down ? GESTURE_HELD : GESTURE_IDLE;
+    gesture_ms = 0;
+    debounce_left = 0;
 
-    // Timer4 prescaler 1:16, w/ Timer4 off
-    T4CON = 0x02;
+    queue_head = 0;
+    queue_tail = 0;
+    queue_dropped = 0;
 
-    // Clear PR4 and duty registers
-    PR4 = 0;
-    CCPR5L = 0;
+    button_arm();
 }
 
-void pwm_start(void)
+void button_isr(void)
 {
-    // Clear interrupt flag (yes PIR5) and start Timer4
-    PIR5bits.TMR4IF = 0;
-    T4CONbits.TMR4ON = 1;
+    if (!INTCONbits.INT0IE || !INTCONbits.INT0IF) {
+        return;
+    }
+
+    // Ignore the bounces; button_tick() samples the settled level
+    INTCONbits.INT0IE = 0;
+    INTCONbits.INT0IF = 0;
+    debounce_left = BUTTON_DEBOUNCE_MS;
 }
 
-void pwm_stop(void)
+void button_tick(void)
 {
-    T4CONbits.TMR4ON = 0;
-    PR4 = 0;
-    CCPR5L = 0;
+    bool pressed;
+
+    if (debounce_left != 0 && --debounce_left == 0) {
+        // A glitch that settled back to the old level is not an edge
+        pressed = button_pressed();
+        if (pressed != button_down) {
+            button_down = pressed;
+            button_gesture_edge(pressed);
+        }
+        button_arm();
+    }
+
+    button_gesture_tick();
 }
 
-void play_melody_once(void)
+bool button_get_event(button_event_t *event)
 {
-    uint8_t i;
-    for (i = 0; i < MELODY_LENGTH; i++) {
-        uint8_t curr_note = notes[i];
-
-        // set PR4 to the note value and set 50% duty by CCPR5L = PR4/2
-        PR4 = curr_note;
-        CCPR5L = (uint8_t)(PR4 >> 1); // 50% duty
-        pwm_start();
-        delay_units(dura[i]);   // runtime delay
-        // small gap between notes
-        pwm_stop();
-        delay_units(1);         // short pause (1 unit)
+    uint8_t tail = queue_tail;
+
+    if (event == NULL || tail == queue_head) {
+        return false;
     }
+    *event = (button_event_t)queue[tail];
+    queue_tail = (uint8_t)((tail + 1) & (BUTTON_QUEUE_SIZE - 1));
+    return true;
 }
 
-void button_code(void)
+uint8_t button_get_dropped(void)
 {
-    // Wait for low-active button press
-    if (!PORTBbits.RB0)
-    {
-        // Simple debounce
-        delay_ms_runtime(20);
-        if (!PORTBbits.RB0)
-        {
-            play_melody_once();
-        }
-    }
+    return queue_dropped;
 }
@@ -0,0 +1,191 @@
+/**
+ * @file config.c
+ * @brief Versioned, CRC-checked configuration record in data EEPROM.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/config.h"
+#include "../includes/accelerometer.h"
+#include "../includes/detector.h"
+#include "../includes/filter.h"
+#include "../includes/melody.h"
+
+// #include "./config.h"
+
+#define CONFIG_CRC_LENGTH ((uint8_t)(sizeof(config_t) - sizeof(uint16_t)))
+#define CONFIG_SLOT_ADDR(slot) ((unsigned char)(CONFIG_EEPROM_ADDR + ((slot) * CONFIG_SLOT_SIZE)))
+
+// Fails to compile if the record outgrows its slot
+typedef char config_fits_slot[(sizeof(config_t) <= CONFIG_SLOT_SIZE) ? 1 : -1];
+
+// Newest good record in EEPROM; saves go to the other slot
+static uint8_t newest_slot = 1;
+static uint8_t newest_sequence = 0;
+
+// Save in progress
+static config_t staged;
+static uint8_t save_index = 0;        // Next byte of staged to write
+static uint8_t save_pending = 0;
+static config_status_t save_result = CONFIG_OK;
+
+/**
+ * @brief Check magic, version, length and CRC of a record.
+ */
+static unsigned char config_valid(const config_t* config)
+{
+	return config->magic == CONFIG_MAGIC &&
+		   config->version == CONFIG_VERSION &&
+		   config->length == sizeof(config_t) &&
+		   config->crc == crc16((const uint8_t*)config, CONFIG_CRC_LENGTH);
+}
+
+/**
+ * @brief Fill a record with the compiled-in defaults.
+ */
+void config_defaults(config_t* config)
+{
+	unsigned char axis;
+
+	if (config == NULL)
+	{
+		return;
+	}
+
+	config->magic = CONFIG_MAGIC;
+	config->version = CONFIG_VERSION;
+	config->length = (uint8_t)sizeof(config_t);
+	config->sequence = 0;
+	config->profile = ACC_DEFAULT_PROFILE;
+	config->button_melody = MELODY_BUTTON;
+	config->detect_onset = DETECT_DEFAULT_ONSET;
+	config->detect_offset = DETECT_DEFAULT_OFFSET;
+	config->detect_refractory_ms = DETECT_DEFAULT_REFRACTORY;
+	config->bias_valid = 0;
+	config->guard_filter = FILTER_DEFAULT;
+	config->wrist_filter = FILTER_DEFAULT;
+	config->gyro_autorange = ACC_DEFAULT_AUTORANGE;
+	for (axis = 0; axis < 3; axis++)
+	{
+		config->gyro_bias[axis] = 0;
+	}
+	config->gyro_temp_ref = 0;
+	config->crc = crc16((const uint8_t*)config, CONFIG_CRC_LENGTH);
+}
+
+/**
+ * @brief Load the newest valid record from data EEPROM, falling back to defaults.
+ */
+config_status_t config_load(config_t* config)
+{
+	config_t other;
+	unsigned char valid0;
+	unsigned char valid1;
+
+	if (config == NULL)
+	{
+		return CONFIG_DEFAULTS;
+	}
+
+	eeprom_read_block(CONFIG_SLOT_ADDR(0), config, (unsigned char)sizeof(config_t));
+	eeprom_read_block(CONFIG_SLOT_ADDR(1), &other, (unsigned char)sizeof(config_t));
+	valid0 = config_valid(config);
+	valid1 = config_valid(&other);
+
+	// Erased (0xFF), older layout or torn by a reset in both slots
+	if (!valid0 && !valid1)
+	{
+		config_defaults(config);
+		newest_slot = 1;
+		newest_sequence = 0;
+		return CONFIG_DEFAULTS;
+	}
+
+	// Sequence numbers wrap; the newer one is ahead by less than half
+	if (valid1 && (!valid0 || (int8_t)(other.sequence - config->sequence) > 0))
+	{
+		*config = other;
+		newest_slot = 1;
+	}
+	else
+	{
+		newest_slot = 0;
+	}
+	newest_sequence = config->sequence;
+
+	return CONFIG_OK;
+}
+
+/**
+ * @brief Stage the record for config_poll() to write.
+ */
+config_status_t config_save(config_t* config)
+{
+	if (config == NULL)
+	{
+		return CONFIG_WRITE_ERROR;
+	}
+
+	config->magic = CONFIG_MAGIC;
+	config->version = CONFIG_VERSION;
+	config->length = (uint8_t)sizeof(config_t);
+	config->sequence = (uint8_t)(newest_sequence + 1);
+	config->crc = crc16((const uint8_t*)config, CONFIG_CRC_LENGTH);
+
+	// A save in progress is restarted; it targets the same slot
+	staged = *config;
+	save_index = 0;
+	save_pending = 1;
+
+	return CONFIG_PENDING;
+}
+
+/**
+ * @brief Write the next changed byte of the staged record, or verify it.
+ */
+void config_poll(void)
+{
+	const unsigned char* bytes = (const unsigned char*)&staged;
+	unsigned char addr = CONFIG_SLOT_ADDR(newest_slot ^ 1);
+	unsigned char i;
+
+	if (!save_pending || eeprom_busy())
+	{
+		return;
+	}
+
+	// Unchanged bytes take no write cycle; start at most one per call
+	while (save_index < sizeof(config_t))
+	{
+		i = save_index++;
+		if (eeprom_write_start((unsigned char)(addr + i), bytes[i]))
+		{
+			return;
+		}
+	}
+
+	// Every byte written, the CRC last: check the slot before using it
+	save_pending = 0;
+	save_result = CONFIG_OK;
+	for (i = 0; i < sizeof(config_t); i++)
+	{
+		if (eeprom_read((unsigned char)(addr + i)) != bytes[i])
+		{
+			save_result = CONFIG_WRITE_ERROR;
+		}
+	}
+
+	if (save_result == CONFIG_OK)
+	{
+		newest_slot ^= 1;
+		newest_sequence = staged.sequence;
+	}
+}
+
+/**
+ * @brief Outcome of the last config_save().
+ */
+config_status_t config_save_status(void)
+{
+	return save_pending ? CONFIG_PENDING : save_result;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file crc.c
+ * @brief CRC-16/CCITT checksum for stored and transmitted records.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/crc.h"
+
+// #include "./crc.h"
+
+/**
+ * @brief Fold one byte into a running CRC-16/CCITT.
+ */
+uint16_t crc16_update(uint16_t crc, uint8_t data)
+{
+	unsigned char bit;
+
+	crc ^= (uint16_t)data << 8;
+	for (bit = 0; bit < 8; bit++)
+	{
+		if (crc & 0x8000)
+		{
+			crc = (uint16_t)((crc << 1) ^ 0x1021);
+		}
+		else
+		{
+			crc <<= 1;
+		}
+	}
+
+	return crc;
+}
+
+/**
+ * @brief CRC-16/CCITT of a buffer.
+ */
+uint16_t crc16(const uint8_t* data, uint8_t length)
+{
+	uint16_t crc = CRC16_INIT;
+
+	while (length--)
+	{
+		crc = crc16_update(crc, *data++);
+	}
+
+	return crc;
+}
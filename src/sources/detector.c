@@ -0,0 +1,153 @@
+/**
+ * @file detector.c
+ * @brief Blade-action event detector on the raw gyro magnitude stream.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/detector.h"
+
+// #include "./detector.h"
+
+/**
+ * @brief Append an event; counts it as dropped if the queue is full.
+ */
+static void detector_push(detector_t* det, detect_event_type_t type,
+						  unsigned int timestamp_ms, unsigned int value,
+						  unsigned int duration_ms)
+{
+	unsigned char next = (det->head + 1) & (DETECT_QUEUE_SIZE - 1);
+
+	if (next == det->tail)
+	{
+		det->dropped++;
+		return;
+	}
+
+	det->queue[det->head].type = type;
+	det->queue[det->head].timestamp_ms = timestamp_ms;
+	det->queue[det->head].value = value;
+	det->queue[det->head].duration_ms = duration_ms;
+	det->head = next;
+}
+
+/**
+ * @brief Initialize a detector.
+ */
+void detector_init(detector_t* det, unsigned int onset, unsigned int offset,
+				   unsigned int refractory_ms)
+{
+	if (det == NULL)
+	{
+		return;
+	}
+
+	det->onset = onset;
+	det->offset = (offset < onset) ? offset : onset;
+	det->refractory_ms = refractory_ms;
+	det->active = 0;
+	det->peak_reported = 0;
+	det->in_refractory = 0;
+	det->peak = 0;
+	det->peak_ms = 0;
+	det->start_ms = 0;
+	det->end_ms = 0;
+	det->head = 0;
+	det->tail = 0;
+	det->dropped = 0;
+}
+
+/**
+ * @brief Feed one magnitude sample.
+ */
+detect_event_type_t detector_update(detector_t* det, unsigned int magnitude,
+									unsigned int now_ms)
+{
+	detect_event_type_t raised = DETECT_NONE;
+
+	if (det == NULL)
+	{
+		return DETECT_NONE;
+	}
+
+	if (!det->active)
+	{
+		// Wrap-safe elapsed time since the last end
+		if (det->in_refractory)
+		{
+			if ((unsigned int)(now_ms - det->end_ms) < det->refractory_ms)
+			{
+				return DETECT_NONE;
+			}
+			det->in_refractory = 0;
+		}
+
+		if (magnitude >= det->onset)
+		{
+			det->active = 1;
+			det->peak_reported = 0;
+			det->peak = magnitude;
+			det->peak_ms = now_ms;
+			det->start_ms = now_ms;
+			detector_push(det, DETECT_START, now_ms, magnitude, 0);
+			raised = DETECT_START;
+		}
+		return raised;
+	}
+
+	if (magnitude > det->peak)
+	{
+		det->peak = magnitude;
+		det->peak_ms = now_ms;
+	}
+	else if (!det->peak_reported &&
+			 magnitude <= det->peak - (det->peak >> DETECT_PEAK_DROP_SHIFT))
+	{
+		det->peak_reported = 1;
+		detector_push(det, DETECT_PEAK, det->peak_ms, det->peak, 0);
+		raised = DETECT_PEAK;
+	}
+
+	if (magnitude < det->offset)
+	{
+		// A short action can end before the drop confirmed its peak
+		if (!det->peak_reported)
+		{
+			det->peak_reported = 1;
+			detector_push(det, DETECT_PEAK, det->peak_ms, det->peak, 0);
+		}
+
+		det->active = 0;
+		det->in_refractory = 1;
+		det->end_ms = now_ms;
+		detector_push(det, DETECT_END, now_ms, det->peak,
+					  (unsigned int)(now_ms - det->start_ms));
+		raised = DETECT_END;
+	}
+
+	return raised;
+}
+
+/**
+ * @brief Pop the oldest pending event.
+ */
+unsigned char detector_get_event(detector_t* det, detect_event_t* event)
+{
+	if (det == NULL || event == NULL || det->tail == det->head)
+	{
+		return 0;
+	}
+
+	*event = det->queue[det->tail];
+	det->tail = (det->tail + 1) & (DETECT_QUEUE_SIZE - 1);
+
+	return 1;
+}
+
+/**
+ * @brief Whether an action is in progress.
+ */
+unsigned char detector_is_active(const detector_t* det)
+{
+	return (det != NULL) ? det->active : 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file eeprom.c
+ * @brief Data EEPROM driver for the Micro-Fencing project (PIC18F45K22).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/eeprom.h"
+
+// #include "./eeprom.h"
+
+/**
+ * @brief Read one byte of data EEPROM.
+ */
+unsigned char eeprom_read(unsigned char addr)
+{
+	EEADR = addr;
+	EECON1bits.EEPGD = 0;    // Data EEPROM, not program flash
+	EECON1bits.CFGS = 0;
+	EECON1bits.RD = 1;
+
+	return EEDATA;
+}
+
+/**
+ * @brief Write one byte of data EEPROM (unlock sequence, wait for WR).
+ */
+unsigned char eeprom_write(unsigned char addr, unsigned char data)
+{
+	if (!eeprom_write_start(addr, data))
+	{
+		return 0;
+	}
+
+	while (eeprom_busy()) HAL_SPIN();
+
+	return 1;
+}
+
+/**
+ * @brief Start writing one byte of data EEPROM (unlock sequence only).
+ */
+unsigned char eeprom_write_start(unsigned char addr, unsigned char data)
+{
+	unsigned char gie;
+
+	// A read during a write cycle returns garbage
+	while (eeprom_busy()) HAL_SPIN();
+
+	if (eeprom_read(addr) == data)
+	{
+		return 0;
+	}
+
+	EEADR = addr;
+	EEDATA = data;
+	EECON1bits.EEPGD = 0;
+	EECON1bits.CFGS = 0;
+	EECON1bits.WREN = 1;
+
+	// The 55h/AAh/WR sequence must not be interrupted
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	EECON2 = 0x55;
+	EECON2 = 0xAA;
+	EECON1bits.WR = 1;
+	INTCONbits.GIE = gie;
+
+	return 1;
+}
+
+/**
+ * @brief Check whether a write cycle is still running; tidy up once done.
+ */
+unsigned char eeprom_busy(void)
+{
+	if (EECON1bits.WR)
+	{
+		return 1;
+	}
+
+	EECON1bits.WREN = 0;
+	PIR2bits.EEIF = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Read a block of data EEPROM.
+ */
+void eeprom_read_block(unsigned char addr, void* dst, unsigned char length)
+{
+	unsigned char* bytes = (unsigned char*)dst;
+
+	while (length--)
+	{
+		*bytes++ = eeprom_read(addr++);
+	}
+}
+
+/**
+ * @brief Write a block of data EEPROM and verify it.
+ */
+unsigned char eeprom_write_block(unsigned char addr, const void* src, unsigned char length)
+{
+	const unsigned char* bytes = (const unsigned char*)src;
+	unsigned char ok = 1;
+
+	while (length--)
+	{
+		eeprom_write(addr, *bytes);
+		if (eeprom_read(addr) != *bytes)
+		{
+			ok = 0;
+		}
+		addr++;
+		bytes++;
+	}
+
+	return ok;
+}
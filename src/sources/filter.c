@@ -0,0 +1,262 @@
+/**
+ * @file filter.c
+ * @brief Fixed-point smoothing filters for the speed pipelines (boxcar, EMA, biquad).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/filter.h"
+
+// #include "./filter.h"
+
+#define FILTER_KIND_NONE    0
+#define FILTER_KIND_BOXCAR  1
+#define FILTER_KIND_EMA     2
+#define FILTER_KIND_BIQUAD  3
+
+#define FILTER_BIQUAD_ONE   ((int32_t)1 << FILTER_BIQUAD_Q)
+#define FILTER_BIQUAD_MASK  (FILTER_BIQUAD_ONE - 1)
+
+// RBJ cookbook Butterworth sections (Q = 1/sqrt(2)) rounded to Q14; b1
+// is adjusted so the DC gain is exactly 1 (low-pass) or 0 (high-pass)
+static const filter_biquad_t lowpass_fast = { 1600,   3198, 1600, -15447,  5461 };  // fs/8
+static const filter_biquad_t lowpass_slow = {  491,    981,  491, -23826,  9405 };  // fs/16
+static const filter_biquad_t highpass     = { 16024, -32048, 16024, -32040, 15672 };  // fs/200
+
+/**
+ * @brief Clamp a 32-bit result to the int16_t range.
+ */
+static int16_t filter_saturate(int32_t value)
+{
+	if (value > INT16_MAX)
+	{
+		return INT16_MAX;
+	}
+	if (value < INT16_MIN)
+	{
+		return INT16_MIN;
+	}
+	return (int16_t)value;
+}
+
+/**
+ * @brief Initialize a filter from a preset.
+ */
+unsigned char filter_init(filter_t* filter, unsigned char preset)
+{
+	unsigned char accepted = 1;
+
+	if (filter == NULL)
+	{
+		return 0;
+	}
+
+	if (preset >= FILTER_PRESET_COUNT)
+	{
+		preset = FILTER_DEFAULT;
+		accepted = 0;
+	}
+
+	switch (preset)
+	{
+		case FILTER_NONE:
+			filter->kind = FILTER_KIND_NONE;
+			break;
+
+		case FILTER_EMA_FAST:
+			filter_init_ema(filter, FILTER_Q15(0.5));
+			break;
+
+		case FILTER_EMA_SLOW:
+			filter_init_ema(filter, FILTER_Q15(0.25));
+			break;
+
+		case FILTER_LOWPASS_FAST:
+			filter_init_biquad(filter, &lowpass_fast);
+			break;
+
+		case FILTER_LOWPASS_SLOW:
+			filter_init_biquad(filter, &lowpass_slow);
+			break;
+
+		case FILTER_HIGHPASS:
+			filter_init_biquad(filter, &highpass);
+			break;
+
+		default:
+			filter->kind = FILTER_KIND_BOXCAR;
+			break;
+	}
+
+	filter->preset = preset;
+	filter_reset(filter);
+
+	return accepted;
+}
+
+/**
+ * @brief Initialize a single-pole EMA with a custom weight.
+ */
+void filter_init_ema(filter_t* filter, int16_t alpha_q15)
+{
+	if (filter == NULL)
+	{
+		return;
+	}
+
+	filter->preset = FILTER_CUSTOM;
+	filter->kind = FILTER_KIND_EMA;
+	filter->alpha = (alpha_q15 > 0) ? alpha_q15 : 1;
+	filter_reset(filter);
+}
+
+/**
+ * @brief Initialize a biquad with custom coefficients.
+ */
+void filter_init_biquad(filter_t* filter, const filter_biquad_t* coeffs)
+{
+	if (filter == NULL || coeffs == NULL)
+	{
+		return;
+	}
+
+	filter->preset = FILTER_CUSTOM;
+	filter->kind = FILTER_KIND_BIQUAD;
+	filter->coeffs = coeffs;
+	filter_reset(filter);
+}
+
+/**
+ * @brief Start the biquad in the steady state for a constant input.
+ */
+static void filter_biquad_prime(filter_t* filter, int16_t input)
+{
+	const filter_biquad_t* c = filter->coeffs;
+	int32_t num = (int32_t)c->b0 + c->b1 + c->b2;
+	int32_t den = FILTER_BIQUAD_ONE + c->a1 + c->a2;
+	int16_t output = 0;
+
+	// DC gain num/den; a pole at DC has no steady state, so start from 0
+	if (num != 0 && den != 0)
+	{
+		output = filter_saturate((int32_t)input * num / den);
+	}
+
+	filter->state.biquad.x1 = input;
+	filter->state.biquad.x2 = input;
+	filter->state.biquad.y1 = output;
+	filter->state.biquad.y2 = output;
+	filter->state.biquad.error = 0;
+}
+
+/**
+ * @brief Feed one sample.
+ */
+int16_t filter_update(filter_t* filter, int16_t input)
+{
+	const filter_biquad_t* c;
+	int32_t sum;
+	int16_t output;
+
+	if (filter == NULL)
+	{
+		return 0;
+	}
+
+	switch (filter->kind)
+	{
+		case FILTER_KIND_BOXCAR:
+			// Speeds are never negative; anything else counts as 0
+			accelerometer_update_moving_avg(&filter->state.boxcar,
+											(input > 0) ? (unsigned int)input : 0);
+			output = (int16_t)accelerometer_get_moving_avg(&filter->state.boxcar);
+			break;
+
+		case FILTER_KIND_EMA:
+			if (!filter->primed)
+			{
+				filter->state.ema = (int32_t)input << FILTER_EMA_Q;
+			}
+			// y += alpha * (x - y): one 16x16 multiply, y kept in Q15
+			output = (int16_t)(filter->state.ema >> FILTER_EMA_Q);
+			filter->state.ema += (int32_t)filter->alpha * (int16_t)(input - output);
+			output = (int16_t)(filter->state.ema >> FILTER_EMA_Q);
+			break;
+
+		case FILTER_KIND_BIQUAD:
+			if (!filter->primed)
+			{
+				filter_biquad_prime(filter, input);
+			}
+			c = filter->coeffs;
+			sum = filter->state.biquad.error;
+			sum += (int32_t)c->b0 * input;
+			sum += (int32_t)c->b1 * filter->state.biquad.x1;
+			sum += (int32_t)c->b2 * filter->state.biquad.x2;
+			sum -= (int32_t)c->a1 * filter->state.biquad.y1;
+			sum -= (int32_t)c->a2 * filter->state.biquad.y2;
+
+			// Floor to Q0 and keep the remainder (always 0..1-2^-14) for next time
+			output = filter_saturate(sum >> FILTER_BIQUAD_Q);
+			filter->state.biquad.error = (int16_t)(sum & FILTER_BIQUAD_MASK);
+
+			filter->state.biquad.x2 = filter->state.biquad.x1;
+			filter->state.biquad.x1 = input;
+			filter->state.biquad.y2 = filter->state.biquad.y1;
+			filter->state.biquad.y1 = output;
+			break;
+
+		default:
+			output = input;
+			break;
+	}
+
+	filter->primed = 1;
+	filter->output = output;
+
+	return output;
+}
+
+/**
+ * @brief Last output of filter_update().
+ */
+int16_t filter_get_output(const filter_t* filter)
+{
+	return (filter != NULL) ? filter->output : 0;
+}
+
+/**
+ * @brief Preset the filter was set up with.
+ */
+unsigned char filter_get_preset(const filter_t* filter)
+{
+	return (filter != NULL) ? filter->preset : FILTER_DEFAULT;
+}
+
+/**
+ * @brief Clear the history; the next sample primes the filter again.
+ */
+void filter_reset(filter_t* filter)
+{
+	if (filter == NULL)
+	{
+		return;
+	}
+
+	if (filter->kind == FILTER_KIND_BOXCAR)
+	{
+		accelerometer_reset_moving_avg(&filter->state.boxcar);
+	}
+	else
+	{
+		filter->state.biquad.x1 = 0;
+		filter->state.biquad.x2 = 0;
+		filter->state.biquad.y1 = 0;
+		filter->state.biquad.y2 = 0;
+		filter->state.biquad.error = 0;
+		filter->state.ema = 0;
+	}
+
+	filter->primed = 0;
+	filter->output = 0;
+}
@@ -9,168 +9,536 @@
 
 // #include "./i2c.h"
 
-#define slave_addr 0xD0  // MPU6050 I2C address with AD0 low (shifted)
+#define I2C_QUEUE_MASK (I2C_QUEUE_SIZE - 1)
+#define I2C_READ_OPS   7   // start, addr W, reg, restart, addr R, read, stop
+#define I2C_WRITE_OPS  5   // start, addr W, reg, data, stop
 
-void i2c_single_write(unsigned char reg, unsigned char data)
+// SSP2CON2 request bits polled by the blocking transfers
+#define I2C_CON2_SEN   0x01
+#define I2C_CON2_RSEN  0x02
+#define I2C_CON2_PEN   0x04
+#define I2C_CON2_RCEN  0x08
+#define I2C_CON2_ACKEN 0x10
+
+static i2c_op_t i2c_queue[I2C_QUEUE_SIZE];
+static volatile unsigned char i2c_head = 0;     // Descriptor being executed
+static volatile unsigned char i2c_tail = 0;     // Next free descriptor
+static volatile unsigned char i2c_active = 0;   // Engine owns the bus
+static unsigned char i2c_read_index = 0;        // Bytes received in current read
+static unsigned char i2c_read_acking = 0;       // Waiting for ACK/NACK to finish
+static i2c_status_t i2c_txn_status = I2C_OK;    // Status of current transaction
+static volatile unsigned char i2c_stall_ticks = 0;  // Ticks since the engine last progressed
+static unsigned int recoveries = 0;
+
+static void i2c_async_abort(i2c_status_t status);
+
+/**
+ * @brief Wait for the async engine to release the bus; abandon it if it never does.
+ */
+static i2c_status_t i2c_wait_engine(void)
 {
-    // Using SSP2 Module
-	// Send start bit and wait for it to complete
-	SSP2CON2bits.SEN = 1;
-	while(SSP2CON2bits.SEN);
-    
-	// Send Slave_Address + R/W
-	SSP2BUF = slave_addr | 0x00;
-	while (SSP2STATbits.R_NOT_W);
-	// Check ACK; Technically unnecessary and liable to cause problems
-	/**/
-	if (SSP2CON2bits.ACKSTAT)
-	{
-		// Abort
-	}
-	/**/
-    
-	// Send Slave Register Address
-	SSP2BUF = reg;
-	while (SSP2STATbits.R_NOT_W);
-	// Check ACK if desired
-    
-	// Write Data
-	SSP2BUF = data;
-	while (SSP2STATbits.R_NOT_W);
-	// Check ACK if desired
-	/**/
-	if (SSP2CON2bits.ACKSTAT)
+	unsigned int polls = I2C_ASYNC_WAIT_POLLS;
+	
+	// Never interleave with an in-flight asynchronous transaction
+	while (i2c_active)
 	{
-		// Abort
+		if (--polls == 0)
+		{
+			i2c_async_abort(I2C_TIMEOUT);
+			i2c_bus_recover();
+			return I2C_TIMEOUT;
+		}
+		HAL_SPIN();
 	}
-	/**/
-    
-	// Send Stop bit
-	SSP2CON2bits.PEN = 1;
-	while (SSP2CON2bits.PEN);
+	
+	return I2C_OK;
 }
 
-unsigned char i2c_single_read(unsigned char reg)
+/**
+ * @brief Wait for SSP2CON2 request bits (SEN/RSEN/PEN/RCEN/ACKEN) to clear.
+ */
+static i2c_status_t i2c_wait_con2(unsigned char mask)
 {
-    // Using SSP2 Module
-	// Send start bit
-	SSP2CON2bits.SEN = 1;
-	while(SSP2CON2bits.SEN);
-    
-	// Send Slave address (in write mode, to select register)
-	SSP2BUF = slave_addr | 0x00;
-	while(SSP2STATbits.R_NOT_W);
-	// Check ACK; Technically unnecessary and liable to cause problems
-	/**/
-	if (SSP2CON2bits.ACKSTAT)
-	{
-		// Abort
-	}
-	/**/
-    
-	// Send Register address
-	SSP2BUF = reg;
-	while(SSP2STATbits.R_NOT_W);
-
-    // Check ACK if desired
-	if (SSP2CON2bits.ACKSTAT)
-	{
-		// Abort
-	}
-    
-	// Send Restart Bit
-	SSP2CON2bits.RSEN = 1;
-	while(SSP2CON2bits.RSEN);
-    
-	// Send Slave address, in Read mode
-	SSP2BUF = slave_addr | 0x01;
-	while(SSP2STATbits.R_NOT_W);
-
-    // Check ACK if desired
-	if (SSP2CON2bits.ACKSTAT)
-	{
-		// Abort
-	}
-    
-	// Wait to receive byte and for buffer to fill
-	SSP2CON2bits.RCEN = 1;
-	while(SSP2CON2bits.RCEN && !SSP2STATbits.BF);
-	// Acknowledge (NACK since only reading one byte)
-	/**/
-	SSP2CON2bits.ACKDT = 1;
-	SSP2CON2bits.ACKEN = 1;
-	while (SSP2CON2bits.ACKEN);
-	/**/
-    
-	// Send Stop bit
-	SSP2CON2bits.PEN = 1;
-	while(SSP2CON2bits.PEN);
-    
-	// Return received byte
-	return SSP2BUF;
-}
-
-void i2c_bulk_read(unsigned char reg, unsigned char* buffer, unsigned char length)
-{
-    unsigned char i;
-	// Using SSP2 Module
-	// Send start bit
+	unsigned int polls = I2C_TIMEOUT_POLLS;
+	
+	while (SSP2CON2 & mask)
+	{
+		if (PIR3bits.BCL2IF)
+		{
+			return I2C_BUS_ERROR;
+		}
+		if (--polls == 0)
+		{
+			return I2C_TIMEOUT;
+		}
+		HAL_SPIN();
+	}
+	
+	// A collision aborts the condition and clears the request bit too
+	return PIR3bits.BCL2IF ? I2C_BUS_ERROR : I2C_OK;
+}
+
+/**
+ * @brief Transmit one byte and check the slave's ACK.
+ */
+static i2c_status_t i2c_send(unsigned char byte)
+{
+	unsigned int polls = I2C_TIMEOUT_POLLS;
+	
+	SSP2BUF = byte;
+	if (SSP2CON1bits.WCOL)
+	{
+		SSP2CON1bits.WCOL = 0;
+		return I2C_BUS_ERROR;
+	}
+	
+	while (SSP2STATbits.R_NOT_W)
+	{
+		if (--polls == 0)
+		{
+			return I2C_TIMEOUT;
+		}
+		HAL_SPIN();
+	}
+	
+	return SSP2CON2bits.ACKSTAT ? I2C_NACK : I2C_OK;
+}
+
+/**
+ * @brief START, slave address (W) and register address.
+ */
+static i2c_status_t i2c_begin(unsigned char address, unsigned char reg)
+{
+	i2c_status_t status = i2c_wait_engine();
+	
+	if (status != I2C_OK)
+	{
+		return status;
+	}
+	
 	SSP2CON2bits.SEN = 1;
-	while(SSP2CON2bits.SEN);
-    
-	// Send Slave address (in write mode, to select register)
-	SSP2BUF = slave_addr | 0x00;
-	while(SSP2STATbits.R_NOT_W);
-	// Check ACK; Technically unnecessary and liable to cause problems
-	/**/
-	if (SSP2CON2bits.ACKSTAT)
+	status = i2c_wait_con2(I2C_CON2_SEN);
+	if (status == I2C_OK)
 	{
-		// Abort
+		status = i2c_send(address | 0x00);
 	}
-	/**/
-    
-	// Send Register address
-	SSP2BUF = reg;
-	while(SSP2STATbits.R_NOT_W);
+	if (status == I2C_OK)
+	{
+		status = i2c_send(reg);
+	}
+	
+	return status;
+}
 
-    // Check ACK if desired
-	if (SSP2CON2bits.ACKSTAT)
+/**
+ * @brief Finish a blocking transaction: STOP after success or NACK, recovery otherwise.
+ */
+static i2c_status_t i2c_end(i2c_status_t status)
+{
+	i2c_status_t stop;
+	
+	if (status == I2C_OK || status == I2C_NACK)
+	{
+		SSP2CON2bits.PEN = 1;
+		stop = i2c_wait_con2(I2C_CON2_PEN);
+		if (stop == I2C_OK)
+		{
+			return status;
+		}
+		status = stop;
+	}
+	
+	i2c_bus_recover();
+	return status;
+}
+
+i2c_status_t i2c_single_write(unsigned char address, unsigned char reg, unsigned char data)
+{
+	// Using SSP2 Module
+	i2c_status_t status = i2c_begin(address, reg);
+	
+	// Write Data
+	if (status == I2C_OK)
 	{
-		// Abort
+		status = i2c_send(data);
 	}
-    
-	// Send Restart Bit
-	SSP2CON2bits.RSEN = 1;
-	while(SSP2CON2bits.RSEN);
-    
-	// Send Slave address, in Read mode
-	SSP2BUF = slave_addr | 0x01;
-	while(SSP2STATbits.R_NOT_W);
+	
+	return i2c_end(status);
+}
+
+i2c_status_t i2c_single_read(unsigned char address, unsigned char reg, unsigned char* data)
+{
+	// One-byte burst: the single byte is NACKed before the STOP
+	return i2c_bulk_read(address, reg, data, 1);
+}
 
-    // Check ACK if desired
-	if (SSP2CON2bits.ACKSTAT)
+i2c_status_t i2c_bulk_read(unsigned char address, unsigned char reg,
+						   unsigned char* buffer, unsigned char length)
+{
+	i2c_status_t status;
+	unsigned char i;
+	
+	if (buffer == NULL || length == 0)
+	{
+		return I2C_INVALID_PARAM;
+	}
+	
+	// Using SSP2 Module
+	// Select the register in write mode
+	status = i2c_begin(address, reg);
+	
+	// Send Restart Bit, then Slave address in Read mode
+	if (status == I2C_OK)
+	{
+		SSP2CON2bits.RSEN = 1;
+		status = i2c_wait_con2(I2C_CON2_RSEN);
+	}
+	if (status == I2C_OK)
 	{
-		// Abort
+		status = i2c_send(address | 0x01);
 	}
-    
-	for (i = 0; i < length; i++)
+	
+	for (i = 0; i < length && status == I2C_OK; i++)
 	{
 		// Wait to receive byte and for buffer to fill
 		SSP2CON2bits.RCEN = 1;
-		while(SSP2CON2bits.RCEN && !SSP2STATbits.BF);
-		// Store received byte in buffer
+		status = i2c_wait_con2(I2C_CON2_RCEN);
+		if (status != I2C_OK)
+		{
+			break;
+		}
 		buffer[i] = SSP2BUF;
-		// Acknowledge (if desired)
-		/**/
+		
 		// ACK all bytes except last, NACK on last
 		SSP2CON2bits.ACKDT = (i != (length - 1)) ? 0 : 1;
 		SSP2CON2bits.ACKEN = 1;
-		while (SSP2CON2bits.ACKEN);
-		/**/
+		status = i2c_wait_con2(I2C_CON2_ACKEN);
+	}
+	
+	return i2c_end(status);
+}
+
+/**
+ * @brief Short delay between bit-banged SCL edges.
+ */
+static void i2c_recovery_delay(void)
+{
+	volatile unsigned char d;
+	
+	for (d = 0; d < I2C_RECOVERY_HALF_POLLS; d++)
+	{
+		HAL_SPIN();
+	}
+}
+
+i2c_status_t i2c_bus_recover(void)
+{
+	unsigned char pulses;
+	unsigned char released;
+	unsigned char gie = INTCONbits.GIE;
+	
+	// Keep the data-ready ISR from queueing transfers while SSP2 is off
+	INTCONbits.GIE = 0;
+	recoveries++;
+	
+	// Hand the pins back to the port; both lines are open-drain: TRIS = 0
+	// with LAT = 0 pulls low, TRIS = 1 lets the pull-up release the line
+	SSP2CON1bits.SSPEN = 0;
+	ANSELD &= (unsigned char)~0x03;
+	I2C_SCL_LAT = 0;
+	I2C_SDA_LAT = 0;
+	I2C_SDA_TRIS = 1;
+	I2C_SCL_TRIS = 1;
+	i2c_recovery_delay();
+	
+	// A slave stuck mid-byte lets go of SDA within nine clocks
+	for (pulses = 0; pulses < I2C_RECOVERY_CLOCKS && !I2C_SDA_PORT; pulses++)
+	{
+		I2C_SCL_TRIS = 0;
+		i2c_recovery_delay();
+		I2C_SCL_TRIS = 1;
+		i2c_recovery_delay();
+	}
+	
+	// STOP by hand: SDA rises while SCL is high
+	I2C_SCL_TRIS = 0;
+	i2c_recovery_delay();
+	I2C_SDA_TRIS = 0;
+	i2c_recovery_delay();
+	I2C_SCL_TRIS = 1;
+	i2c_recovery_delay();
+	I2C_SDA_TRIS = 1;
+	i2c_recovery_delay();
+	released = I2C_SDA_PORT;
+	
+	// Re-enable SSP2 as I2C master; SSP2ADD and SSP2STAT are unchanged
+	SSP2CON2 = 0x00;
+	SSP2CON1 = 0x28;
+	PIR3bits.BCL2IF = 0;
+	PIR3bits.SSP2IF = 0;
+	INTCONbits.GIE = gie;
+	
+	return released ? I2C_OK : I2C_BUS_ERROR;
+}
+
+unsigned int i2c_get_recoveries(void)
+{
+	return recoveries;
+}
+
+/**
+ * @brief Number of free descriptors in the queue.
+ */
+static unsigned char i2c_queue_free(void)
+{
+	return (unsigned char)(I2C_QUEUE_MASK - ((i2c_tail - i2c_head) & I2C_QUEUE_MASK));
+}
+
+/**
+ * @brief Append one descriptor to the queue (caller checks free space).
+ */
+static void i2c_queue_push(unsigned char type, unsigned char data,
+						   unsigned char* buffer, unsigned char length,
+						   i2c_callback_t callback, void* context)
+{
+	i2c_op_t* op = &i2c_queue[i2c_tail];
+	
+	op->type = type;
+	op->data = data;
+	op->buffer = buffer;
+	op->length = length;
+	op->callback = callback;
+	op->context = context;
+	
+	i2c_tail = (i2c_tail + 1) & I2C_QUEUE_MASK;
+}
+
+/**
+ * @brief Start the hardware action for the descriptor at the queue head.
+ * Marks the engine idle when the queue is empty.
+ */
+static void i2c_issue(void)
+{
+	i2c_op_t* op;
+	
+	if (i2c_head == i2c_tail)
+	{
+		i2c_active = 0;
+		return;
+	}
+	
+	i2c_active = 1;
+	op = &i2c_queue[i2c_head];
+	
+	switch (op->type)
+	{
+		case I2C_OP_START:
+			SSP2CON2bits.SEN = 1;
+			break;
+		case I2C_OP_RESTART:
+			SSP2CON2bits.RSEN = 1;
+			break;
+		case I2C_OP_WRITE:
+			SSP2BUF = op->data;
+			break;
+		case I2C_OP_READ:
+			i2c_read_index = 0;
+			i2c_read_acking = 0;
+			SSP2CON2bits.RCEN = 1;
+			break;
+		default:
+			SSP2CON2bits.PEN = 1;
+			break;
+	}
+}
+
+/**
+ * @brief Drop every queued descriptor, completing each transaction with status.
+ */
+static void i2c_async_abort(i2c_status_t status)
+{
+	unsigned char gie = INTCONbits.GIE;
+	
+	INTCONbits.GIE = 0;
+	while (i2c_head != i2c_tail)
+	{
+		if (i2c_queue[i2c_head].type == I2C_OP_STOP && i2c_queue[i2c_head].callback != NULL)
+		{
+			i2c_queue[i2c_head].callback(status, i2c_queue[i2c_head].context);
+		}
+		i2c_head = (i2c_head + 1) & I2C_QUEUE_MASK;
+	}
+	i2c_active = 0;
+	i2c_stall_ticks = 0;
+	i2c_txn_status = I2C_OK;
+	INTCONbits.GIE = gie;
+}
+
+void i2c_async_init(void)
+{
+	i2c_head = 0;
+	i2c_tail = 0;
+	i2c_active = 0;
+	i2c_txn_status = I2C_OK;
+	
+	PIR3bits.SSP2IF = 0;
+	PIE3bits.SSP2IE = 1;
+}
+
+i2c_status_t i2c_async_read(unsigned char address, unsigned char reg,
+							unsigned char* buffer, unsigned char length,
+							i2c_callback_t callback, void* context)
+{
+	i2c_status_t status = I2C_QUEUE_FULL;
+	unsigned char ie;
+	
+	if (buffer == NULL || length == 0)
+	{
+		return I2C_INVALID_PARAM;
+	}
+	
+	// Keep the ISR off the queue while descriptors are appended
+	ie = PIE3bits.SSP2IE;
+	PIE3bits.SSP2IE = 0;
+	
+	if (i2c_queue_free() >= I2C_READ_OPS)
+	{
+		i2c_queue_push(I2C_OP_START, 0, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, address | 0x00, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, reg, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_RESTART, 0, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, address | 0x01, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_READ, 0, buffer, length, NULL, NULL);
+		i2c_queue_push(I2C_OP_STOP, 0, NULL, 0, callback, context);
+		
+		if (!i2c_active)
+		{
+			i2c_issue();
+		}
+		status = I2C_OK;
+	}
+	
+	PIE3bits.SSP2IE = ie;
+	return status;
+}
+
+i2c_status_t i2c_async_write(unsigned char address, unsigned char reg, unsigned char data,
+							 i2c_callback_t callback, void* context)
+{
+	i2c_status_t status = I2C_QUEUE_FULL;
+	unsigned char ie;
+	
+	ie = PIE3bits.SSP2IE;
+	PIE3bits.SSP2IE = 0;
+	
+	if (i2c_queue_free() >= I2C_WRITE_OPS)
+	{
+		i2c_queue_push(I2C_OP_START, 0, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, address | 0x00, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, reg, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_WRITE, data, NULL, 0, NULL, NULL);
+		i2c_queue_push(I2C_OP_STOP, 0, NULL, 0, callback, context);
 		
+		if (!i2c_active)
+		{
+			i2c_issue();
+		}
+		status = I2C_OK;
+	}
+	
+	PIE3bits.SSP2IE = ie;
+	return status;
+}
+
+unsigned char i2c_async_busy(void)
+{
+	return i2c_active;
+}
+
+void i2c_tick(void)
+{
+	if (!i2c_active)
+	{
+		i2c_stall_ticks = 0;
+		return;
+	}
+	
+	if (++i2c_stall_ticks > I2C_ASYNC_TIMEOUT_MS)
+	{
+		i2c_async_abort(I2C_TIMEOUT);
+		i2c_bus_recover();
+	}
+}
+
+void i2c_isr(void)
+{
+	i2c_op_t* op;
+	
+	if (!PIR3bits.SSP2IF)
+	{
+		return;
+	}
+	PIR3bits.SSP2IF = 0;
+	
+	// Flag raised by a blocking call; nothing queued
+	if (!i2c_active)
+	{
+		return;
+	}
+	
+	op = &i2c_queue[i2c_head];
+	i2c_stall_ticks = 0;
+	
+	switch (op->type)
+	{
+		case I2C_OP_WRITE:
+			if (SSP2CON2bits.ACKSTAT)
+			{
+				// Abort: skip the remaining descriptors up to the STOP
+				i2c_txn_status = I2C_NACK;
+				while (i2c_queue[i2c_head].type != I2C_OP_STOP)
+				{
+					i2c_head = (i2c_head + 1) & I2C_QUEUE_MASK;
+				}
+				i2c_issue();
+				return;
+			}
+			break;
+			
+		case I2C_OP_READ:
+			if (!i2c_read_acking)
+			{
+				// Byte received; ACK all bytes except last, NACK on last
+				op->buffer[i2c_read_index] = SSP2BUF;
+				SSP2CON2bits.ACKDT = (i2c_read_index != (op->length - 1)) ? 0 : 1;
+				SSP2CON2bits.ACKEN = 1;
+				i2c_read_acking = 1;
+				return;
+			}
+			
+			i2c_read_acking = 0;
+			i2c_read_index++;
+			if (i2c_read_index < op->length)
+			{
+				SSP2CON2bits.RCEN = 1;
+				return;
+			}
+			break;
+			
+		case I2C_OP_STOP:
+			if (op->callback != NULL)
+			{
+				op->callback(i2c_txn_status, op->context);
+			}
+			i2c_txn_status = I2C_OK;
+			break;
+			
+		default:
+			// START / RESTART completed
+			break;
 	}
-    
-	// Send Stop bit
-	SSP2CON2bits.PEN = 1;
-	while(SSP2CON2bits.PEN);
+	
+	// Descriptor done; move on to the next one
+	i2c_head = (i2c_head + 1) & I2C_QUEUE_MASK;
+	i2c_issue();
 }
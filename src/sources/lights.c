@@ -9,18 +9,278 @@
 
 // #include "./lights.h"
 
-static unsigned char current_r = 0;
-static unsigned char current_g = 0;
-static unsigned char current_b = 0;
+// Timer2 counts per PWM period, before the prescaler
+#define T2_COUNTS   (_XTAL_FREQ / 4UL / LIGHTS_PWM_HZ)
+
+// Smallest prescaler that fits the period in 8-bit PR2
+#if T2_COUNTS <= 256UL
+#define T2_CKPS     0x00
+#define T2_PRESCALE 1UL
+#elif T2_COUNTS <= 1024UL
+#define T2_CKPS     0x01
+#define T2_PRESCALE 4UL
+#elif T2_COUNTS <= 4096UL
+#define T2_CKPS     0x02
+#define T2_PRESCALE 16UL
+#else
+#error "LIGHTS_PWM_HZ is too low for Timer2"
+#endif
+
+#define T2_PR       (T2_COUNTS / T2_PRESCALE - 1UL)
+
+#if T2_PR < 63UL
+#error "LIGHTS_PWM_HZ leaves less than 8 bits of duty resolution"
+#endif
+
+#if LIGHTS_T2_OUTPS < 1 || LIGHTS_T2_OUTPS > 16
+#error "LIGHTS_T2_OUTPS must be 1-16"
+#endif
+
+// Worst case for the six duty register writes, and the last TMR2 value at
+// which they can start and still finish inside the same PWM period
+#define DUTY_WRITE_TCY  48UL
+#define T2_WRITE_LAST   (T2_PR + 1UL - (DUTY_WRITE_TCY + T2_PRESCALE - 1UL) / T2_PRESCALE)
+
+// Duty register value for 100%: 4 * (PR2 + 1), at most 1024
+#define DUTY_FULL   (4UL * (T2_PR + 1UL))
+
+// Instruction cycles per animation frame (16384 = 4.096 ms by default)
+#define FRAME_TCY   ((T2_PR + 1UL) * T2_PRESCALE * LIGHTS_T2_OUTPS * LIGHTS_FRAME_MATCHES)
+
+typedef struct
+{
+	unsigned int color[3];           // Level reached at the end of the fade
+	unsigned int frames;             // Frames to get there (>= 1)
+	unsigned int t_step;             // Q16 phase advance per frame
+} anim_key_t;
+
+// ---------- Animation state (owned by lights_isr once started) -------
+// Callers change it with TMR2IE cleared
+
+// Base layer
+static volatile anim_key_t keys[LIGHTS_MAX_KEYFRAMES];
+static volatile unsigned char key_count = 0;   // 0 = static colour
+static volatile unsigned char key_index = 0;
+static volatile unsigned char key_loop = 0;
+static volatile unsigned int key_from[3];      // Level at the start of this key
+static volatile unsigned int key_left = 0;     // Frames until the key is reached
+static volatile unsigned int key_t = 0;        // Q16 phase within the key
+static volatile unsigned int base[3];          // Current base layer level
+
+// Flash overlay
+static volatile unsigned char flash_active = 0;
+static volatile unsigned int flash_color[3];
+static volatile unsigned int flash_hold = 0;   // Frames left at full flash colour
+static volatile unsigned int flash_left = 0;   // Frames left in the dissolve
+static volatile unsigned int flash_t = 0;      // Q16 phase of the dissolve
+static volatile unsigned int flash_step = 0;
+
+// Output: register values for the next match
+static volatile unsigned int duty[3];
+static volatile unsigned char duty_dirty = 0;
+static unsigned char frame_matches = 0;
+// ---------------------------------------------------------------------
+
+/**
+ * @brief Scale a 0-LIGHTS_DUTY_MAX level to the Timer2 period.
+ */
+static unsigned int lights_scale(unsigned int level)
+{
+#if DUTY_FULL == 1024UL
+	// PR2 = 255: levels are register values already
+	return level;
+#else
+	// Divide by 1024 rather than 1023 so the result stays below 100% and
+	// within the 10-bit register
+	return (unsigned int)(((unsigned long)level * DUTY_FULL) >> 10);
+#endif
+}
+
+static unsigned int lights_clamp(unsigned int level)
+{
+	return (level > LIGHTS_DUTY_MAX) ? LIGHTS_DUTY_MAX : level;
+}
+
+/**
+ * @brief Convert a time to whole animation frames (at least one).
+ */
+static unsigned int lights_frames(unsigned int ms)
+{
+	unsigned long frames;
+	
+	frames = ((unsigned long)ms * (_XTAL_FREQ / 4000UL) + FRAME_TCY / 2UL) / FRAME_TCY;
+	return (frames == 0) ? 1 : (unsigned int)frames;
+}
+
+/**
+ * @brief Q16 phase step that reaches 1.0 on the last frame.
+ */
+static unsigned int lights_phase_step(unsigned int frames)
+{
+	// One frame jumps straight to the target, so the step is never used
+	return (frames < 2) ? 0 : (unsigned int)(65536UL / frames);
+}
+
+/**
+ * @brief Linear blend from a to b at Q16 phase t.
+ */
+static unsigned int lights_lerp(unsigned int a, unsigned int b, unsigned int t)
+{
+	if (b >= a)
+	{
+		return a + (unsigned int)(((unsigned long)(b - a) * t) >> 16);
+	}
+	return a - (unsigned int)(((unsigned long)(a - b) * t) >> 16);
+}
+
+static void lights_set_key(anim_key_t* key, unsigned int r, unsigned int g,
+						   unsigned int b, unsigned int fade_ms)
+{
+	key->color[0] = lights_clamp(r);
+	key->color[1] = lights_clamp(g);
+	key->color[2] = lights_clamp(b);
+	key->frames = lights_frames(fade_ms);
+	key->t_step = lights_phase_step(key->frames);
+}
+
+/**
+ * @brief Begin fading from the current base level to keys[key_index].
+ */
+static void lights_start_key(void)
+{
+	unsigned char c;
+	
+	for (c = 0; c < 3; c++)
+	{
+		key_from[c] = base[c];
+	}
+	key_left = keys[key_index].frames;
+	key_t = 0;
+}
+
+/**
+ * @brief Start the key_count keys already in keys[]; TMR2IE must be clear.
+ */
+static void lights_start_sequence(unsigned char count, unsigned char loop)
+{
+	key_count = count;
+	key_index = 0;
+	key_loop = loop;
+	lights_start_key();
+}
+
+/**
+ * @brief Advance the base layer by one frame.
+ */
+static void lights_step_base(void)
+{
+	const volatile anim_key_t* key;
+	unsigned char c;
+	
+	if (key_count == 0)
+	{
+		return;
+	}
+	
+	key = &keys[key_index];
+	if (--key_left != 0)
+	{
+		key_t += key->t_step;
+		for (c = 0; c < 3; c++)
+		{
+			base[c] = lights_lerp(key_from[c], key->color[c], key_t);
+		}
+		return;
+	}
+	
+	// Key reached: land exactly on it, then move on, wrap or hold
+	for (c = 0; c < 3; c++)
+	{
+		base[c] = key->color[c];
+	}
+	if (++key_index >= key_count)
+	{
+		if (!key_loop)
+		{
+			key_count = 0;
+			return;
+		}
+		key_index = 0;
+	}
+	lights_start_key();
+}
+
+/**
+ * @brief Render one frame (base layer plus flash) into duty[].
+ */
+static void lights_render(void)
+{
+	unsigned int level;
+	unsigned char c;
+	
+	lights_step_base();
+	
+	for (c = 0; c < 3; c++)
+	{
+		level = base[c];
+		if (flash_active)
+		{
+			if (flash_hold != 0)
+			{
+				level = flash_color[c];
+			}
+			else
+			{
+				level = lights_lerp(flash_color[c], base[c], flash_t);
+			}
+		}
+		level = lights_scale(level);
+		if (level != duty[c])
+		{
+			duty[c] = level;
+			duty_dirty = 1;
+		}
+	}
+	
+	if (flash_active)
+	{
+		if (flash_hold != 0)
+		{
+			flash_hold--;
+		}
+		else if (--flash_left == 0)
+		{
+			flash_active = 0;
+		}
+		else
+		{
+			flash_t += flash_step;
+		}
+	}
+}
+
+/**
+ * @brief Write all three duties to CCPRxL:DCxB.
+ */
+static void lights_write_duty(void)
+{
+	CCPR1L = (unsigned char)(duty[0] >> 2);
+	CCP1CONbits.DC1B = duty[0] & 0x03;
+	CCPR2L = (unsigned char)(duty[1] >> 2);
+	CCP2CONbits.DC2B = duty[1] & 0x03;
+	CCPR3L = (unsigned char)(duty[2] >> 2);
+	CCP3CONbits.DC3B = duty[2] & 0x03;
+}
 
 /**
  * @brief Initialize PWM modules for RGB LED control.
  * 
- * Configuration Details:
+ * Configuration Details (defaults):
  * - Fosc = 16 MHz
- * - Timer2 Prescaler = 16 (Fosc/4/16 = 250 kHz)
- * - PR2 = 249 (250 kHz / 250 = 1 kHz PWM frequency)
- * - PWM Resolution: 8-bit (0-255 duty cycle)
+ * - Timer2 Prescaler = 1 (Fosc/4 = 4 MHz)
+ * - PR2 = 255 (4 MHz / 256 = 15.625 kHz PWM frequency)
+ * - PWM Resolution: 10-bit (0-1023 duty cycle)
+ * - Postscaler = 16: TMR2IF once per ~1 ms, a frame every 4 (~244 Hz)
  * 
  * CCP Module Setup:
  * - CCP1 (Red):   RC2, mode = PWM (1100)
@@ -29,15 +289,17 @@ static unsigned char current_b = 0;
  */
 void lights_init(void)
 {
+	unsigned char c;
+	
+	PIE1bits.TMR2IE = 0;
+	
 	// Configure Timer2 for PWM time base
-	// T2CON: Prescaler = 16 (bits 1:0 = 11 means 1:16)
-	T2CON = 0x06;  // Timer2 ON, Prescaler 1:16, Postscaler 1:1
+	// T2CON: TMR2ON (bit 2), prescaler (bits 1:0), postscaler - 1 (bits 6:3)
+	T2CON = (unsigned char)(((LIGHTS_T2_OUTPS - 1) << 3) | 0x04 | T2_CKPS);
 	
 	// Set PWM period (PR2)
 	// PWM Freq = Fosc / (4 * Prescaler * (PR2 + 1))
-	// 1000 = 16MHz / (4 * 16 * (PR2 + 1))
-	// PR2 = 249
-	PR2 = 249;
+	PR2 = (unsigned char)T2_PR;
 	
 	// Configure CCP1 (Red) on RC2
 	// CCP1CON: mode = PWM (1100), DCxB = 00
@@ -53,23 +315,142 @@ void lights_init(void)
 	// CCP3CON: mode = PWM (1100), DCxB = 00
 	CCP3CON = 0x0C;  // PWM mode
 	CCPR3L = 0;      // Initialize duty cycle to 0
+	
+	for (c = 0; c < 3; c++)
+	{
+		base[c] = 0;
+		duty[c] = 0;
+	}
+	key_count = 0;
+	flash_active = 0;
+	duty_dirty = 0;
+	frame_matches = 0;
+	
+	// Serviced on every postscaled match so the flag is never stale
+	PIR1bits.TMR2IF = 0;
+	PIE1bits.TMR2IE = 1;
+}
+
+/**
+ * @brief Set a static colour on the base layer.
+ */
+void lights_set_color10(unsigned int r, unsigned int g, unsigned int b)
+{
+	r = lights_clamp(r);
+	g = lights_clamp(g);
+	b = lights_clamp(b);
+	
+	PIE1bits.TMR2IE = 0;
+	key_count = 0;
+	base[0] = r;
+	base[1] = g;
+	base[2] = b;
+	PIE1bits.TMR2IE = 1;
 }
 
 /**
- * @brief Set the RGB LED color using PWM duty cycles.
+ * @brief Set the RGB LED color using 8-bit PWM duty cycles.
  */
 void lights_set_color(unsigned char r, unsigned char g, unsigned char b)
 {
-	// Update current color
-	current_r = r;
-	current_g = g;
-	current_b = b;
+	// Replicate the top bits so 255 maps to 1023
+	lights_set_color10(((unsigned int)r << 2) | (r >> 6),
+					   ((unsigned int)g << 2) | (g >> 6),
+					   ((unsigned int)b << 2) | (b >> 6));
+}
+
+/**
+ * @brief Fade the base layer to a colour.
+ */
+void lights_fade_to(unsigned int r, unsigned int g, unsigned int b,
+					unsigned int fade_ms)
+{
+	anim_key_t key;
 	
-	// Set PWM duty cycles (CCPR1L, CCPR2L, CCPR3L hold upper 8 bits)
-	// For 8-bit resolution, LSBs are 0
-	CCPR1L = r;  // Red
-	CCPR2L = g;  // Green
-	CCPR3L = b;  // Blue
+	lights_set_key(&key, r, g, b, fade_ms);
+	
+	PIE1bits.TMR2IE = 0;
+	keys[0] = key;
+	lights_start_sequence(1, 0);
+	PIE1bits.TMR2IE = 1;
+}
+
+/**
+ * @brief Copy and start a keyframe sequence.
+ */
+unsigned char lights_play(const lights_keyframe_t* sequence, unsigned char count,
+						  unsigned char loop)
+{
+	anim_key_t staged[LIGHTS_MAX_KEYFRAMES];
+	unsigned char i;
+	
+	if (sequence == NULL || count == 0 || count > LIGHTS_MAX_KEYFRAMES)
+	{
+		return 0;
+	}
+	
+	// Frame counts and phase steps are worked out here, not in the ISR
+	for (i = 0; i < count; i++)
+	{
+		lights_set_key(&staged[i], sequence[i].r, sequence[i].g, sequence[i].b,
+					   sequence[i].fade_ms);
+	}
+	
+	PIE1bits.TMR2IE = 0;
+	for (i = 0; i < count; i++)
+	{
+		keys[i] = staged[i];
+	}
+	lights_start_sequence(count, loop);
+	PIE1bits.TMR2IE = 1;
+	
+	return 1;
+}
+
+/**
+ * @brief Breathe between a colour and off.
+ */
+void lights_pulse(unsigned int r, unsigned int g, unsigned int b,
+				  unsigned int period_ms)
+{
+	lights_keyframe_t breath[2];
+	
+	breath[0].r = r;
+	breath[0].g = g;
+	breath[0].b = b;
+	breath[0].fade_ms = period_ms / 2;
+	breath[1].r = 0;
+	breath[1].g = 0;
+	breath[1].b = 0;
+	breath[1].fade_ms = period_ms - breath[0].fade_ms;
+	
+	lights_play(breath, 2, 1);
+}
+
+/**
+ * @brief Flash a colour over the base layer.
+ */
+void lights_flash(unsigned int r, unsigned int g, unsigned int b,
+				  unsigned int hold_ms, unsigned int fade_ms)
+{
+	unsigned int hold = (hold_ms == 0) ? 0 : lights_frames(hold_ms);
+	unsigned int frames = lights_frames(fade_ms);
+	unsigned int step = lights_phase_step(frames);
+	
+	r = lights_clamp(r);
+	g = lights_clamp(g);
+	b = lights_clamp(b);
+	
+	PIE1bits.TMR2IE = 0;
+	flash_color[0] = r;
+	flash_color[1] = g;
+	flash_color[2] = b;
+	flash_hold = hold;
+	flash_left = frames;
+	flash_t = 0;
+	flash_step = step;
+	flash_active = 1;
+	PIE1bits.TMR2IE = 1;
 }
 
 /**
@@ -77,11 +458,39 @@ void lights_set_color(unsigned char r, unsigned char g, unsigned char b)
  */
 void lights_off(void)
 {
-	current_r = 0;
-	current_g = 0;
-	current_b = 0;
+	PIE1bits.TMR2IE = 0;
+	flash_active = 0;
+	PIE1bits.TMR2IE = 1;
+	
+	lights_set_color10(0, 0, 0);
+}
+
+/**
+ * @brief Write the last frame right after a Timer2 match, then render.
+ */
+void lights_isr(void)
+{
+	if (!PIE1bits.TMR2IE || !PIR1bits.TMR2IF)
+	{
+		return;
+	}
+	
+	PIR1bits.TMR2IF = 0;
+	
+	// The hardware latches CCPRxL:DCxB at every period boundary. Other
+	// handlers may have run since the match, so write only if all six
+	// writes still fit in the current period; otherwise retry next match
+	if (duty_dirty && TMR2 < T2_WRITE_LAST)
+	{
+		duty_dirty = 0;
+		lights_write_duty();
+	}
 	
-	CCPR1L = 0;
-	CCPR2L = 0;
-	CCPR3L = 0;
+	// Rendering may take longer than one PWM period; its result waits
+	// for the next match
+	if (++frame_matches >= LIGHTS_FRAME_MATCHES)
+	{
+		frame_matches = 0;
+		lights_render();
+	}
 }
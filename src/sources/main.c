@@ -9,32 +9,60 @@
 
 // #include "main.h"
 
+// Sensors on the shared I2C bus; the wrist sensor is optional
+static accelerometer_t guard;           // Blade guard, AD0 low, INT on RB1 (INT1)
+static accelerometer_t wrist;           // Wrist, AD0 high, INT on RB2 (INT2)
+static unsigned char wrist_present = 0;
+
+// Pipeline state shared between tasks
+static orientation_t blade;
+static detector_t action;
+static detect_event_t last_peak;
+static filter_t speed_filter;
+static unsigned int avg_speed = 0;
+static unsigned char sensor_error = 0;
+static unsigned char calibrating = 0;   // Guard samples feed a recalibration
+static unsigned char save_pending = 0;  // Recalibration done; command_task stores it
+
+// Wrist stream: magnitude and average for telemetry only
+static filter_t wrist_filter;
+static unsigned char wrist_error = 0;
+
+// Settings and calibration persisted in data EEPROM
+static config_t config;
+
+// Telemetry mode restored when a double press unmutes the stream
+static unsigned char unmute_mode = TLM_DEFAULT_MODE;
+
 // Add JavaDoc
 void configure_osc(void)
 {
-	// Use internal oscillator
-	OSCCON = 0x7A;
+	// Use internal oscillator; HAL_OSCCON sets _XTAL_FREQ
+	OSCCON = HAL_OSCCON;
 }
 
 /**
  * @brief Configure PORTA as digital output for error indicator
- *        Configure PORTB for Button/PWM/I2C (RB0: Button, RB2-RB3: I2C, RB5: PWM)
- *        Configure PORTC for PWM (RC2: PWM Red)
+ *        Configure PORTB for Button/PWM/sensor INT (RB0: Button, RB1/RB2: INT, RB3/RB5: PWM)
+ *        Configure PORTC for PWM (RC2: PWM Red) and EUSART1 (RC6/RC7)
+ *        Configure PORTD for I2C (RD0: SCL2, RD1: SDA2)
  */
 
 void configure_ports(void)
 {
 	TRISA  = 0xEE; // 4 is output (Speaker); 0 is output (Debug)
-	TRISB  = 0xD7; // 3 and 5 are outputs (LED); 1 is input (Button)
+	TRISB  = 0xD7; // 3 and 5 are outputs (LED); 0 (Button), 1 and 2 (sensor INT) are inputs
 	TRISC  = 0xFB; // 2 is output (LED)
+	TRISD  = 0xFF; // 0 and 1 are inputs (SSP2 drives SCL2/SDA2)
     ANSELA = 0x00;
 	ANSELB = 0x00;
 	ANSELC = 0x00;
+	ANSELD = 0x00;
 	PORTA  = 0x00;
 	PORTB  = 0x00;
 	PORTC  = 0x00;
 
-	// Enable Internal Pull-Ups for I2C lines and Button on PORTB
+	// Enable Internal Pull-Ups for the Button on PORTB (I2C has external pull-ups)
 	INTCON2bits.RBPU = 0;
 }
 
@@ -45,12 +73,8 @@ void configure_ports(void)
 
 void configure_ssp2_i2c(void)
 {
-	// Assuming 16 MHz oscillator
-	// For 400 kHz I2C: Baud Rate = Fosc / (4 * (SSP2ADD + 1))
-	// 400000 = 16000000 / (4 * (SSP2ADD + 1))
-	// SSP2ADD = 9
-	
-	SSP2ADD = 9;
+	// Baud Rate = Fosc / (4 * (SSP2ADD + 1)); 9 at 16 MHz for 400 kHz
+	SSP2ADD = (unsigned char)(_XTAL_FREQ / (4UL * I2C_CLOCK_HZ) - 1UL);
 	
 	// SSP2CON1: Configure as I2C Master mode
 	// SSPM3:SSPM0 = 1000 (I2C Master mode)
@@ -63,84 +87,518 @@ void configure_ssp2_i2c(void)
 	SSP2STAT = 0x80;  // SMP = 1 (slew rate disabled for 400 kHz)
 }
 
+/**
+ * @brief Enable peripheral and global interrupts (no priority levels)
+ */
+
+void configure_interrupts(void)
+{
+	RCONbits.IPEN = 0;     // Legacy mode, single vector
+	INTCONbits.PEIE = 1;   // Peripheral interrupts (SSP2, EUSART1, Timer2/4/6)
+	INTCONbits.GIE = 1;    // Global enable
+}
+
+/**
+ * @brief Interrupt service routine; dispatches to the driver handlers
+ */
+
+void __interrupt() isr(void)
+{
+	// First, so the PWM duty writes start early in the Timer2 period
+	lights_isr();
+	i2c_isr();
+	accelerometer_isr();
+	uart_isr();
+	button_isr();
+	
+	// Melody sequencer, I2C stall watchdog and button timing step on the 1 ms tick
+	if (scheduler_tick_isr())
+	{
+		melody_tick();
+		i2c_tick();
+		button_tick();
+	}
+}
+
+/**
+ * @brief React to detector events as soon as the crossing sample is seen
+ */
+
+static void handle_action_events(void)
+{
+	detect_event_t event;
+	
+	while (detector_get_event(&action, &event))
+	{
+		telemetry_send_event(&event);
+		
+		switch (event.type)
+		{
+			case DETECT_START:
+				// Flash white and click without waiting for the average
+				lights_flash(LIGHTS_DUTY_MAX, LIGHTS_DUTY_MAX, LIGHTS_DUTY_MAX,
+							 HIT_FLASH_HOLD_MS, HIT_FLASH_FADE_MS);
+				if (!melody_is_playing())
+				{
+					melody_play(MELODY_ACTION);
+				}
+				break;
+				
+			case DETECT_PEAK:
+				last_peak = event;
+				break;
+				
+			default:
+				// END: nothing to do; the flash dissolves on its own
+				break;
+		}
+	}
+}
+
+/**
+ * @brief Smooth a speed with the pipeline's filter preset
+ * 
+ * A high-pass preset can swing below zero; speeds are reported from 0.
+ */
+
+static unsigned int smooth_speed(filter_t* filter, unsigned int speed)
+{
+	int16_t output;
+	
+	if (speed > FILTER_INPUT_MAX)
+	{
+		speed = FILTER_INPUT_MAX;
+	}
+	output = filter_update(filter, (int16_t)speed);
+	
+	return (output > 0) ? (unsigned int)output : 0;
+}
+
+/**
+ * @brief Magnitude, drift tracking and average for a wrist sample
+ */
+
+static void filter_wrist(const motion_sample_t* sample)
+{
+	unsigned int speed;
+	
+	speed = accelerometer_get_speed(&wrist, &sample->gyro);
+	accelerometer_track_bias(&wrist, sample);
+	
+	telemetry_send_sample(TLM_SENSOR_WRIST, sample, speed,
+						  smooth_speed(&wrist_filter, speed), sample->t_ms);
+}
+
+/**
+ * @brief Feed a guard sample to the recalibration; flag the result for saving
+ * 
+ * If the blade moved the previous bias is kept and tracking resumes.
+ */
+
+static void calibrate_guard(const motion_sample_t* sample)
+{
+	acc_error_t status;
+	
+	status = accelerometer_calibrate_add(&guard, sample);
+	if (status == ACC_BUSY)
+	{
+		return;
+	}
+	
+	calibrating = 0;
+	if (status == ACC_SUCCESS)
+	{
+		save_pending = 1;
+	}
+}
+
+/**
+ * @brief Magnitude, events, smoothed speed and orientation for a guard sample
+ */
+
+static void filter_guard(const motion_sample_t* sample)
+{
+	unsigned int speed;
+	
+	// Calculate angular velocity magnitude (°/s at the profile's range)
+	speed = accelerometer_get_speed(&guard, &sample->gyro);
+	
+	// Follow slow gyro drift while the blade is at rest, unless the
+	// samples are collected for a recalibration
+	if (calibrating)
+	{
+		calibrate_guard(sample);
+	}
+	else
+	{
+		accelerometer_track_bias(&guard, sample);
+	}
+	
+	// Events run on the raw magnitude, ahead of the averaging lag, and
+	// are timed by the sample's data-ready edge, not by when it is drained
+	detector_update(&action, speed, sample->t_ms);
+	handle_action_events();
+	
+	// Smoothed speed for the LED (boxcar, EMA or biquad per config)
+	avg_speed = smooth_speed(&speed_filter, speed);
+	
+	// Blade attitude from the same 6-axis sample
+	orientation_update(&blade, sample);
+	
+	// Queued for the EUSART; dropped rather than stalling the pipeline
+	telemetry_send_sample(TLM_SENSOR_GUARD, sample, speed, avg_speed, sample->t_ms);
+}
+
+/**
+ * @brief Run every queued sample of one sensor through a filter, in batches
+ * 
+ * Returns the updated error flag: cleared by a sample, set by a failed
+ * read, kept while the queue is simply empty.
+ */
+
+static unsigned char drain_sensor(accelerometer_t* acc, void (*filter)(const motion_sample_t*),
+								  unsigned char error)
+{
+	motion_sample_t batch[SAMPLE_BATCH];
+	unsigned char count;
+	unsigned char i;
+	acc_error_t status;
+	
+	status = accelerometer_get_motion_samples(acc, batch, SAMPLE_BATCH, &count);
+	while (status == ACC_SUCCESS)
+	{
+		error = 0;
+		for (i = 0; i < count; i++)
+		{
+			filter(&batch[i]);
+		}
+		status = accelerometer_get_motion_samples(acc, batch, SAMPLE_BATCH, &count);
+	}
+	
+	return (status == ACC_BUSY) ? error : 1;
+}
+
+/**
+ * @brief Task: drain the data-ready queues of both sensors
+ */
+
+static void filter_task(void)
+{
+	if (wrist_present)
+	{
+		wrist_error = drain_sensor(&wrist, filter_wrist, wrist_error);
+	}
+	sensor_error = drain_sensor(&guard, filter_guard, sensor_error);
+}
+
+/**
+ * @brief Task: map the averaged speed to the RGB LED, or flag an I2C error
+ */
+
+static void led_task(void)
+{
+	unsigned int r, g, b;
+	
+	if (sensor_error || wrist_error)
+	{
+		// I2C error; turn off LED and set error indicator
+		lights_off();
+		PORTA = 0x01;
+		return;
+	}
+	
+	// Map averaged speed to RGB color
+	accelerometer_speed_to_color(avg_speed, &r, &g, &b);
+	
+	// Glide to it over one task period; a hit flash stays on top
+	lights_fade_to(r, g, b, LED_TASK_MS);
+	
+	// Clear error indicator
+	PORTA = 0x00;
+}
+
+/**
+ * @brief Task: blink the RA0 error indicator (sensor init failed)
+ */
+
+static void error_blink_task(void)
+{
+	PORTA ^= 0x01;
+}
+
+/**
+ * @brief Push the loaded configuration into the drivers
+ */
+
+static void apply_config(void)
+{
+	gyro_data_t bias;
+	
+	// An unknown profile is rejected and the driver keeps its default;
+	// auto-ranging starts from the profile's range
+	accelerometer_set_profile(&guard, config.profile);
+	accelerometer_set_autorange(&guard, config.gyro_autorange);
+	if (wrist_present)
+	{
+		accelerometer_set_profile(&wrist, config.profile);
+		accelerometer_set_autorange(&wrist, config.gyro_autorange);
+	}
+	
+	if (config.bias_valid)
+	{
+		bias.gx = config.gyro_bias[0];
+		bias.gy = config.gyro_bias[1];
+		bias.gz = config.gyro_bias[2];
+		accelerometer_set_gyro_calibration(&guard, &bias, config.gyro_temp_ref);
+	}
+}
+
+/**
+ * @brief Copy the current gyro calibration into the record and save it
+ */
+
+static config_status_t store_config(void)
+{
+	gyro_data_t bias;
+	int16_t temp_ref;
+	
+	accelerometer_get_gyro_calibration(&guard, &bias, &temp_ref);
+	
+	config.gyro_bias[0] = bias.gx;
+	config.gyro_bias[1] = bias.gy;
+	config.gyro_bias[2] = bias.gz;
+	config.gyro_temp_ref = temp_ref;
+	config.bias_valid = 1;
+	
+	return config_save(&config);
+}
+
+/**
+ * @brief Stop both data-ready paths so blocking sensor calls can run
+ */
+
+static void pause_sampling(void)
+{
+	accelerometer_disable_data_ready(&guard);
+	if (wrist_present)
+	{
+		accelerometer_disable_data_ready(&wrist);
+	}
+}
+
+/**
+ * @brief Restart both data-ready paths; their queues start empty
+ */
+
+static void resume_sampling(void)
+{
+	accelerometer_enable_data_ready(&guard);
+	if (wrist_present)
+	{
+		accelerometer_enable_data_ready(&wrist);
+	}
+}
+
+/**
+ * @brief Start recalibrating the guard gyro from the data-ready samples
+ * 
+ * Samples are collected by filter_guard() across scheduler ticks, so the
+ * other tasks keep running for the 2^ACC_CAL_SHIFT sample periods.
+ */
+
+static void recalibrate(void)
+{
+	if (accelerometer_calibrate_start(&guard) == ACC_SUCCESS)
+	{
+		calibrating = 1;
+	}
+}
+
+/**
+ * @brief Switch both sensors to another latency profile at runtime
+ * 
+ * Speeds stay in °/s and the bias follows the range inside the driver;
+ * only the attitude integration needs the new rate and sample unit.
+ */
+
+static void switch_profile(uint8_t profile)
+{
+	if (profile >= ACC_PROFILE_COUNT)
+	{
+		return;
+	}
+	
+	pause_sampling();
+	accelerometer_set_profile(&guard, profile);
+	if (wrist_present)
+	{
+		accelerometer_set_profile(&wrist, profile);
+	}
+	config.profile = accelerometer_get_profile(&guard);
+	orientation_set_rate(&blade, accelerometer_get_sample_rate(&guard),
+						 accelerometer_get_gyro_range(&guard));
+	resume_sampling();
+}
+
+/**
+ * @brief Task: act on commands received over the telemetry link
+ */
+
+static void command_task(void)
+{
+	uint8_t command;
+	uint8_t value;
+	
+	// Saved here rather than in filter_task, where the guard finished it
+	if (save_pending)
+	{
+		save_pending = 0;
+		store_config();
+	}
+	
+	while (telemetry_poll_command(&command, &value))
+	{
+		switch (command)
+		{
+			case TLM_CMD_SAVE_CONFIG:
+				store_config();
+				break;
+				
+			case TLM_CMD_RECALIBRATE:
+				recalibrate();
+				break;
+				
+			case TLM_CMD_SET_PROFILE:
+				// Kept until the next SAVE_CONFIG
+				switch_profile(value);
+				break;
+				
+			default:
+				break;
+		}
+	}
+}
+
+/**
+ * @brief Task: act on decoded button gestures
+ */
+
+static void button_task(void)
+{
+	button_event_t event;
+	
+	while (button_get_event(&event))
+	{
+		switch (event)
+		{
+			case BUTTON_SHORT:
+				if (!melody_is_playing())
+				{
+					melody_play((melody_id_t)config.button_melody);
+				}
+				break;
+				
+			case BUTTON_LONG:
+				// Hold the blade still until the LED comes back
+				recalibrate();
+				break;
+				
+			case BUTTON_DOUBLE:
+				// Mute or restore the telemetry stream
+				if (telemetry_get_mode() != TLM_MODE_OFF)
+				{
+					unmute_mode = telemetry_get_mode();
+					telemetry_set_mode(TLM_MODE_OFF);
+				}
+				else
+				{
+					telemetry_set_mode(unmute_mode);
+				}
+				break;
+				
+			default:
+				break;
+		}
+	}
+}
+
 int main(void)
 {
 	acc_error_t acc_status;
-	gyro_data_t gyro_data;
-	moving_avg_t speed_avg;
-	unsigned int delay;
-	unsigned int speed;
-	unsigned int avg_speed;
-	unsigned char r, g, b;
 	
 	// Configure I/O ports
 	configure_osc();
 	configure_ports();
 	configure_ssp2_i2c();
+	i2c_async_init();
+	scheduler_init();
+	configure_interrupts();
+	uart_init(UART_DEFAULT_BAUD);
+	telemetry_init(TLM_DEFAULT_MODE);
 	
 	// Initialize PWM for RGB LED control
 	lights_init();
-	button_init();
+	melody_init();
 	
 	// Initialize accelerometer
-	acc_status = accelerometer_init();
+	acc_status = accelerometer_init(&guard, MPU6050_ADDR_AD0_LOW, ACC_INT_RB1);
 	if (acc_status != ACC_SUCCESS)
 	{
 		// Initialization failed; flash error indicator on RA0
 		lights_off();
-		while (1)
-		{
-			PORTA = 0x01;  // Red error indicator on RA0
-			// Delay loop (simplified)
-			for (delay = 0; delay < 30000; delay++);
-			
-			PORTA = 0x00;  // Error indicator off
-			for (delay = 0; delay < 30000; delay++);
-		}
+		melody_play(MELODY_ERROR);
+		scheduler_add_task(error_blink_task, ERROR_BLINK_MS, 0, 0);
+		scheduler_run();
 	}
 	
-	// Initialize moving average buffer
-	accelerometer_reset_moving_avg(&speed_avg);
+	// A missing wrist sensor leaves the guard running on its own
+	wrist_present = (accelerometer_init(&wrist, MPU6050_ADDR_AD0_HIGH, ACC_INT_RB2) == ACC_SUCCESS);
+	
+	// Stored settings and calibration; defaults if the record is invalid
+	config_load(&config);
+	apply_config();
 	
-	// Main loop: continuously read gyro and update LED color
-	while (1)
+	// Calibrate only when nothing is stored, or when the button is held
+	// at power-up; if the blade moved, tracking converges later
+	if (!config.bias_valid || !PORTBbits.RB0)
 	{
-		// Read gyroscope data from all three axes
-		acc_status = accelerometer_read_gyro(&gyro_data);
-		
-		if (acc_status == ACC_SUCCESS)
+		if (accelerometer_calibrate_gyro(&guard) == ACC_SUCCESS)
 		{
-			// Calculate angular velocity magnitude
-			speed = accelerometer_calculate_magnitude(&gyro_data);
-			
-			// Update moving average with new speed measurement
-			accelerometer_update_moving_avg(&speed_avg, speed);
-			
-			// Get current moving average (0 if buffer not full yet)
-			avg_speed = accelerometer_get_moving_avg(&speed_avg);
-			
-			// Map averaged speed to RGB color
-			accelerometer_speed_to_color(avg_speed, &r, &g, &b);
-			
-			// Set RGB LED color using PWM
-			lights_set_color(r, g, b);
-			
-			// Clear error indicator
-			PORTA = 0x00;
+			store_config();
 		}
-		else
-		{
-			// I2C error; turn off LED and set error indicator
-			lights_off();
-			PORTA = 0x01;
-		}
-
-		button_code();
-		
-		// Small delay to prevent I2C bus saturation
-		// Adjust based on your desired sampling rate
-		for (delay = 0; delay < 5000; delay++);
 	}
 	
+	// Speed smoothing per pipeline; an unknown preset falls back to the boxcar
+	filter_init(&speed_filter, config.guard_filter);
+	filter_init(&wrist_filter, config.wrist_filter);
+	orientation_init(&blade, accelerometer_get_sample_rate(&guard),
+					 accelerometer_get_gyro_range(&guard));
+	detector_init(&action, config.detect_onset, config.detect_offset,
+				  config.detect_refractory_ms);
+	
+	// Samples are captured by the data-ready interrupt at a fixed rate; the
+	// wrist bias is not stored and converges by drift tracking
+	accelerometer_enable_data_ready(&guard);
+	if (wrist_present)
+	{
+		accelerometer_enable_data_ready(&wrist);
+	}
+	
+	// Gestures start from here; a button still held from power-up is
+	// ignored until it is released
+	button_init();
+	
+	// Pipeline tasks, staggered so they do not all land on the same tick
+	scheduler_add_task(filter_task, FILTER_TASK_MS, 0, 0);
+	scheduler_add_task(led_task, LED_TASK_MS, 3, 0);
+	scheduler_add_task(button_task, BUTTON_TASK_MS, 5, 0);
+	scheduler_add_task(command_task, COMMAND_TASK_MS, 7, 0);
+	scheduler_add_task(config_poll, CONFIG_TASK_MS, 9, 0);
+	
+	melody_play(MELODY_START);
+	
+	// Run the tasks; the CPU idles between ticks
+	scheduler_run();
+	
 	return 0;
 }
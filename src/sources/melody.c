@@ -0,0 +1,198 @@
+/**
+ * @file melody.c
+ * @brief Interrupt-driven melody sequencer for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/melody.h"
+
+// #include "./melody.h"
+
+#if MELODY_PRESCALE == 1
+#define T4_CKPS 0x00
+#elif MELODY_PRESCALE == 4
+#define T4_CKPS 0x01
+#elif MELODY_PRESCALE == 16
+#define T4_CKPS 0x02
+#else
+#error "MELODY_PRESCALE must be 1, 4 or 16"
+#endif
+
+// PR4 per note number, worked out by the compiler from the frequencies
+static const uint8_t note_pr4[NOTE_COUNT] = {
+    0,
+    MELODY_PR4(NOTE_DHZ_C6),  MELODY_PR4(NOTE_DHZ_CS6), MELODY_PR4(NOTE_DHZ_D6),
+    MELODY_PR4(NOTE_DHZ_DS6), MELODY_PR4(NOTE_DHZ_E6),  MELODY_PR4(NOTE_DHZ_F6),
+    MELODY_PR4(NOTE_DHZ_FS6), MELODY_PR4(NOTE_DHZ_G6),  MELODY_PR4(NOTE_DHZ_GS6),
+    MELODY_PR4(NOTE_DHZ_A6),  MELODY_PR4(NOTE_DHZ_AS6), MELODY_PR4(NOTE_DHZ_B6),
+    MELODY_PR4(NOTE_DHZ_C7),  MELODY_PR4(NOTE_DHZ_CS7), MELODY_PR4(NOTE_DHZ_D7),
+    MELODY_PR4(NOTE_DHZ_DS7), MELODY_PR4(NOTE_DHZ_E7),  MELODY_PR4(NOTE_DHZ_F7),
+    MELODY_PR4(NOTE_DHZ_FS7), MELODY_PR4(NOTE_DHZ_G7),  MELODY_PR4(NOTE_DHZ_GS7),
+    MELODY_PR4(NOTE_DHZ_A7),  MELODY_PR4(NOTE_DHZ_AS7), MELODY_PR4(NOTE_DHZ_B7),
+    MELODY_PR4(NOTE_DHZ_C8)
+};
+
+// Tempo units per note_len_t code
+static const uint8_t note_units[8] = {
+    1, 2, 3, 4, 6, 8, 12, 16
+};
+
+static const uint8_t button_events[] = {
+    MELODY_EVENT(NOTE_E7, LEN_6), MELODY_EVENT(NOTE_B6, LEN_3),
+    MELODY_EVENT(NOTE_C7, LEN_3), MELODY_EVENT(NOTE_D7, LEN_6),
+    MELODY_EVENT(NOTE_C7, LEN_3), MELODY_EVENT(NOTE_B6, LEN_3),
+    MELODY_EVENT(NOTE_A6, LEN_6)
+};
+
+static const uint8_t action_events[] = {
+    MELODY_EVENT(NOTE_C8, LEN_1)
+};
+
+static const uint8_t start_events[] = {
+    MELODY_EVENT(NOTE_C7, LEN_2), MELODY_EVENT(NOTE_E7, LEN_2),
+    MELODY_EVENT(NOTE_G7, LEN_2), MELODY_EVENT(NOTE_C8, LEN_4)
+};
+
+static const uint8_t touch_events[] = {
+    MELODY_EVENT(NOTE_G7, LEN_1), MELODY_EVENT(NOTE_C8, LEN_3)
+};
+
+static const uint8_t error_events[] = {
+    MELODY_EVENT(NOTE_C6, LEN_4), MELODY_EVENT(NOTE_REST, LEN_2),
+    MELODY_EVENT(NOTE_C6, LEN_4), MELODY_EVENT(NOTE_REST, LEN_2),
+    MELODY_EVENT(NOTE_C6, LEN_8)
+};
+
+static const uint8_t low_battery_events[] = {
+    MELODY_EVENT(NOTE_G6, LEN_4), MELODY_EVENT(NOTE_E6, LEN_4),
+    MELODY_EVENT(NOTE_C6, LEN_8)
+};
+
+static const melody_t melodies[MELODY_COUNT] = {
+    { button_events,      sizeof(button_events),      75 },
+    { action_events,      sizeof(action_events),      75 },
+    { start_events,       sizeof(start_events),       60 },
+    { touch_events,       sizeof(touch_events),       50 },
+    { error_events,       sizeof(error_events),       60 },
+    { low_battery_events, sizeof(low_battery_events), 100 }
+};
+
+// --------- Sequencer state (owned by melody_tick in the ISR) ---------
+static const melody_t *volatile melody_current = NULL;  // NULL when idle
+static volatile uint8_t melody_index = 0;       // Current note
+static volatile bool melody_in_gap = false;     // Playing the pause after a note
+static volatile uint16_t melody_ticks_left = 0; // ms until the next boundary
+// ---------------------------------------------------------------------
+
+void melody_init(void)
+{
+    // Configure CCP5 as PWM (CCP5CON<3:0> = 1100 = 0x0C)
+    CCP5CON = 0x0C;
+
+    // Ensure CCP5 uses Timer4 as PWM timebase
+    CCPTMRS1 = 0x04;
+
+    // Timer4 prescaler from MELODY_PRESCALE, w/ Timer4 off
+    T4CON = T4_CKPS;
+
+    // Clear PR4 and duty registers
+    PR4 = 0;
+    CCPR5L = 0;
+
+    melody_current = NULL;
+}
+
+void pwm_start(void)
+{
+    // Clear interrupt flag (yes PIR5) and start Timer4
+    PIR5bits.TMR4IF = 0;
+    T4CONbits.TMR4ON = 1;
+}
+
+void pwm_stop(void)
+{
+    T4CONbits.TMR4ON = 0;
+    PR4 = 0;
+    CCPR5L = 0;
+}
+
+static void melody_start_note(void)
+{
+    uint8_t event = melody_current->events[melody_index];
+    uint8_t note = MELODY_EVENT_NOTE(event);
+
+    if (note == NOTE_REST || note >= NOTE_COUNT) {
+        pwm_stop();
+    } else {
+        // set PR4 to the note value and set 50% duty by CCPR5L = PR4/2
+        PR4 = note_pr4[note];
+        CCPR5L = (uint8_t)(PR4 >> 1); // 50% duty
+        pwm_start();
+    }
+    melody_in_gap = false;
+    melody_ticks_left = (uint16_t)note_units[MELODY_EVENT_LEN(event)] * melody_current->unit_ms;
+}
+
+bool melody_play(melody_id_t id)
+{
+    unsigned char ie;
+
+    if (id >= MELODY_COUNT) {
+        return false;
+    }
+
+    // Keep the tick ISR off the sequencer while it is reloaded; restore
+    // the caller's enable rather than assume it was on
+    ie = PIE5bits.TMR6IE;
+    PIE5bits.TMR6IE = 0;
+    melody_current = &melodies[id];
+    melody_index = 0;
+    melody_start_note();
+    PIE5bits.TMR6IE = ie;
+
+    return true;
+}
+
+void melody_stop(void)
+{
+    unsigned char ie;
+
+    ie = PIE5bits.TMR6IE;
+    PIE5bits.TMR6IE = 0;
+    melody_current = NULL;
+    pwm_stop();
+    PIE5bits.TMR6IE = ie;
+}
+
+bool melody_is_playing(void)
+{
+    return melody_current != NULL;
+}
+
+void melody_tick(void)
+{
+    if (melody_current == NULL) {
+        return;
+    }
+
+    // Wait for the current note (or gap) to run out
+    if (--melody_ticks_left != 0) {
+        return;
+    }
+
+    if (!melody_in_gap) {
+        // small gap between notes
+        pwm_stop();
+        melody_in_gap = true;
+        melody_ticks_left = (uint16_t)MELODY_GAP_UNITS * melody_current->unit_ms;
+        return;
+    }
+
+    melody_index++;
+    if (melody_index >= melody_current->length) {
+        melody_current = NULL;
+        return;
+    }
+    melody_start_note();
+}
@@ -0,0 +1,177 @@
+/**
+ * @file orientation.c
+ * @brief Fixed-point complementary filter for blade attitude (roll/pitch/yaw).
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/orientation.h"
+
+// #include "./orientation.h"
+
+#define ORIENT_DEG_45_Q8    11520   // 45 deg in Q8
+#define ORIENT_ATAN_K_Q8    4004    // 0.273 rad = 15.64 deg in Q8
+
+/**
+ * @brief Wrap a Q16.16 angle into -180..180 degrees.
+ */
+static int32_t orientation_wrap(int32_t angle)
+{
+	if (angle > ORIENT_DEG(180))
+	{
+		angle -= ORIENT_DEG(360);
+	}
+	else if (angle < -ORIENT_DEG(180))
+	{
+		angle += ORIENT_DEG(360);
+	}
+
+	return angle;
+}
+
+/**
+ * @brief Initialize the filter and precompute the gyro step.
+ */
+void orientation_init(orientation_t* orient, unsigned int sample_rate_hz,
+					  unsigned char gyro_fs_sel)
+{
+	if (orient == NULL || sample_rate_hz == 0)
+	{
+		return;
+	}
+
+	orient->roll = 0;
+	orient->pitch = 0;
+	orient->yaw = 0;
+	orient->decimate = 0;
+	orient->accel_used = 0;
+	orient->initialized = 0;
+	orientation_set_rate(orient, sample_rate_hz, gyro_fs_sel);
+}
+
+/**
+ * @brief Recompute the gyro step for a new rate or range.
+ */
+void orientation_set_rate(orientation_t* orient, unsigned int sample_rate_hz,
+						  unsigned char gyro_fs_sel)
+{
+	unsigned long step;
+
+	if (orient == NULL || sample_rate_hz == 0)
+	{
+		return;
+	}
+
+	// deg per sample = counts * 2^fs_sel / GYRO_SENSITIVITY / rate, kept
+	// as Q16 in Q8
+	step = ((1UL << 24) << gyro_fs_sel) / ((unsigned long)GYRO_SENSITIVITY * sample_rate_hz);
+	orient->gyro_step_q8 = (step > UINT16_MAX) ? UINT16_MAX : (uint16_t)step;
+}
+
+/**
+ * @brief Fixed-point atan2, Q16.16 degrees.
+ */
+int32_t orientation_atan2(int32_t y, int32_t x)
+{
+	uint32_t ay = (y < 0) ? (uint32_t)(-y) : (uint32_t)y;
+	uint32_t ax = (x < 0) ? (uint32_t)(-x) : (uint32_t)x;
+	uint32_t z_q15;
+	uint32_t angle_q8;
+	int32_t angle;
+
+	if (ax == 0 && ay == 0)
+	{
+		return 0;
+	}
+
+	// Ratio of the smaller to the larger component, 0..1 in Q15
+	if (ay <= ax)
+	{
+		z_q15 = (ay << 15) / ax;
+	}
+	else
+	{
+		z_q15 = (ax << 15) / ay;
+	}
+
+	// atan(z) ~= 45 z + 15.64 z (1 - z) degrees for 0 <= z <= 1
+	angle_q8 = ORIENT_DEG_45_Q8 + ((ORIENT_ATAN_K_Q8 * (32768UL - z_q15)) >> 15);
+	angle_q8 = (z_q15 * angle_q8) >> 15;
+	angle = (int32_t)angle_q8 << 8;
+
+	// Unfold the octant
+	if (ay > ax)
+	{
+		angle = ORIENT_DEG(90) - angle;
+	}
+	if (x < 0)
+	{
+		angle = ORIENT_DEG(180) - angle;
+	}
+	if (y < 0)
+	{
+		angle = -angle;
+	}
+
+	return angle;
+}
+
+/**
+ * @brief Advance the filter by one 6-axis sample.
+ */
+void orientation_update(orientation_t* orient, const motion_sample_t* motion)
+{
+	uint32_t accel_sq;
+	int32_t roll_acc;
+	int32_t pitch_acc;
+
+	if (orient == NULL || motion == NULL)
+	{
+		return;
+	}
+
+	// Integrate gyro rates: counts * (Q16 deg per count, Q8) >> 8
+	orient->roll  += ((int32_t)motion->gyro.gx * orient->gyro_step_q8) >> 8;
+	orient->pitch += ((int32_t)motion->gyro.gy * orient->gyro_step_q8) >> 8;
+	orient->yaw   += ((int32_t)motion->gyro.gz * orient->gyro_step_q8) >> 8;
+	orient->roll = orientation_wrap(orient->roll);
+	orient->yaw = orientation_wrap(orient->yaw);
+
+	orient->accel_used = 0;
+	if (orient->initialized && orient->decimate != 0)
+	{
+		orient->decimate--;
+		return;
+	}
+
+	// Only trust the accel as a gravity reference near 1 g
+	accel_sq  = (uint32_t)((int32_t)motion->ax * motion->ax);
+	accel_sq += (uint32_t)((int32_t)motion->ay * motion->ay);
+	accel_sq += (uint32_t)((int32_t)motion->az * motion->az);
+	if (accel_sq < ORIENT_ACC_MIN_SQ || accel_sq > ORIENT_ACC_MAX_SQ)
+	{
+		return;
+	}
+
+	roll_acc = orientation_atan2(motion->ay, motion->az);
+	pitch_acc = orientation_atan2(-(int32_t)motion->ax,
+								  isqrt((uint32_t)((int32_t)motion->ay * motion->ay) +
+										(uint32_t)((int32_t)motion->az * motion->az)));
+
+	if (!orient->initialized)
+	{
+		// First fix: snap instead of slewing up from zero
+		orient->roll = roll_acc;
+		orient->pitch = pitch_acc;
+		orient->initialized = 1;
+	}
+	else
+	{
+		orient->roll += orientation_wrap(roll_acc - orient->roll) >> ORIENT_ACC_SHIFT;
+		orient->pitch += (pitch_acc - orient->pitch) >> ORIENT_ACC_SHIFT;
+		orient->roll = orientation_wrap(orient->roll);
+	}
+
+	orient->decimate = ORIENT_ACC_DECIMATE - 1;
+	orient->accel_used = 1;
+}
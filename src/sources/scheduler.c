@@ -0,0 +1,175 @@
+/**
+ * @file scheduler.c
+ * @brief Timer-tick cooperative task scheduler for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/scheduler.h"
+
+// #include "./scheduler.h"
+
+static task_t tasks[SCHEDULER_MAX_TASKS];
+static unsigned char task_count = 0;
+static volatile unsigned int scheduler_ticks = 0;
+
+/**
+ * @brief Initialize the task table and Timer6.
+ * 
+ * Configuration Details:
+ * - Fosc = 16 MHz, Timer6 clock = Fosc/4 = 4 MHz
+ * - T6CON = 0x06: TMR6ON, prescaler 1:16, postscaler 1:1
+ * - 250 kHz / (PR6 + 1) = 1 kHz tick
+ */
+void scheduler_init(void)
+{
+	task_count = 0;
+	scheduler_ticks = 0;
+	
+	T6CON = 0x00;
+	TMR6 = 0;
+	PR6 = SCHEDULER_PR6;
+	
+	PIR5bits.TMR6IF = 0;
+	PIE5bits.TMR6IE = 1;
+	T6CON = 0x06;
+}
+
+/**
+ * @brief Register a periodic task.
+ */
+unsigned char scheduler_add_task(task_fn_t function, unsigned int period_ms,
+								 unsigned int offset_ms, unsigned int deadline_ms)
+{
+	task_t* task;
+	
+	if (function == NULL || period_ms == 0 || task_count >= SCHEDULER_MAX_TASKS)
+	{
+		return SCHEDULER_NO_TASK;
+	}
+	
+	if (deadline_ms == 0 || deadline_ms > period_ms)
+	{
+		deadline_ms = period_ms;
+	}
+	
+	task = &tasks[task_count];
+	task->function = function;
+	task->period_ms = period_ms;
+	task->deadline_ms = deadline_ms;
+	task->release = scheduler_millis() + offset_ms;
+	task->overruns = 0;
+	
+	return task_count++;
+}
+
+/**
+ * @brief Run all due tasks, then idle until the next interrupt.
+ */
+void scheduler_dispatch(void)
+{
+	unsigned char i;
+	unsigned char ran = 0;
+	unsigned int now;
+	unsigned int late;
+	task_t* task;
+	
+	for (i = 0; i < task_count; i++)
+	{
+		task = &tasks[i];
+		now = scheduler_millis();
+		
+		// Not released yet (difference wraps negative -> large)
+		late = now - task->release;
+		if (late >= 0x8000)
+		{
+			continue;
+		}
+		
+		// Released more than one period ago: drop the missed releases
+		if (late >= task->period_ms)
+		{
+			task->overruns++;
+			task->release += (late / task->period_ms) * task->period_ms;
+		}
+		
+		task->function();
+		ran = 1;
+		
+		// Finished after its deadline
+		if ((unsigned int)(scheduler_millis() - task->release) > task->deadline_ms)
+		{
+			task->overruns++;
+		}
+		
+		task->release += task->period_ms;
+	}
+	
+	if (!ran)
+	{
+		// Idle mode: CPU halts, peripherals and Timer6 keep running
+		OSCCONbits.IDLEN = 1;
+		SLEEP();
+	}
+}
+
+/**
+ * @brief Dispatch tasks forever.
+ */
+void scheduler_run(void)
+{
+	while (1)
+	{
+		scheduler_dispatch();
+	}
+}
+
+/**
+ * @brief Milliseconds since scheduler_init().
+ */
+unsigned int scheduler_millis(void)
+{
+	unsigned int ticks;
+	unsigned char ie;
+	
+	// 16-bit read is not atomic on the PIC18; the caller may already
+	// have the tick masked, so put back what was there
+	ie = PIE5bits.TMR6IE;
+	PIE5bits.TMR6IE = 0;
+	ticks = scheduler_ticks;
+	PIE5bits.TMR6IE = ie;
+	
+	return ticks;
+}
+
+/**
+ * @brief Overrun count for a task.
+ */
+unsigned int scheduler_get_overruns(unsigned char id)
+{
+	if (id >= task_count)
+	{
+		return 0;
+	}
+	
+	return tasks[id].overruns;
+}
+
+/**
+ * @brief Timer6 period-match handler; advances the tick.
+ */
+unsigned char scheduler_tick_isr(void)
+{
+	// The flag still sets while TMR6IE is off; another source's interrupt
+	// must not tick in the middle of a masked scheduler_millis() read
+	if (!PIE5bits.TMR6IE || !PIR5bits.TMR6IF)
+	{
+		return 0;
+	}
+	
+	// TMR6 was reset by the match itself; nothing to reload
+	PIR5bits.TMR6IF = 0;
+	scheduler_ticks++;
+	
+	return 1;
+}
@@ -0,0 +1,381 @@
+/**
+ * @file telemetry.c
+ * @brief Framed binary telemetry over the EUSART for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/telemetry.h"
+
+// #include "./telemetry.h"
+
+#define TLM_RX_FRAME_LEN 8   // Longest command frame before COBS decode
+
+static unsigned char mode = TLM_MODE_OFF;
+static uint8_t seq = 0;
+static unsigned int dropped = 0;
+
+// Delta chain of one sensor
+typedef struct
+{
+	int16_t prev[8];                // Last sample sent (keyframe or rebuilt from deltas)
+	unsigned char have_prev;
+	unsigned char since_keyframe;
+	uint8_t delta_body[1 + TLM_DELTA_BATCH * TLM_DELTA_ENTRY_LEN];  // count, entries
+} tlm_stream_t;
+
+static tlm_stream_t streams[TLM_MAX_SENSORS];
+
+static uint8_t frame[TLM_MAX_FRAME_LEN];
+static uint8_t wire[TLM_MAX_WIRE_LEN];
+
+// Command receive state
+static uint8_t rx_frame[TLM_RX_FRAME_LEN];
+static unsigned char rx_length = 0;
+static unsigned char rx_discard = 0;
+
+/**
+ * @brief COBS-encode len bytes from src into dst; returns the encoded length.
+ */
+static unsigned char telemetry_cobs_encode(const uint8_t* src, unsigned char len, uint8_t* dst)
+{
+	unsigned char read = 0;
+	unsigned char write = 1;
+	unsigned char code_index = 0;
+	uint8_t code = 1;
+
+	while (read < len)
+	{
+		if (src[read] == 0)
+		{
+			dst[code_index] = code;
+			code = 1;
+			code_index = write++;
+		}
+		else
+		{
+			dst[write++] = src[read];
+			if (++code == 0xFF)
+			{
+				dst[code_index] = code;
+				code = 1;
+				code_index = write++;
+			}
+		}
+		read++;
+	}
+	dst[code_index] = code;
+
+	return write;
+}
+
+/**
+ * @brief COBS-decode in place; returns the decoded length, 0 if malformed.
+ */
+static unsigned char telemetry_cobs_decode(uint8_t* buf, unsigned char len)
+{
+	unsigned char read = 0;
+	unsigned char write = 0;
+	unsigned char i;
+	uint8_t code;
+
+	while (read < len)
+	{
+		code = buf[read++];
+		if (code == 0)
+		{
+			return 0;
+		}
+		for (i = 1; i < code; i++)
+		{
+			if (read >= len)
+			{
+				return 0;
+			}
+			buf[write++] = buf[read++];
+		}
+		if (code != 0xFF && read < len)
+		{
+			buf[write++] = 0;
+		}
+	}
+
+	return write;
+}
+
+/**
+ * @brief Force every sensor's next sample to a keyframe.
+ */
+static void telemetry_restart_streams(void)
+{
+	unsigned char s;
+
+	for (s = 0; s < TLM_MAX_SENSORS; s++)
+	{
+		streams[s].have_prev = 0;
+	}
+}
+
+/**
+ * @brief Add header and CRC to a body, frame it and queue it.
+ */
+static unsigned char telemetry_send_frame(uint8_t type, const uint8_t* body, unsigned char body_len)
+{
+	unsigned char length = TLM_HEADER_LEN;
+	unsigned char i;
+	uint16_t crc;
+
+	frame[0] = type;
+	frame[1] = seq;
+	for (i = 0; i < body_len; i++)
+	{
+		frame[length++] = body[i];
+	}
+	crc = crc16(frame, length);
+	frame[length++] = (uint8_t)(crc & 0xFF);
+	frame[length++] = (uint8_t)(crc >> 8);
+
+	length = telemetry_cobs_encode(frame, length, wire);
+	wire[length++] = 0x00;
+
+	seq++;
+	if (!uart_write(wire, length))
+	{
+		// The host will see the seq gap; restart deltas from a keyframe
+		dropped++;
+		telemetry_restart_streams();
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Send a sensor's pending DELTA batch, if any.
+ */
+static void telemetry_flush_deltas(unsigned char sensor)
+{
+	uint8_t* body = streams[sensor].delta_body;
+
+	if (body[0] == 0)
+	{
+		return;
+	}
+
+	telemetry_send_frame((uint8_t)(TLM_FRAME_DELTA | (sensor << TLM_FRAME_SENSOR_SHIFT)), body,
+						 (unsigned char)(1 + body[0] * TLM_DELTA_ENTRY_LEN));
+	body[0] = 0;
+}
+
+/**
+ * @brief Reset the stream state and select a mode.
+ */
+void telemetry_init(unsigned char new_mode)
+{
+	seq = 0;
+	dropped = 0;
+	rx_length = 0;
+	rx_discard = 0;
+	telemetry_set_mode(new_mode);
+}
+
+/**
+ * @brief Change the stream mode.
+ */
+void telemetry_set_mode(unsigned char new_mode)
+{
+	unsigned char s;
+
+	if (new_mode > TLM_MODE_DELTA)
+	{
+		return;
+	}
+
+	mode = new_mode;
+	for (s = 0; s < TLM_MAX_SENSORS; s++)
+	{
+		streams[s].have_prev = 0;
+		streams[s].since_keyframe = 0;
+		streams[s].delta_body[0] = 0;
+	}
+}
+
+/**
+ * @brief Get the current stream mode.
+ */
+unsigned char telemetry_get_mode(void)
+{
+	return mode;
+}
+
+/**
+ * @brief Stream one processed sample as a keyframe or a delta entry.
+ */
+void telemetry_send_sample(unsigned char sensor, const motion_sample_t* motion,
+						   unsigned int magnitude, unsigned int average,
+						   unsigned int timestamp_ms)
+{
+	int16_t cur[8];
+	uint8_t body[TLM_SAMPLE_BODY_LEN];
+	uint8_t* entry;
+	tlm_stream_t* stream;
+	unsigned char fits = 1;
+	unsigned char i;
+
+	if (mode == TLM_MODE_OFF || motion == NULL || sensor >= TLM_MAX_SENSORS)
+	{
+		return;
+	}
+	stream = &streams[sensor];
+
+	cur[0] = motion->ax;
+	cur[1] = motion->ay;
+	cur[2] = motion->az;
+	cur[3] = motion->gyro.gx;
+	cur[4] = motion->gyro.gy;
+	cur[5] = motion->gyro.gz;
+	cur[6] = (int16_t)magnitude;
+	cur[7] = (int16_t)average;
+
+	if (mode == TLM_MODE_DELTA && stream->have_prev &&
+		stream->since_keyframe < TLM_KEYFRAME_INTERVAL)
+	{
+		for (i = 0; i < 8; i++)
+		{
+			int16_t d = (int16_t)(cur[i] - stream->prev[i]);
+			if (d > 127 || d < -128)
+			{
+				fits = 0;
+				break;
+			}
+		}
+
+		if (fits)
+		{
+			entry = &stream->delta_body[1 + stream->delta_body[0] * TLM_DELTA_ENTRY_LEN];
+			for (i = 0; i < 8; i++)
+			{
+				entry[i] = (uint8_t)(int8_t)(cur[i] - stream->prev[i]);
+				stream->prev[i] = cur[i];
+			}
+			stream->since_keyframe++;
+			if (++stream->delta_body[0] >= TLM_DELTA_BATCH)
+			{
+				telemetry_flush_deltas(sensor);
+			}
+			return;
+		}
+	}
+
+	// Keyframe: first sample, full mode, interval elapsed or a large step
+	telemetry_flush_deltas(sensor);
+
+	body[0] = (uint8_t)(timestamp_ms & 0xFF);
+	body[1] = (uint8_t)(timestamp_ms >> 8);
+	for (i = 0; i < 8; i++)
+	{
+		body[2 + 2 * i] = (uint8_t)((uint16_t)cur[i] & 0xFF);
+		body[3 + 2 * i] = (uint8_t)((uint16_t)cur[i] >> 8);
+		stream->prev[i] = cur[i];
+	}
+
+	stream->since_keyframe = 0;
+	stream->have_prev = 1;
+	telemetry_send_frame((uint8_t)(TLM_FRAME_SAMPLE | (sensor << TLM_FRAME_SENSOR_SHIFT)),
+						 body, TLM_SAMPLE_BODY_LEN);
+}
+
+/**
+ * @brief Stream one detector event.
+ */
+void telemetry_send_event(const detect_event_t* event)
+{
+	uint8_t body[TLM_EVENT_BODY_LEN];
+	unsigned char s;
+
+	if (mode == TLM_MODE_OFF || event == NULL)
+	{
+		return;
+	}
+
+	for (s = 0; s < TLM_MAX_SENSORS; s++)
+	{
+		telemetry_flush_deltas(s);
+	}
+
+	body[0] = (uint8_t)event->type;
+	body[1] = (uint8_t)(event->timestamp_ms & 0xFF);
+	body[2] = (uint8_t)(event->timestamp_ms >> 8);
+	body[3] = (uint8_t)(event->value & 0xFF);
+	body[4] = (uint8_t)(event->value >> 8);
+	body[5] = (uint8_t)(event->duration_ms & 0xFF);
+	body[6] = (uint8_t)(event->duration_ms >> 8);
+
+	telemetry_send_frame(TLM_FRAME_EVENT, body, TLM_EVENT_BODY_LEN);
+}
+
+/**
+ * @brief Decode received command frames.
+ */
+unsigned char telemetry_poll_command(uint8_t* command, uint8_t* value)
+{
+	uint8_t byte;
+	unsigned char length;
+
+	if (command == NULL || value == NULL)
+	{
+		return 0;
+	}
+
+	while (uart_read(&byte))
+	{
+		if (byte != 0x00)
+		{
+			// Oversized frames are dropped up to the next delimiter
+			if (rx_length < TLM_RX_FRAME_LEN)
+			{
+				rx_frame[rx_length++] = byte;
+			}
+			else
+			{
+				rx_discard = 1;
+			}
+			continue;
+		}
+
+		length = rx_discard ? 0 : telemetry_cobs_decode(rx_frame, rx_length);
+		rx_length = 0;
+		rx_discard = 0;
+
+		// type, seq, body, crc
+		if (length < TLM_HEADER_LEN + TLM_CRC_LEN ||
+			crc16(rx_frame, (uint8_t)(length - TLM_CRC_LEN)) !=
+			(uint16_t)(rx_frame[length - 2] | ((uint16_t)rx_frame[length - 1] << 8)))
+		{
+			continue;
+		}
+
+		if (rx_frame[0] == TLM_CMD_SET_MODE)
+		{
+			if (length == TLM_HEADER_LEN + 1 + TLM_CRC_LEN)
+			{
+				telemetry_set_mode(rx_frame[2]);
+			}
+			continue;
+		}
+
+		*command = rx_frame[0];
+		*value = (length == TLM_HEADER_LEN + 1 + TLM_CRC_LEN) ? rx_frame[2] : 0;
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Frames dropped because the TX ring was full.
+ */
+unsigned int telemetry_get_dropped(void)
+{
+	return dropped;
+}
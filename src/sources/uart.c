@@ -0,0 +1,180 @@
+/**
+ * @file uart.c
+ * @brief Interrupt-driven EUSART1 driver for the Micro-Fencing project.
+ * @author Christopher Reed, Micah Baker, Lydia Knierim, Samuel Prusia
+ * @date 2025-11
+ */
+
+#include "../includes/uart.h"
+
+// #include "./uart.h"
+
+// TX ring: uart_write() produces at head, uart_isr() consumes at tail
+static uint8_t tx_ring[UART_TX_SIZE];
+static volatile unsigned char tx_head = 0;
+static volatile unsigned char tx_tail = 0;
+
+// RX ring: uart_isr() produces at head, uart_read() consumes at tail
+static uint8_t rx_ring[UART_RX_SIZE];
+static volatile unsigned char rx_head = 0;
+static volatile unsigned char rx_tail = 0;
+static volatile unsigned int rx_overruns = 0;
+
+/**
+ * @brief Configure EUSART1 for asynchronous 8N1.
+ */
+void uart_init(unsigned long baud)
+{
+	unsigned int brg;
+
+	if (baud == 0)
+	{
+		baud = UART_DEFAULT_BAUD;
+	}
+
+	// BRG16 = 1, BRGH = 1: SPBRG = Fosc / (4 * baud) - 1, rounded
+	brg = (unsigned int)(((_XTAL_FREQ / 4UL) + (baud / 2UL)) / baud - 1UL);
+
+	TRISCbits.TRISC6 = 1;       // EUSART drives TX once SPEN is set
+	TRISCbits.TRISC7 = 1;
+	ANSELCbits.ANSC6 = 0;
+	ANSELCbits.ANSC7 = 0;
+
+	BAUDCON1 = 0x08;            // BRG16 = 1
+	SPBRGH1 = (uint8_t)(brg >> 8);
+	SPBRG1 = (uint8_t)(brg & 0xFF);
+	TXSTA1 = 0x24;              // TXEN = 1, BRGH = 1, async 8-bit
+	RCSTA1 = 0x90;              // SPEN = 1, CREN = 1
+
+	tx_head = 0;
+	tx_tail = 0;
+	rx_head = 0;
+	rx_tail = 0;
+	rx_overruns = 0;
+
+	// TX interrupt is only enabled while the ring holds data
+	PIE1bits.TX1IE = 0;
+	PIR1bits.RC1IF = 0;
+	PIE1bits.RC1IE = 1;
+}
+
+/**
+ * @brief Free space in the TX ring (one slot stays empty).
+ */
+unsigned char uart_tx_free(void)
+{
+	return (unsigned char)((tx_tail - tx_head - 1) & (UART_TX_SIZE - 1));
+}
+
+/**
+ * @brief Queue bytes for transmission; all or nothing.
+ */
+unsigned char uart_write(const uint8_t* data, unsigned char length)
+{
+	unsigned char head;
+
+	if (data == NULL || length == 0)
+	{
+		return 0;
+	}
+
+	// Only the ISR moves tail, and only toward more free space
+	if (uart_tx_free() < length)
+	{
+		return 0;
+	}
+
+	head = tx_head;
+	while (length--)
+	{
+		tx_ring[head] = *data++;
+		head = (head + 1) & (UART_TX_SIZE - 1);
+	}
+	tx_head = head;
+
+	// Start (or keep) the interrupt-driven drain
+	PIE1bits.TX1IE = 1;
+
+	return 1;
+}
+
+/**
+ * @brief Take one received byte.
+ */
+unsigned char uart_read(uint8_t* byte)
+{
+	if (byte == NULL || rx_tail == rx_head)
+	{
+		return 0;
+	}
+
+	*byte = rx_ring[rx_tail];
+	rx_tail = (rx_tail + 1) & (UART_RX_SIZE - 1);
+
+	return 1;
+}
+
+/**
+ * @brief Receive bytes lost since init.
+ */
+unsigned int uart_get_rx_overruns(void)
+{
+	unsigned int overruns;
+	unsigned char gie;
+
+	// uart_isr() drains RC1IF from any interrupt, so masking RC1IE alone
+	// would not keep it off the counter; restore the caller's GIE
+	gie = INTCONbits.GIE;
+	INTCONbits.GIE = 0;
+	overruns = rx_overruns;
+	INTCONbits.GIE = gie;
+
+	return overruns;
+}
+
+/**
+ * @brief EUSART1 interrupt handler.
+ */
+void uart_isr(void)
+{
+	unsigned char next;
+	uint8_t byte;
+
+	while (PIR1bits.RC1IF)
+	{
+		if (RCSTA1bits.OERR)
+		{
+			// Overrun stops the receiver until CREN is cycled
+			RCSTA1bits.CREN = 0;
+			RCSTA1bits.CREN = 1;
+			rx_overruns++;
+		}
+
+		// Reading RCREG1 clears RC1IF once the FIFO is empty
+		byte = RCREG1;
+		next = (rx_head + 1) & (UART_RX_SIZE - 1);
+		if (next == rx_tail)
+		{
+			rx_overruns++;
+		}
+		else
+		{
+			rx_ring[rx_head] = byte;
+			rx_head = next;
+		}
+	}
+
+	if (PIE1bits.TX1IE && PIR1bits.TX1IF)
+	{
+		if (tx_tail == tx_head)
+		{
+			// Ring drained; TX1IF stays set while TXREG1 is empty
+			PIE1bits.TX1IE = 0;
+		}
+		else
+		{
+			TXREG1 = tx_ring[tx_tail];
+			tx_tail = (tx_tail + 1) & (UART_TX_SIZE - 1);
+		}
+	}
+}